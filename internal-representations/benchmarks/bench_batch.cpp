@@ -0,0 +1,112 @@
+// Batch planning benchmark: the planning half of a 64-robot dispatch
+// (Robot::planRoute for every robot) on WorkStealingPools of increasing
+// size. The path cache is cleared before each run so every route is really
+// searched. Speedup is relative to the 1-thread pool and is bounded by the
+// number of hardware threads, which is printed first. The recall rows send
+// every robot to one depot cell, searching per robot versus reading one
+// shared flow field (whose build is included).
+// Build and run from the repository root with: make bench
+
+#include "Map.h"
+#include "PathCache.h"
+#include "Robot.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Tree rows every 6 cells with a gap every 40 cells, plus 8% scattered obstacles
+    void fillFarm(Map& map, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                bool treeRow = (y % 6 == 3) && (x % 40 != 0);
+                if (treeRow || pct(rng) < 8)
+                {
+                    map.setCell(x, y, 1);
+                }
+            }
+        }
+    }
+
+    GridPoint freeCell(const Map& map, std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> px(0, map.getWidth() - 1);
+        std::uniform_int_distribution<int> py(0, map.getHeight() - 1);
+        while (true)
+        {
+            GridPoint p{px(rng), py(rng)};
+            if (map.isAccessible(p.first, p.second)) return p;
+        }
+    }
+}
+
+int main()
+{
+    const int side = 1024;
+    const int robotCount = 64;
+
+    Map map(side, side, "bench", "");
+    fillFarm(map, 42);
+
+    std::mt19937 rng(7);
+    std::vector<Robot> robots(robotCount);
+    std::vector<std::vector<float>> targets;
+    for (auto& robot : robots)
+    {
+        GridPoint p = freeCell(map, rng);
+        robot.position = {static_cast<float>(p.first), static_cast<float>(p.second)};
+        GridPoint t = freeCell(map, rng);
+        targets.push_back({static_cast<float>(t.first), static_cast<float>(t.second)});
+    }
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("%-8s %10s %8s %12s\n", "threads", "ms", "speedup", "checksum");
+    double baseline = 0.0;
+    for (unsigned threads : {1u, 2u, 4u, 8u})
+    {
+        WorkStealingPool pool(threads);
+        PathCache::instance().clear();
+        std::vector<Robot::Route> routes(robotCount);
+
+        auto t0 = std::chrono::steady_clock::now();
+        pool.parallelFor(robotCount, [&](std::size_t i) {
+            routes[i] = robots[i].planRoute(map, targets[i], PlannerAlgorithm::AStar);
+        });
+        auto t1 = std::chrono::steady_clock::now();
+
+        long long checksum = 0;
+        for (const auto& route : routes)
+        {
+            checksum += route.plan.cost;
+        }
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (threads == 1) baseline = ms;
+        std::printf("%-8u %10.2f %8.2f %12lld\n", threads, ms, baseline / ms, checksum);
+    }
+
+    const GridPoint depot = freeCell(map, rng);
+    const std::vector<float> depotTarget = {static_cast<float>(depot.first), static_cast<float>(depot.second)};
+    std::printf("\n%-8s %10s %12s\n", "recall", "ms", "checksum");
+    for (PlannerAlgorithm planner : {PlannerAlgorithm::Dijkstra, PlannerAlgorithm::FlowField})
+    {
+        PathCache::instance().clear();
+        long long checksum = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& robot : robots)
+        {
+            checksum += robot.planRoute(map, depotTarget, planner).plan.cost;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        std::printf("%-8s %10.2f %12lld\n", plannerAlgorithmName(planner),
+            std::chrono::duration<double, std::milli>(t1 - t0).count(), checksum);
+    }
+    return 0;
+}
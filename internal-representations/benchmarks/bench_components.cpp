@@ -0,0 +1,101 @@
+// Reachability benchmark on a 2048x2048 farm map whose north-east corner is
+// fenced off: labelling the map's components from scratch, relabelling after
+// one edit, and answering "can a robot at A reach B?" by component lookup vs
+// by a Dijkstra search (which, for a target inside the fence, floods every
+// cell the robot can reach before giving up). The answer counts must match.
+// Build and run from the repository root with: make bench
+
+#include "GridSearch.h"
+#include "Map.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    // Tree rows every 6 cells with a gap every 40 cells, plus 8% scattered obstacles
+    void fillFarm(Map& map, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                bool treeRow = (y % 6 == 3) && (x % 40 != 0);
+                if (treeRow || pct(rng) < 8)
+                {
+                    map.setCell(x, y, 1);
+                }
+            }
+        }
+    }
+
+    double msSince(std::chrono::steady_clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+int main()
+{
+    const int side = 2048;
+    const int fence = side - 256;
+    Map map(side, side, "bench", "");
+    fillFarm(map, 42);
+    for (int i = fence; i < side; ++i)
+    {
+        map.setCell(i, side - 256, 1);
+        map.setCell(fence, side - 256 + (i - fence), 1);
+    }
+
+    // Queries from the open field; every fourth target is inside the fence
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> outside(0, fence - 1);
+    std::uniform_int_distribution<int> inside(fence + 1, side - 1);
+    std::vector<std::pair<GridPoint, GridPoint>> queries;
+    while (queries.size() < 32)
+    {
+        GridPoint start{outside(rng), outside(rng)};
+        GridPoint goal = queries.size() % 4 == 0 ? GridPoint{inside(rng), inside(rng)} : GridPoint{outside(rng), outside(rng)};
+        if (map.isAccessible(start.first, start.second) && map.isAccessible(goal.first, goal.second))
+        {
+            queries.push_back({start, goal});
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    map.getComponent(0, 0);
+    std::printf("label map: %.2f ms\n", msSince(t0));
+
+    const int edits = 16;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < edits; ++i)
+    {
+        int x = 64 * i + 10;
+        map.setCell(x, 500, 1 - map.getCell(x, 500));
+        map.getComponent(0, 0);
+    }
+    std::printf("relabel after one edit: %.3f ms (mean of %d)\n", msSince(t0) / edits, edits);
+
+    std::printf("%-10s %10s %10s\n", "method", "ms", "reachable");
+    int reachable = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (const auto& [start, goal] : queries)
+    {
+        reachable += map.isReachable(start, goal);
+    }
+    std::printf("%-10s %10.3f %10d\n", "labels", msSince(t0), reachable);
+
+    reachable = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (const auto& [start, goal] : queries)
+    {
+        SearchWorkspace& ws = SearchWorkspace::acquire(map.getGrid());
+        SearchStats stats = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(map.getGrid(), ws, start, goal,
+                                                                                  [](int, int) { return 0; });
+        reachable += stats.goalCost != SearchWorkspace::UNREACHED;
+    }
+    std::printf("%-10s %10.3f %10d\n", "dijkstra", msSince(t0), reachable);
+    return 0;
+}
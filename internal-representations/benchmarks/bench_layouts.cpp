@@ -0,0 +1,136 @@
+// Grid layout benchmark: time and cache misses per planPath() search on
+// row-major vs Morton tile layouts, for maps 1k, 4k and 16k cells per side.
+// Build and run from the repository root with: make bench
+//
+// Cache misses come from the hardware counter via perf_event_open and are
+// reported as n/a when the kernel does not allow access to it.
+
+#include "Map.h"
+#include "PathPlanner.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter()
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        ~CacheMissCounter() { if (fd >= 0) close(fd); }
+
+        bool available() const { return fd >= 0; }
+        void start() { if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); } }
+        long long stop()
+        {
+            if (fd < 0) return -1;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+            return count;
+        }
+
+    private:
+        int fd = -1;
+    };
+
+    // Orchard-like map: tree rows every 6 cells with a gap every 40 cells,
+    // plus 8% scattered obstacles
+    void fillFarm(Map& map, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                bool treeRow = (y % 6 == 3) && (x % 40 != 0);
+                if (treeRow || pct(rng) < 8)
+                {
+                    map.setCell(x, y, 1);
+                }
+            }
+        }
+    }
+
+    struct Query { GridPoint start; GridPoint goal; };
+
+    std::vector<Query> makeQueries(const Map& map, int count, int radius, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<Query> queries;
+        while (static_cast<int>(queries.size()) < count)
+        {
+            std::uniform_int_distribution<int> px(radius, map.getWidth() - radius - 1);
+            std::uniform_int_distribution<int> py(radius, map.getHeight() - radius - 1);
+            std::uniform_int_distribution<int> off(-radius, radius);
+            GridPoint s{px(rng), py(rng)};
+            GridPoint g{s.first + off(rng), s.second + off(rng)};
+            if (map.isAccessible(s.first, s.second) && map.isAccessible(g.first, g.second))
+            {
+                queries.push_back({s, g});
+            }
+        }
+        return queries;
+    }
+}
+
+int main()
+{
+    const int sizes[] = {1024, 4096, 16384};
+    const int queryCount = 16;
+    const int radius = 300;
+    CacheMissCounter counter;
+
+    std::printf("%-8s %-9s %12s %14s %16s %10s\n", "side", "layout", "ms/search", "expanded/srch", "cache-miss/srch", "checksum");
+    for (int side : sizes)
+    {
+        for (GridLayout layout : {GridLayout::RowMajor, GridLayout::Morton})
+        {
+            Map map(side, side, "bench", "", layout);
+            fillFarm(map, 42);
+            auto queries = makeQueries(map, queryCount, radius, 7);
+
+            long long totalCost = 0;
+            std::size_t expanded = 0;
+            long long misses = 0;
+            double ms = 0.0;
+            for (const auto& q : queries)
+            {
+                counter.start();
+                auto t0 = std::chrono::steady_clock::now();
+                PlanResult r = planPath(map, q.start, q.goal);
+                auto t1 = std::chrono::steady_clock::now();
+                long long m = counter.stop();
+                misses += m > 0 ? m : 0;
+                ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+                expanded += r.expanded;
+                totalCost += r.cost;
+            }
+
+            char missText[32];
+            if (counter.available()) std::snprintf(missText, sizeof(missText), "%lld", misses / queryCount);
+            else std::snprintf(missText, sizeof(missText), "n/a");
+            std::printf("%-8d %-9s %12.2f %14zu %16s %10lld\n", side, layout == GridLayout::Morton ? "morton" : "rowmajor",
+                ms / queryCount, expanded / queryCount, missText, totalCost);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Planner benchmark: expansions and time per planPath() search for each
+// PlannerAlgorithm on an open field and an orchard map. The checksum column
+// is the sum of path costs and has to be identical for every exact planner
+// (hpa is near-optimal; theta measures straight segments, not 10/14 steps).
+// "points" is the average number of path points (waypoints for theta, and
+// for the "smoothed" row, which string-pulls the dijkstra paths). Every
+// query set runs twice: "cold ms" is the first
+// pass, which for hpa includes building the clusters it touches, and
+// "warm ms" the second. For alt the cold pass includes computing the
+// landmark distance fields; for dstar the warm pass reuses those cold searches
+// still within the set's memory budget, and the line below its row counts the
+// searches dropped for memory during the warm pass. The "replan" rows block one cell a
+// third of the way along each astar path, move the start ten steps on and plan
+// again, with dstar repairing the search it just made for that query (not
+// timed) and astar starting over; their checksums must match.
+// Build and run from the repository root with: make bench
+
+#include "AnyAnglePlanner.h"
+#include "Map.h"
+#include "PathPlanner.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    // percent scattered single-cell obstacles; orchard adds tree rows every
+    // 6 cells with a gap every 40 cells
+    void fillMap(Map& map, int percent, bool orchard, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                bool treeRow = orchard && (y % 6 == 3) && (x % 40 != 0);
+                if (treeRow || pct(rng) < percent)
+                {
+                    map.setCell(x, y, 1);
+                }
+            }
+        }
+    }
+
+    struct Query { GridPoint start; GridPoint goal; };
+
+    // Long queries: start and goal in opposite quarters of the map
+    std::vector<Query> makeQueries(const Map& map, int count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const int w = map.getWidth();
+        const int h = map.getHeight();
+        std::uniform_int_distribution<int> qx(0, w / 4 - 1);
+        std::uniform_int_distribution<int> qy(0, h / 4 - 1);
+        std::vector<Query> queries;
+        while (static_cast<int>(queries.size()) < count)
+        {
+            GridPoint s{qx(rng), qy(rng)};
+            GridPoint g{w - 1 - qx(rng), h - 1 - qy(rng)};
+            if (map.isAccessible(s.first, s.second) && map.isAccessible(g.first, g.second))
+            {
+                queries.push_back({s, g});
+            }
+        }
+        return queries;
+    }
+}
+
+int main()
+{
+    const int side = 2048;
+    const int queryCount = 8;
+    const PlannerAlgorithm planners[] = {PlannerAlgorithm::Dijkstra, PlannerAlgorithm::AStar, PlannerAlgorithm::Landmark,
+                                         PlannerAlgorithm::JumpPoint, PlannerAlgorithm::Hierarchical,
+                                         PlannerAlgorithm::AnyAngle, PlannerAlgorithm::Incremental};
+
+    struct Scenario { const char* name; int percent; bool orchard; };
+    const Scenario scenarios[] = {{"open", 2, false}, {"orchard", 8, true}};
+
+    std::printf("%-8s %-9s %10s %10s %14s %12s %8s\n", "map", "planner", "cold ms", "warm ms", "expanded/srch",
+        "checksum", "points");
+    for (const auto& scenario : scenarios)
+    {
+        Map map(side, side, "bench", "");
+        fillMap(map, scenario.percent, scenario.orchard, 42);
+        auto queries = makeQueries(map, queryCount, 7);
+
+        for (PlannerAlgorithm planner : planners)
+        {
+            long long totalCost = 0;
+            std::size_t expanded = 0;
+            std::size_t points = 0;
+            double ms[2] = {0.0, 0.0};
+            std::size_t evicted = 0;
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                if (pass == 1) evicted = map.getIncrementalEvictions();
+                for (const auto& q : queries)
+                {
+                    auto t0 = std::chrono::steady_clock::now();
+                    PlanResult r = planPath(map, q.start, q.goal, planner);
+                    auto t1 = std::chrono::steady_clock::now();
+                    ms[pass] += std::chrono::duration<double, std::milli>(t1 - t0).count();
+                    if (pass == 1)
+                    {
+                        expanded += r.expanded;
+                        totalCost += r.cost;
+                        points += r.path.size();
+                    }
+                }
+            }
+            std::printf("%-8s %-9s %10.2f %10.2f %14zu %12lld %8zu\n", scenario.name, plannerAlgorithmName(planner),
+                ms[0] / queryCount, ms[1] / queryCount, expanded / queryCount, totalCost, points / queryCount);
+            if (planner == PlannerAlgorithm::Incremental)
+            {
+                std::printf("%-8s dstar: %zu of %d searches evicted in the warm pass\n", scenario.name,
+                    map.getIncrementalEvictions() - evicted, queryCount);
+            }
+        }
+
+        // Smoothing pass alone, on top of the grid paths
+        {
+            long long totalCost = 0;
+            std::size_t points = 0;
+            double ms = 0.0;
+            for (const auto& q : queries)
+            {
+                PlanResult grid = planPath(map, q.start, q.goal);
+                auto t0 = std::chrono::steady_clock::now();
+                PlanResult r = smoothPath(map, grid);
+                auto t1 = std::chrono::steady_clock::now();
+                ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+                totalCost += r.cost;
+                points += r.path.size();
+            }
+            std::printf("%-8s %-9s %10s %10.2f %14s %12lld %8zu\n", scenario.name, "smoothed", "-", ms / queryCount, "-",
+                totalCost, points / queryCount);
+        }
+
+        // Replanning after an edit in front of the robot
+        for (PlannerAlgorithm planner : {PlannerAlgorithm::Incremental, PlannerAlgorithm::AStar})
+        {
+            long long totalCost = 0;
+            std::size_t expanded = 0;
+            double ms = 0.0;
+            for (const auto& q : queries)
+            {
+                PlanResult before = planPath(map, q.start, q.goal, PlannerAlgorithm::AStar);
+                if (before.path.size() < 30) continue;
+                if (planner == PlannerAlgorithm::Incremental) planPath(map, q.start, q.goal, planner);
+                GridPoint blocked = before.path[before.path.size() / 3];
+                map.setCell(blocked.first, blocked.second, 1);
+                auto t0 = std::chrono::steady_clock::now();
+                PlanResult r = planPath(map, before.path[10], q.goal, planner);
+                auto t1 = std::chrono::steady_clock::now();
+                map.setCell(blocked.first, blocked.second, 0);
+                ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+                expanded += r.expanded;
+                totalCost += r.cost;
+            }
+            std::printf("%-8s %-9s %10s %10.2f %14zu %12lld %8s\n", scenario.name,
+                planner == PlannerAlgorithm::Incremental ? "replan-d*" : "replan-a*", "-", ms / queryCount,
+                expanded / queryCount, totalCost, "-");
+        }
+
+        auto landmarks = map.getLandmarks();
+        if (landmarks) std::printf("%-8s alt: %zu landmarks, %.1f MiB each\n", scenario.name, landmarks->getLandmarks().size(),
+            landmarks->bytesPerLandmark() / (1024.0 * 1024.0));
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Open-list benchmark: searchGrid() with the binary heap vs Dial's bucket
+// queue, for Dijkstra and A* (8-connected 10/14) and for a 4-connected
+// unit-cost search, on an orchard-like farm map.
+// Checksums are summed path costs and must match between the two queues.
+// Build and run from the repository root with: make bench
+
+#include "GridSearch.h"
+#include "Map.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    // Tree rows every 6 cells with a gap every 40 cells, plus 8% scattered obstacles
+    void fillFarm(Map& map, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                bool treeRow = (y % 6 == 3) && (x % 40 != 0);
+                if (treeRow || pct(rng) < 8)
+                {
+                    map.setCell(x, y, 1);
+                }
+            }
+        }
+    }
+
+    struct Query { GridPoint start; GridPoint goal; };
+
+    std::vector<Query> makeQueries(const Map& map, int count, int radius, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<Query> queries;
+        std::uniform_int_distribution<int> px(radius, map.getWidth() - radius - 1);
+        std::uniform_int_distribution<int> py(radius, map.getHeight() - radius - 1);
+        std::uniform_int_distribution<int> off(-radius, radius);
+        while (static_cast<int>(queries.size()) < count)
+        {
+            GridPoint s{px(rng), py(rng)};
+            GridPoint g{s.first + off(rng), s.second + off(rng)};
+            if (map.isAccessible(s.first, s.second) && map.isAccessible(g.first, g.second))
+            {
+                queries.push_back({s, g});
+            }
+        }
+        return queries;
+    }
+
+    template <typename Neighbourhood, typename Cost, typename Queue, typename Heuristic>
+    void run(const char* search, const char* queue, const Map& map, const std::vector<Query>& queries, Heuristic heuristic)
+    {
+        long long checksum = 0;
+        std::size_t expanded = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& q : queries)
+        {
+            SearchWorkspace& ws = SearchWorkspace::acquire(map.getGrid());
+            SearchStats stats = searchGrid<Neighbourhood, Cost, Queue>(map.getGrid(), ws, q.start, q.goal,
+                [&](int x, int y) { return heuristic(x, y, q.goal); });
+            expanded += stats.expanded;
+            checksum += stats.goalCost == SearchWorkspace::UNREACHED ? -1 : stats.goalCost;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        std::printf("%-10s %-7s %12.3f %14zu %12lld\n", search, queue, ms / queries.size(),
+            expanded / queries.size(), checksum);
+    }
+}
+
+int main()
+{
+    Map map(2048, 2048, "bench", "");
+    fillFarm(map, 42);
+    auto queries = makeQueries(map, 32, 300, 7);
+
+    auto none = [](int, int, GridPoint) { return 0; };
+    auto octile = [](int x, int y, GridPoint goal) { return octileDistance({x, y}, goal); };
+
+    std::printf("%-10s %-7s %12s %14s %12s\n", "search", "queue", "ms/search", "expanded/srch", "checksum");
+    run<EightConnected, OctileCost, BinaryHeapQueue>("dijkstra", "heap", map, queries, none);
+    run<EightConnected, OctileCost, BucketQueue>("dijkstra", "bucket", map, queries, none);
+    run<EightConnected, OctileCost, BinaryHeapQueue>("astar", "heap", map, queries, octile);
+    run<EightConnected, OctileCost, BucketQueue>("astar", "bucket", map, queries, octile);
+    run<FourConnected, UnitCost, BinaryHeapQueue>("4-conn", "heap", map, queries, none);
+    run<FourConnected, UnitCost, BucketQueue>("4-conn", "bucket", map, queries, none);
+    return 0;
+}
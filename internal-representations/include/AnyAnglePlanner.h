@@ -0,0 +1,33 @@
+#ifndef H_ANY_ANGLE_PLANNER
+#define H_ANY_ANGLE_PLANNER
+
+#include "PathPlanner.h"
+
+// True if a robot can drive the straight line between the centres of a and
+// b: every cell the segment passes through is accessible. Where the segment
+// runs exactly through a cell corner only the diagonal cell is checked, as
+// for a diagonal grid step. The cell a itself is not checked (a robot may
+// drive off a blocked start).
+bool hasLineOfSight(const Map& map, GridPoint a, GridPoint b);
+
+// Straight-line cost between the centres of a and b in planner units (10 per
+// cell width), rounded to nearest
+int segmentCost(GridPoint a, GridPoint b);
+
+// Lazy Theta*: A* over the 8-connected grid where a cell may take its
+// parent's parent as its own parent when the two can see each other, so
+// paths run at any angle. Line of sight is only checked when a cell is
+// expanded, not for every neighbour generated. The waypoints (start and goal
+// included) are each in line of sight of the next; the path is the grid
+// steps along those segments, the cells hasLineOfSight walks. Cost is the
+// sum of the segmentCosts (so a diagonal counts 14.1, not 14 as in
+// planPath). Usually close to the true shortest, not guaranteed.
+PlanResult lazyThetaStar(const Map& map, GridPoint start, GridPoint goal);
+
+// String-pulling post-pass over a grid path: drops every cell the previous
+// kept cell can see past. Returns the waypoints and the grid steps along
+// them, as lazyThetaStar does, with their segmentCost sum; expanded is
+// copied over.
+PlanResult smoothPath(const Map& map, const PlanResult& plan);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef H_BATCH_PATHFIND
+#define H_BATCH_PATHFIND
+
+#include "PathPlanner.h"
+#include "Robot.h"
+#include <string>
+#include <vector>
+
+class Map;
+
+// One robot's pathfind call within a batch
+struct PathfindRequest
+{
+    Robot* robot;
+    std::vector<float> target;
+    std::vector<std::string> taskModules; // invoked on arrival, may be empty
+};
+
+// Same effect as calling robot->pathfind(map, target, taskModules, algorithm)
+// for each request in order, but all routes are planned first, concurrently
+// on the shared WorkStealingPool. With an exact algorithm, eight or more
+// requests sharing a goal read their routes from its flow field instead (same
+// costs, possibly another of the equally short paths), as long as one field
+// fits FlowFieldSet::MEMORY_BUDGET. Moves, log lines and module invocations
+// then happen one request at a time in request order, so the outcome does
+// not depend on the thread count. Every request must name a different robot.
+void pathfindBatch(const Map& map, const std::vector<PathfindRequest>& requests,
+                   PlannerAlgorithm algorithm = PlannerAlgorithm::Dijkstra);
+
+// Joint planner for pathfindCooperative
+enum class JointPlanner
+{
+    Prioritized,  // planCooperative: one robot after another, request order
+    ConflictBased // planConflictBased within its time budget, else Prioritized
+};
+
+// Like pathfindBatch, but the robots that have somewhere to go are planned
+// together (request order is their priority), so their moves never share a
+// cell at the same step or swap places; a path may wait in place. Every other
+// robot on the map stays where it is and is planned around. Routes that do
+// not need planning (no target, at target, bad target) behave exactly as in
+// pathfindBatch.
+void pathfindCooperative(const Map& map, const std::vector<PathfindRequest>& requests,
+                         JointPlanner planner = JointPlanner::Prioritized);
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef H_COMPACT_PATH
+#define H_COMPACT_PATH
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using GridPoint = std::pair<int, int>;
+
+// A grid path whose every step moves to one of the 8 neighbouring cells or
+// waits a step in place (timed paths from joint planning), stored as its
+// first cell plus runs of step codes: the move codes of SearchWorkspace::DX/DY,
+// then WAIT. One byte per run of up to MAX_RUN steps with one code, so a path
+// of n steps with r turns takes about r + n / MAX_RUN bytes instead of 8 n as
+// a vector of cells. Cells are read back through random-access iterators;
+// a checkpoint every CHECKPOINT_RUNS runs keeps indexing O(log n).
+// It is the path type of PlanResult, so robot routes, PathCache entries and
+// HPA* routes all hold paths this way.
+class CompactPath
+{
+public:
+    static constexpr int MAX_RUN = 16;
+    static constexpr int WAIT = 8; // step code for staying in place
+    static constexpr std::size_t CHECKPOINT_RUNS = 64;
+
+    class const_iterator;
+
+    CompactPath() = default;
+    explicit CompactPath(GridPoint start);
+
+    // Throws std::invalid_argument if two consecutive cells are not neighbours
+    explicit CompactPath(const std::vector<GridPoint>& cells);
+
+    // Whether every step of cells is to a neighbouring cell or a wait, so
+    // the constructor above accepts it
+    static bool isUnitStepPath(const std::vector<GridPoint>& cells);
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; } // cells, both ends included
+    GridPoint front() const { return start; }
+    GridPoint back() const { return last; }
+    GridPoint operator[](std::size_t i) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // Extend by one cell, which must neighbour or equal back() (any cell if
+    // empty); throws std::invalid_argument otherwise
+    void push_back(GridPoint cell);
+
+    // Concatenate a path that starts at back() (the shared cell is kept
+    // once) or next to it; throws std::invalid_argument otherwise
+    void append(const CompactPath& other);
+
+    std::vector<GridPoint> toVector() const;
+
+    // Self-contained little-endian byte string; deserialize throws
+    // std::invalid_argument on anything serialize could not have produced
+    std::string serialize() const;
+    static CompactPath deserialize(const std::string& bytes);
+
+    std::size_t memoryBytes() const;
+
+    bool operator==(const CompactPath& other) const;
+    bool operator!=(const CompactPath& other) const { return !(*this == other); }
+
+private:
+    struct Checkpoint
+    {
+        std::size_t step; // index of the cell run CHECKPOINT_RUNS * k starts from
+        GridPoint cell;
+    };
+
+    struct Position
+    {
+        std::size_t run;    // run holding the step out of the cell, runs.size() at the last cell
+        int offset;         // steps of that run already taken
+        GridPoint cell;
+    };
+
+    GridPoint start{0, 0};
+    GridPoint last{0, 0};
+    std::size_t count = 0;
+    std::vector<std::uint8_t> runs; // step code << 4 | (run length - 1)
+    std::vector<Checkpoint> checkpoints;
+
+    static int runCode(std::uint8_t run) { return run >> 4; }
+    static int runLength(std::uint8_t run) { return (run & 15) + 1; }
+
+    void pushRun(int code, int length);
+    Position seek(std::size_t i) const;
+};
+
+class CompactPath::const_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = GridPoint;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const GridPoint*;
+    using reference = GridPoint; // cells are decoded, not stored
+
+    const_iterator() = default;
+
+    GridPoint operator*() const { return at.cell; }
+    const GridPoint* operator->() const { return &at.cell; }
+    GridPoint operator[](difference_type n) const { return *(*this + n); }
+
+    const_iterator& operator++();
+    const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+    const_iterator& operator--() { return *this -= 1; }
+    const_iterator operator--(int) { const_iterator old = *this; --*this; return old; }
+    const_iterator& operator+=(difference_type n);
+    const_iterator& operator-=(difference_type n) { return *this += -n; }
+    friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+    friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+    friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const const_iterator& a, const const_iterator& b)
+    {
+        return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+    }
+
+    bool operator==(const const_iterator& other) const { return index == other.index; }
+    bool operator!=(const const_iterator& other) const { return index != other.index; }
+    bool operator<(const const_iterator& other) const { return index < other.index; }
+    bool operator>(const const_iterator& other) const { return index > other.index; }
+    bool operator<=(const const_iterator& other) const { return index <= other.index; }
+    bool operator>=(const const_iterator& other) const { return index >= other.index; }
+
+private:
+    friend class CompactPath;
+
+    const CompactPath* path = nullptr;
+    std::size_t index = 0; // cell index, path->size() at the end
+    Position at{0, 0, {0, 0}};
+
+    const_iterator(const CompactPath* path, std::size_t index);
+};
+
+#endif
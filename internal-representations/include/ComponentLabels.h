@@ -0,0 +1,64 @@
+#ifndef H_COMPONENT_LABELS
+#define H_COMPONENT_LABELS
+
+#include "PathPlanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class TiledGrid;
+
+// Connected components of the free cells of one map under the robot motion
+// model (8-connected, a step only needs its target cell free): two free
+// cells share a label exactly when a robot can drive from one to the other.
+// Cells are labelled per grid tile (a uniform tile is one label with no
+// per-cell storage), and a union-find over the tile labels joins them
+// across tile borders. On the first query after an edit only the tiles the
+// map journal reports as changed are relabelled; the cross-tile union is
+// redone over tile labels, not cells.
+class ComponentLabels
+{
+public:
+    static constexpr std::uint32_t NONE = 0; // blocked or outside the map
+
+    ComponentLabels() = default;
+    ComponentLabels(const ComponentLabels& other);
+    ComponentLabels& operator=(const ComponentLabels& other);
+
+    // Component of cell (x, y) on the map as it is now
+    std::uint32_t label(const Map& map, int x, int y);
+
+    // Whether planPath can find a path from start to goal, with its rules: the
+    // goal must be free, a blocked start may drive off onto a free neighbour
+    bool reachable(const Map& map, GridPoint start, GridPoint goal);
+
+    std::size_t componentCount(const Map& map);
+
+private:
+    struct TileLabels
+    {
+        std::uint16_t count = 0;          // labels 1..count in this tile
+        std::vector<std::uint16_t> cells; // local label per cell, row-major; empty for a uniform tile
+        std::uint32_t firstNode = 0;      // union-find node of local label 1
+    };
+
+    mutable std::mutex mu;
+    bool built = false;
+    int width = 0;
+    int height = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::uint64_t syncedVersion = 0;
+    std::vector<TileLabels> tiles;
+    std::vector<std::uint32_t> component; // union-find node -> label, 1..componentTotal
+    std::uint32_t componentTotal = 0;
+
+    void sync(const Map& map);
+    void labelTile(const TiledGrid& grid, int tile);
+    void joinTiles();
+    std::uint32_t lookup(int x, int y) const;
+    std::uint16_t localLabel(int tile, int lx, int ly) const;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef H_CONFLICT_BASED_SEARCH
+#define H_CONFLICT_BASED_SEARCH
+
+#include "SpaceTimePlanner.h"
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+class Map;
+
+struct JointPlan
+{
+    std::vector<TimedPath> paths; // one per agent, in query order
+    bool solved = false;          // by CBS; otherwise by the prioritized fallback
+    std::size_t nodes = 0;        // constraint-tree nodes expanded
+};
+
+// Conflict-Based Search: every agent is planned on its own with
+// planSpaceTime; the earliest vertex or swap conflict between two paths then
+// splits the search into two branches, each forbidding that cell (or move) at
+// that step to one of the two agents, and only that agent is replanned. Cells
+// in stationary are blocked for everyone throughout.
+//
+// This is ECBS: each low-level search is a focal search (see
+// planSpaceTime) that may return a path up to suboptimality times the
+// cheapest in exchange for fewer conflicts, and reports a lower bound on the
+// cheapest. Of the open nodes costing at most suboptimality times the least
+// sum of those bounds, the one with the fewest conflicts is expanded next, so
+// the result costs at most suboptimality times the optimum; 1 gives plain,
+// optimal CBS. When a replanned path costs no more and conflicts less, it
+// replaces the node's path instead of splitting the tree (bypass).
+//
+// If budget runs out first, or the agents cannot be separated, the result
+// comes from planCooperative in query order instead, with a budget of its
+// own, and solved is false.
+JointPlan planConflictBased(const Map& map, const std::vector<AgentQuery>& agents,
+                           const std::vector<GridPoint>& stationary = {},
+                           std::chrono::milliseconds budget = std::chrono::milliseconds(200),
+                           double suboptimality = 1.0);
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef H_D_STAR_LITE
+#define H_D_STAR_LITE
+
+#include "PathPlanner.h"
+#include "TiledGrid.h"
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// D* Lite toward one fixed goal, over the same motion model as planPath
+// (8-connected, 10/14 step costs, a step only needs its target cell free).
+// The search runs backward from the goal and keeps its state between calls:
+// before each plan() it reads the map journal for cells changed since the
+// last call and only repairs the part of the search those cells affect, and
+// a start that moved is absorbed by the key modifier instead of a restart.
+// The first call costs about as much as an A* search; later ones after a
+// small edit or a few steps along the path are much cheaper. State (g and
+// rhs, 8 bytes a cell) is kept in BLOCK x BLOCK blocks, allocated when the
+// search first touches one.
+class DStarLite
+{
+public:
+    explicit DStarLite(GridPoint goal);
+
+    // Minimum-cost path from start to the goal on the map as it is now, with
+    // the same start/goal rules as planPath; expanded counts only this call's
+    // work. The map must be the same one (or a copy of it) on every call.
+    PlanResult plan(const Map& map, GridPoint start);
+
+    GridPoint getGoal() const { return goal; }
+    std::size_t stateCount() const { return allocatedBlocks * BLOCK * BLOCK; }
+    std::size_t memoryBytes() const;
+
+private:
+    static constexpr int INF = INT_MAX;
+    static constexpr int BLOCK = 32;
+    // The key modifier only grows as the start moves; past this the queue is
+    // re-keyed from the current start, so keys never overflow
+    static constexpr int KM_LIMIT = 1 << 20;
+
+    // Open while g != rhs. Keys are not stored: a queued entry is recomputed
+    // against the state when it reaches the top (see topEntry).
+    struct State
+    {
+        int g = INF;
+        int rhs = INF;
+    };
+
+    struct Entry
+    {
+        int key1;
+        int key2;
+        int x;
+        int y;
+    };
+
+    // Queued entries sharing one key1, most recent on top. minKey2 is at
+    // most the smallest key2 among them (it is not raised by pops).
+    struct Bucket
+    {
+        std::vector<Entry> entries;
+        int minKey2 = INF;
+    };
+
+    GridPoint goal;
+    GridPoint lastStart{-1, -1}; // start the queued keys are relative to
+    int km = 0; // sum of start moves since the last re-key, added to every key
+    bool initialized = false;
+    std::uint64_t syncedVersion = 0;
+    int width = 0;
+    int height = 0;
+    int blocksWide = 0;
+    std::vector<std::vector<State>> blocks; // row-major by block; empty until touched
+    std::size_t allocatedBlocks = 0;
+    // Open list by key1, popped last in first out within a key1, which
+    // favours deeper states; the lexicographic order D* Lite needs is only
+    // checked against the start. Lazy: an entry whose state is no longer
+    // open, or was queued again with a lower key, is skipped.
+    std::map<int, Bucket> buckets; // empty buckets are dropped
+    std::size_t queued = 0;
+
+    void reset(const Map& map, GridPoint start);
+    void rekey();
+    void sync(const Map& map);
+    std::size_t computeShortestPath(const Map& map);
+    void updateVertex(const Map& map, GridPoint u);
+    template <typename Visit>
+    void forEachPredecessor(const Map& map, GridPoint u, Visit&& visit) const;
+    void enqueue(GridPoint u, State& s);
+    void pushEntry(const Entry& entry);
+    bool topEntry(Entry& out, int& minKey2);
+    void popEntry();
+    void calculateKey(const State& s, GridPoint u, int& key1, int& key2) const;
+    bool passable(const Map& map, int x, int y) const;
+    // Whether the step in direction dir out of from (whose reference is cell) lands on a free cell
+    bool passable(const TiledGrid& grid, TiledGrid::CellRef cell, GridPoint from, int dir) const;
+    int gOf(GridPoint u) const;
+    const State* findState(GridPoint u) const; // nullptr if its block was never touched
+
+    State& stateAt(GridPoint u)
+    {
+        std::vector<State>& block = blocks[(u.second / BLOCK) * blocksWide + u.first / BLOCK];
+        if (block.empty())
+        {
+            block.resize(BLOCK * BLOCK);
+            ++allocatedBlocks;
+        }
+        return block[(u.second % BLOCK) * BLOCK + u.first % BLOCK];
+    }
+};
+
+// D* Lite searches of one map, one per robot and goal, so repeated queries
+// of a robot toward the same goal (re-planning on its way, or after edits)
+// reuse the search; a search shared between robots would see its start jump
+// between them on every query. Keeps the most recently used searches that
+// fit in the memory budget (always at least one); a search over most of a
+// 2048 x 2048 map takes about 32 MiB, so maps with many robots or goals in
+// rotation may want more than the default. Queries for different slots
+// run concurrently; queries for the same slot take turns.
+class DStarLiteSet
+{
+public:
+    static constexpr std::size_t MEMORY_BUDGET = std::size_t(128) << 20; // default bytes per map
+
+    DStarLiteSet() = default;
+    DStarLiteSet(const DStarLiteSet& other);
+    DStarLiteSet& operator=(const DStarLiteSet& other);
+
+    // agent names the robot asking; queries without one share a slot per goal
+    PlanResult plan(const Map& map, GridPoint start, GridPoint goal, const std::string& agent = {});
+
+    // Takes effect from the next query
+    void setMemoryBudget(std::size_t bytes) { budget = bytes; }
+    std::size_t getMemoryBudget() const { return budget; }
+
+    // Searches dropped so far to stay within the budget
+    std::size_t getEvictions() const { return evictions; }
+
+private:
+    struct Slot
+    {
+        std::mutex mu;
+        DStarLite planner;
+        std::atomic<std::size_t> bytes{0}; // planner.memoryBytes() after its last query
+        explicit Slot(const DStarLite& p) : planner(p), bytes(p.memoryBytes()) {}
+    };
+
+    using SlotKey = std::pair<std::string, GridPoint>;
+
+    mutable std::mutex mu;
+    std::list<std::pair<SlotKey, std::shared_ptr<Slot>>> slots; // most recently used first
+    std::atomic<std::size_t> budget{MEMORY_BUDGET};
+    std::atomic<std::size_t> evictions{0};
+};
+
+#endif
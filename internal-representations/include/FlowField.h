@@ -0,0 +1,95 @@
+#ifndef H_FLOW_FIELD
+#define H_FLOW_FIELD
+
+#include "PathPlanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TiledGrid;
+
+// Distance and direction to one goal from every cell of one version of a
+// map, from a single reverse Dijkstra flood over the robot motion model.
+// Any number of robots heading for the goal then read their next step (or
+// their whole path) straight from the field, with no search of their own.
+// Paths have the minimum planPath cost.
+class FlowField
+{
+public:
+    static constexpr int UNREACHED = INT32_MAX;
+
+    FlowField(const TiledGrid& grid, std::uint64_t version, GridPoint goal);
+
+    std::uint64_t getVersion() const { return version; }
+    GridPoint getGoal() const { return goal; }
+    std::size_t getExpanded() const { return expanded; } // cells the flood settled
+    std::size_t memoryBytes() const { return dist.size() * (sizeof(std::int32_t) + sizeof(std::uint8_t)); }
+
+    // Cost of the cheapest path from the cell to the goal, UNREACHED if there
+    // is none. A blocked cell (a robot may start on one) is costed through its
+    // best free neighbour.
+    int distance(GridPoint from) const;
+
+    // The cell to step to from the given one: from itself at the goal,
+    // {-1, -1} if the goal cannot be reached
+    GridPoint nextStep(GridPoint from) const;
+
+    // The whole path from the cell, as planPath would return it; expanded is 0
+    PlanResult path(GridPoint from) const;
+
+private:
+    static constexpr std::uint8_t NONE = 0xFF;
+
+    int width;
+    int height;
+    std::uint64_t version;
+    GridPoint goal;
+    std::size_t expanded = 0;
+    std::vector<std::int32_t> dist; // y * width + x
+    std::vector<std::uint8_t> next; // move code toward the goal, NONE at the goal and where unreached
+
+    bool inBounds(GridPoint p) const { return p.first >= 0 && p.first < width && p.second >= 0 && p.second < height; }
+    std::size_t index(GridPoint p) const { return static_cast<std::size_t>(p.second) * width + p.first; }
+    int bestNeighbour(GridPoint from, int& cost) const; // move code, -1 if none reaches the goal
+};
+
+// Flow fields of one map, built on the first request for a goal and dropped
+// once the map version moves on. Keeps the most recently used fields that
+// fit in MEMORY_BUDGET; a field larger than that is handed out but never
+// kept, and callers should plan without one (see fits). Concurrent requests for a new
+// goal build its field once; the others wait for it. Callers hold a
+// shared_ptr, so eviction never pulls a field from under a reader.
+class FlowFieldSet
+{
+public:
+    static constexpr std::size_t MEMORY_BUDGET = std::size_t(128) << 20; // bytes per map
+
+    // Bytes of one field over a width x height map, and whether one fits the budget
+    static std::size_t fieldBytes(int width, int height)
+    {
+        return static_cast<std::size_t>(width) * height * (sizeof(std::int32_t) + sizeof(std::uint8_t));
+    }
+    static bool fits(int width, int height) { return fieldBytes(width, height) <= MEMORY_BUDGET; }
+
+    FlowFieldSet() = default;
+    FlowFieldSet(const FlowFieldSet& other);
+    FlowFieldSet& operator=(const FlowFieldSet& other);
+
+    std::shared_ptr<const FlowField> get(const TiledGrid& grid, std::uint64_t version, GridPoint goal) const;
+
+private:
+    struct Slot
+    {
+        std::mutex mu;
+        std::shared_ptr<const FlowField> field; // null until built
+    };
+
+    mutable std::mutex mu;
+    mutable std::uint64_t version = 0;
+    mutable std::list<std::pair<GridPoint, std::shared_ptr<Slot>>> slots; // most recently used first
+};
+
+#endif
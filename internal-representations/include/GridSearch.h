@@ -0,0 +1,459 @@
+#ifndef H_GRID_SEARCH
+#define H_GRID_SEARCH
+
+#include "PathPlanner.h"
+#include "SearchWorkspace.h"
+#include "TiledGrid.h"
+#include <algorithm>
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+// Shared best-first search over a TiledGrid. Every search is a template over
+// compile-time policies, so each combination is compiled as one inlined loop:
+//   Neighbourhood - which moves exist (a prefix of SearchWorkspace's codes)
+//   Cost          - what each move costs, and the largest single-step cost
+//   Queue         - the open list (BinaryHeapQueue or BucketQueue)
+//   Access        - which cells a search may enter (FreeCells by default)
+//   heuristic     - a callable (x, y) -> lower bound on the cost to the goal
+// Start/goal validation and what to do with the result stay with the caller.
+// Search state goes into a SearchWorkspace, so a finished search can be
+// turned into a path with readPath().
+
+// The four cardinal moves plus the four diagonals
+struct EightConnected
+{
+    static constexpr int MOVES = 8;
+};
+
+// Cardinal moves only
+struct FourConnected
+{
+    static constexpr int MOVES = 4;
+};
+
+// 10 per cardinal and 14 per diagonal step
+struct OctileCost
+{
+    static constexpr int MAX_STEP = 14;
+    static int step(int dir) { return dir < 4 ? 10 : 14; }
+};
+
+// 1 per step
+struct UnitCost
+{
+    static constexpr int MAX_STEP = 1;
+    static int step(int) { return 1; }
+};
+
+// Cells holding 0 are passable
+struct FreeCells
+{
+    bool passable(const TiledGrid& grid, TiledGrid::CellRef cell) const { return grid.get(cell) == 0; }
+};
+
+// The motion model robots execute. Planning (planPath) and task assignment
+// (TaskManager) both search with it, so assignment costs are the costs of
+// the paths robots then drive.
+using RobotNeighbourhood = EightConnected;
+using RobotCost = OctileCost;
+
+// Open-list entry: key is the priority (f), cost the path cost so far (g)
+struct SearchNode
+{
+    int key;
+    int cost;
+    int x;
+    int y;
+};
+
+// Pop order among nodes of equal key, shared by both queues: the larger cost
+// (the deeper node) first, then the lower y, then the lower x. Expansion
+// order, and so the path picked among equal-cost ones, then never depends on
+// the order neighbours were pushed in.
+inline bool popsAfterSameKey(const SearchNode& a, const SearchNode& b)
+{
+    if (a.cost != b.cost) return a.cost < b.cost;
+    return a.y != b.y ? a.y > b.y : a.x > b.x;
+}
+
+// Binary heap with lazy deletion
+class BinaryHeapQueue
+{
+public:
+    explicit BinaryHeapQueue(int /*maxKeyStep*/ = 0) {}
+
+    bool empty() const { return heap.empty(); }
+    int minKey() const { return heap.top().key; }
+    void push(const SearchNode& node) { heap.push(node); }
+    SearchNode pop()
+    {
+        SearchNode node = heap.top();
+        heap.pop();
+        return node;
+    }
+    void clear() { heap = decltype(heap)(); }
+
+private:
+    struct Cmp
+    {
+        bool operator()(const SearchNode& a, const SearchNode& b) const
+        {
+            return a.key != b.key ? a.key > b.key : popsAfterSameKey(a, b);
+        }
+    };
+    std::priority_queue<SearchNode, std::vector<SearchNode>, Cmp> heap;
+};
+
+// Dial's circular bucket queue for small integer keys. Valid when keys are
+// popped in non-decreasing order and no key is pushed more than maxKeyStep
+// above the last popped one (Dijkstra: the largest edge cost; A* with a
+// consistent heuristic: twice that). Each bucket holds one key and is sorted
+// in popsAfterSameKey order when it becomes the lowest, so ties pop exactly as
+// from the binary heap. Pushes into that bucket then are children of the node
+// just popped, deeper than anything left in it, and land at the back in O(1).
+class BucketQueue
+{
+public:
+    explicit BucketQueue(int maxKeyStep)
+    {
+        std::size_t count = 1;
+        while (count <= static_cast<std::size_t>(maxKeyStep)) count <<= 1;
+        buckets.resize(count);
+        mask = count - 1;
+    }
+
+    bool empty() const { return size == 0; }
+    void push(const SearchNode& node)
+    {
+        // An empty queue takes the new key as its floor, unless the key is
+        // inside the window above the last pop (children of the node just
+        // popped may be cheaper than the first of them to arrive)
+        if (size == 0 && (node.key < current || node.key - current >= static_cast<int>(buckets.size())))
+        {
+            current = node.key;
+        }
+        auto& bucket = buckets[static_cast<std::size_t>(node.key) & mask];
+        if (node.key == sortedKey && !bucket.empty() && !popsAfterSameKey(bucket.back(), node))
+        {
+            bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), node, popsAfterSameKey), node);
+        }
+        else
+        {
+            bucket.push_back(node);
+        }
+        ++size;
+    }
+    int minKey()
+    {
+        while (buckets[static_cast<std::size_t>(current) & mask].empty()) ++current;
+        return current;
+    }
+    SearchNode pop()
+    {
+        auto& bucket = buckets[static_cast<std::size_t>(minKey()) & mask];
+        if (current != sortedKey)
+        {
+            std::sort(bucket.begin(), bucket.end(), popsAfterSameKey);
+            sortedKey = current;
+        }
+        SearchNode node = bucket.back();
+        bucket.pop_back();
+        --size;
+        return node;
+    }
+    void clear()
+    {
+        for (auto& bucket : buckets) bucket.clear();
+        size = 0;
+        sortedKey = -1;
+    }
+
+private:
+    std::vector<std::vector<SearchNode>> buckets;
+    std::size_t mask = 0;
+    std::size_t size = 0;
+    int current = 0;
+    int sortedKey = -1; // key of the bucket kept sorted, if any
+};
+
+// Early exits for callers that only need cheap answers (assignment costs,
+// say). A search stopped by either limit reports the goal, or each target
+// still unsettled, as EXCEEDED instead of UNREACHED: the true cost is above
+// maxCost, or was not found within maxExpanded expansions.
+struct SearchLimits
+{
+    static constexpr int EXCEEDED = SearchWorkspace::UNREACHED - 1;
+
+    int maxCost = SearchWorkspace::UNREACHED - 2; // costs up to this are exact
+    std::size_t maxExpanded = static_cast<std::size_t>(-1);
+
+    bool stops(int key, std::size_t expanded) const { return key > maxCost || expanded >= maxExpanded; }
+};
+
+struct SearchStats
+{
+    int goalCost = SearchWorkspace::UNREACHED; // or SearchLimits::EXCEEDED
+    std::size_t expanded = 0;
+};
+
+// Search from start until goal is popped (or the reachable area is
+// exhausted). heuristic(x, y) must be consistent for the cost model; pass
+// one returning 0 for Dijkstra. Cells other than the start must be passable.
+template <typename Neighbourhood, typename Cost, typename Queue, typename Access = FreeCells, typename Heuristic>
+SearchStats searchGrid(const TiledGrid& grid, SearchWorkspace& ws, GridPoint start, GridPoint goal, Heuristic heuristic,
+                       const Access& access = Access(), const SearchLimits& limits = SearchLimits())
+{
+    // Queue storage is kept per thread and per policy between searches
+    thread_local Queue open(2 * Cost::MAX_STEP);
+    open.clear();
+
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+    const int* dx = SearchWorkspace::DX;
+    const int* dy = SearchWorkspace::DY;
+    SearchStats stats;
+
+    ws.set(start.first, start.second, 0, 0);
+    open.push({heuristic(start.first, start.second), 0, start.first, start.second});
+
+    while (!open.empty())
+    {
+        SearchNode cur = open.pop();
+
+        TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+        if (cur.cost != ws.getDist(curRef)) continue; // stale
+        if (limits.stops(cur.key, stats.expanded))
+        {
+            stats.goalCost = SearchLimits::EXCEEDED;
+            break;
+        }
+        ++stats.expanded;
+
+        if (cur.x == goal.first && cur.y == goal.second)
+        {
+            stats.goalCost = cur.cost;
+            break;
+        }
+
+        for (int dir = 0; dir < Neighbourhood::MOVES; ++dir)
+        {
+            int nx = cur.x + dx[dir];
+            int ny = cur.y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+
+            // Neighbour index via the layout's own arithmetic
+            TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, dx[dir], dy[dir]);
+            if (!access.passable(grid, nRef)) continue;
+
+            int nCost = cur.cost + Cost::step(dir);
+            if (nCost < ws.getDist(nRef))
+            {
+                ws.set(nRef, nCost, dir);
+                open.push({nCost + heuristic(nx, ny), nCost, nx, ny});
+            }
+        }
+    }
+    return stats;
+}
+
+// Shortest distance from start to goal without building a path: Dijkstra
+// from both ends at once, always advancing the side whose open list has the
+// smaller minimum key. Every time a relaxed cell has also been reached from
+// the other side, the two halves give a candidate distance; once the two
+// minimum keys together reach the best candidate no shorter connection can
+// exist. The goal must be passable; the start need not be. Under limits the
+// two minimum keys together bound every connection not yet found.
+template <typename Neighbourhood, typename Cost, typename Queue, typename Access = FreeCells>
+SearchStats bidirectionalDistance(const TiledGrid& grid, GridPoint start, GridPoint goal, const Access& access = Access(),
+                                  const SearchLimits& limits = SearchLimits())
+{
+    SearchStats stats;
+    if (start == goal)
+    {
+        stats.goalCost = 0;
+        return stats;
+    }
+
+    thread_local Queue forwardOpen(Cost::MAX_STEP);
+    thread_local Queue backwardOpen(Cost::MAX_STEP);
+    forwardOpen.clear();
+    backwardOpen.clear();
+    SearchWorkspace& forward = SearchWorkspace::acquire(grid, 0);
+    SearchWorkspace& backward = SearchWorkspace::acquire(grid, 1);
+
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+    const int* dx = SearchWorkspace::DX;
+    const int* dy = SearchWorkspace::DY;
+    int best = SearchWorkspace::UNREACHED;
+
+    forward.set(start.first, start.second, 0, 0);
+    forwardOpen.push({0, 0, start.first, start.second});
+    backward.set(goal.first, goal.second, 0, 0);
+    backwardOpen.push({0, 0, goal.first, goal.second});
+
+    while (!forwardOpen.empty() && !backwardOpen.empty())
+    {
+        int forwardMin = forwardOpen.minKey();
+        int backwardMin = backwardOpen.minKey();
+        if (best != SearchWorkspace::UNREACHED && forwardMin + backwardMin >= best) break;
+        if (limits.stops(std::min(forwardMin + backwardMin, best), stats.expanded))
+        {
+            best = SearchLimits::EXCEEDED;
+            break;
+        }
+
+        const bool isForward = forwardMin <= backwardMin;
+        Queue& open = isForward ? forwardOpen : backwardOpen;
+        SearchWorkspace& ws = isForward ? forward : backward;
+        const SearchWorkspace& other = isForward ? backward : forward;
+
+        SearchNode cur = open.pop();
+        TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+        if (cur.cost != ws.getDist(curRef)) continue; // stale
+        ++stats.expanded;
+
+        for (int dir = 0; dir < Neighbourhood::MOVES; ++dir)
+        {
+            int nx = cur.x + dx[dir];
+            int ny = cur.y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+
+            // Moves run forward in time, so the backward side may still
+            // reach a blocked start (a robot can drive off an obstacle)
+            TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, dx[dir], dy[dir]);
+            if (!access.passable(grid, nRef) && (isForward || nx != start.first || ny != start.second)) continue;
+
+            int nCost = cur.cost + Cost::step(dir);
+            if (nCost < ws.getDist(nRef))
+            {
+                ws.set(nRef, nCost, dir);
+                open.push({nCost, nCost, nx, ny});
+            }
+            int otherCost = other.getDist(nRef);
+            if (otherCost != SearchWorkspace::UNREACHED)
+            {
+                best = std::min(best, ws.getDist(nRef) + otherCost);
+            }
+        }
+    }
+    stats.goalCost = best;
+    return stats;
+}
+
+// One-to-many distances: a single Dijkstra flood from source that stops as
+// soon as every reachable target has been settled. out[i] is the distance to
+// targets[i], or UNREACHED. Impassable targets are never reached (except the
+// source itself, at 0) and do not hold up the early exit. Targets still
+// unsettled when limits stop the flood get EXCEEDED. Uses both of the
+// thread's workspace slots; returns the number of expanded cells.
+template <typename Neighbourhood, typename Cost, typename Queue, typename Access = FreeCells>
+std::size_t distanceField(const TiledGrid& grid, GridPoint source, const std::vector<GridPoint>& targets,
+                          std::vector<int>& out, const Access& access = Access(),
+                          const SearchLimits& limits = SearchLimits())
+{
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+    out.assign(targets.size(), SearchWorkspace::UNREACHED);
+
+    // Mark each distinct passable target in slot 1; pending counts the unsettled ones
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid, 0);
+    SearchWorkspace& marks = SearchWorkspace::acquire(grid, 1);
+    std::size_t pending = 0;
+    for (const GridPoint& t : targets)
+    {
+        if (t.first < 0 || t.first >= width || t.second < 0 || t.second >= height) continue;
+        if (t == source || !access.passable(grid, grid.ref(t.first, t.second))) continue;
+        if (marks.getDist(t.first, t.second) == SearchWorkspace::UNREACHED)
+        {
+            marks.set(t.first, t.second, 0, 0);
+            ++pending;
+        }
+    }
+
+    thread_local Queue open(Cost::MAX_STEP);
+    open.clear();
+    const int* dx = SearchWorkspace::DX;
+    const int* dy = SearchWorkspace::DY;
+    std::size_t expanded = 0;
+
+    ws.set(source.first, source.second, 0, 0);
+    open.push({0, 0, source.first, source.second});
+
+    bool stopped = false;
+    while (pending > 0 && !open.empty())
+    {
+        SearchNode cur = open.pop();
+        TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+        if (cur.cost != ws.getDist(curRef)) continue; // stale
+        if (limits.stops(cur.key, expanded))
+        {
+            stopped = true;
+            break;
+        }
+        ++expanded;
+
+        if (marks.getDist(curRef) == 0)
+        {
+            marks.set(curRef, 1, 0); // settled
+            --pending;
+        }
+
+        for (int dir = 0; dir < Neighbourhood::MOVES; ++dir)
+        {
+            int nx = cur.x + dx[dir];
+            int ny = cur.y + dy[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+
+            TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, dx[dir], dy[dir]);
+            if (!access.passable(grid, nRef)) continue;
+
+            int nCost = cur.cost + Cost::step(dir);
+            if (nCost < ws.getDist(nRef))
+            {
+                ws.set(nRef, nCost, dir);
+                open.push({nCost, nCost, nx, ny});
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < targets.size(); ++i)
+    {
+        const GridPoint& t = targets[i];
+        if (t == source)
+        {
+            out[i] = 0;
+        }
+        else if (t.first >= 0 && t.first < width && t.second >= 0 && t.second < height &&
+                 marks.getDist(t.first, t.second) == 1)
+        {
+            out[i] = ws.getDist(t.first, t.second);
+        }
+        else if (stopped && t.first >= 0 && t.first < width && t.second >= 0 && t.second < height &&
+                 marks.getDist(t.first, t.second) == 0)
+        {
+            out[i] = SearchLimits::EXCEEDED;
+        }
+    }
+    return expanded;
+}
+
+// start..goal by stepping back against the move codes a search recorded
+inline std::vector<GridPoint> readPath(const SearchWorkspace& ws, GridPoint start, GridPoint goal)
+{
+    std::vector<GridPoint> path;
+    GridPoint at = goal;
+    while (at != start)
+    {
+        path.push_back(at);
+        int dir = ws.getDirection(at.first, at.second);
+        at.first -= SearchWorkspace::DX[dir];
+        at.second -= SearchWorkspace::DY[dir];
+    }
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+#endif
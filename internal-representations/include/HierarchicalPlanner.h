@@ -0,0 +1,65 @@
+#ifndef H_HIERARCHICAL_PLANNER
+#define H_HIERARCHICAL_PLANNER
+
+#include "CompactPath.h"
+#include "PathPlanner.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TiledGrid;
+
+// HPA* abstraction of one map. The grid is cut into CLUSTER_SIZE square
+// clusters; every stretch of border where a robot can cross into a
+// neighbouring cluster gets entrance nodes on both sides (one per
+// ENTRANCE_SPACING cells), and each cluster stores the distances between its
+// own entrances. A query connects start and goal to the entrances of their
+// clusters, searches the small abstract graph and then refines each abstract
+// edge into grid steps inside a single cluster.
+//
+// Clusters are built on first use and dropped again when the map journal
+// reports a change within one cell of them. Paths are near-optimal, not
+// optimal; `cost` is the exact 10/14 cost of the returned path. Queries on
+// one planner may run concurrently; as for every other reader, the map must
+// not be edited while they do.
+class HierarchicalPlanner
+{
+public:
+    static constexpr int CLUSTER_SIZE = 32;
+    static constexpr int ENTRANCE_SPACING = 16;
+
+    HierarchicalPlanner() = default;
+    HierarchicalPlanner(const HierarchicalPlanner& other);
+    HierarchicalPlanner& operator=(const HierarchicalPlanner& other);
+
+    PlanResult plan(const Map& map, GridPoint start, GridPoint goal);
+
+    // Clusters whose abstraction is currently built
+    std::size_t builtClusterCount() const;
+
+private:
+    struct Link { int cluster; int x; int y; }; // entrance cell on the other side
+    struct Node { int x; int y; std::vector<Link> links; };
+    struct Cluster
+    {
+        bool built = false;
+        std::vector<Node> nodes;
+        std::vector<int> dist; // nodes x nodes, UNREACHED where no path inside the cluster
+        // nodes x nodes, entrance to entrance; null until refined, then shared by copies
+        std::vector<std::shared_ptr<const CompactPath>> routes;
+    };
+
+    mutable std::mutex mu;
+    std::vector<Cluster> clusters;
+    int clustersX = 0;
+    int clustersY = 0;
+    std::uint64_t syncedVersion = 0;
+
+    void sync(const Map& map);
+    Cluster& built(const TiledGrid& grid, int index);
+    void build(const TiledGrid& grid, int index);
+    int clusterOf(int x, int y) const { return (y / CLUSTER_SIZE) * clustersX + x / CLUSTER_SIZE; }
+};
+
+#endif
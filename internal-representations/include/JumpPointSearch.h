@@ -0,0 +1,14 @@
+#ifndef H_JUMP_POINT_SEARCH
+#define H_JUMP_POINT_SEARCH
+
+#include "PathPlanner.h"
+
+// Jump Point Search over the same motion model as planPath: 8-connected,
+// 10/14 step costs, a diagonal step only needs its target cell to be free.
+// Straight and diagonal runs with no forced neighbours are skipped in one
+// jump, so only the turning points of a path enter the open list. The result
+// is expanded back into single grid steps and has the same cost as Dijkstra;
+// `expanded` counts jump points.
+PlanResult jumpPointSearch(const Map& map, GridPoint start, GridPoint goal);
+
+#endif
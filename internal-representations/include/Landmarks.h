@@ -0,0 +1,106 @@
+#ifndef H_LANDMARKS
+#define H_LANDMARKS
+
+#include "PathPlanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TiledGrid;
+
+// ALT (A*, landmarks, triangle inequality) data for one version of a map:
+// the exact 8-connected 10/14 distance from each of a few landmark cells to
+// every cell. For any landmark L, |d(L, goal) - d(L, n)| never exceeds the
+// true distance from n to goal, and unlike octile distance the bound sees
+// walls. Distances are stored as 16 bits, interleaved per cell so that one
+// heuristic evaluation touches a single cache line; those past the 16-bit
+// range are clamped to its top, which keeps the bound admissible and
+// consistent (it only stops growing beyond about 6500 straight cells).
+//
+// Where fewer than MIN_LANDMARKS exact fields fit the budget, the table
+// falls back to coarser fields: per square block of cells, the lowest and
+// highest distance over the block. The bound from those is still admissible
+// but no longer consistent, so searches using it must be able to reopen
+// cells (a binary heap, not the bucket queue); see isConsistent().
+class LandmarkTable
+{
+public:
+    static constexpr int DEFAULT_LANDMARKS = 4;
+    static constexpr int MIN_LANDMARKS = 2;   // coarsen the fields before going below this
+    static constexpr int MAX_BLOCK_SIZE = 64; // coarsest block side, in cells
+    static constexpr std::size_t MEMORY_BUDGET = std::size_t(128) << 20; // bytes per map
+    static constexpr std::uint16_t UNKNOWN = 0xFFFF;
+
+    // Place up to count landmarks (fewer if the budget does not allow count
+    // fields even at MAX_BLOCK_SIZE) by farthest-point selection, keeping
+    // those of previous that are still free. Costs one full flood per
+    // landmark.
+    LandmarkTable(const TiledGrid& grid, std::uint64_t version, int count,
+                  const std::vector<GridPoint>& previous = {}, std::size_t budget = MEMORY_BUDGET);
+
+    std::uint64_t getVersion() const { return version; }
+    const std::vector<GridPoint>& getLandmarks() const { return landmarks; }
+    int getBlockSize() const { return blockSize; } // 1 for exact fields
+    bool isConsistent() const { return blockSize == 1; }
+    std::size_t bytesPerLandmark() const { return fieldBytes(width, height, blockSize); }
+    std::size_t memoryBytes() const { return dist.size() * sizeof(std::uint16_t); }
+
+    // Admissible lower bound on the cost from any cell to one goal;
+    // consistent too when the table is
+    class Bound
+    {
+    public:
+        Bound(const LandmarkTable& table, GridPoint goal);
+        int operator()(int x, int y) const;
+
+    private:
+        const LandmarkTable& table;
+        std::vector<int> goalLow;  // per landmark, -1 where unusable
+        std::vector<int> goalHigh;
+    };
+
+private:
+    int width;
+    int height;
+    int blockSize = 1;
+    int blocksX;
+    std::uint64_t version;
+    std::vector<GridPoint> landmarks;
+    // Per block (a cell when blockSize is 1), the low distance to each
+    // landmark, then for coarse fields the high one:
+    // (by * blocksX + bx) * stride() + i, and + landmarks.size() for high
+    std::vector<std::uint16_t> dist;
+
+    static std::size_t fieldBytes(int width, int height, int blockSize);
+    std::size_t stride() const { return blockSize == 1 ? landmarks.size() : 2 * landmarks.size(); }
+    const std::uint16_t* row(int x, int y) const
+    {
+        return &dist[(static_cast<std::size_t>(y / blockSize) * blocksX + x / blockSize) * stride()];
+    }
+};
+
+// Lazily built LandmarkTable of one map, rebuilt on the first query after the
+// map version moves on. The query that finds the table out of date builds the
+// new one without holding the lock and swaps it in; queries arriving
+// meanwhile get null and fall back to octile distance, since bounds from an
+// older version stop being admissible once an obstacle is removed. Queries
+// hold a shared_ptr, so a rebuild never pulls a table from under a search.
+class LandmarkSet
+{
+public:
+    LandmarkSet() = default;
+    LandmarkSet(const LandmarkSet& other);
+    LandmarkSet& operator=(const LandmarkSet& other);
+
+    // Table for version, or null while another thread is building one
+    std::shared_ptr<const LandmarkTable> get(const TiledGrid& grid, std::uint64_t version) const;
+
+private:
+    mutable std::mutex mu;
+    mutable std::shared_ptr<const LandmarkTable> table;
+    mutable bool building = false;
+};
+
+#endif
@@ -1,23 +1,75 @@
 #ifndef H_MAP
 #define H_MAP
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include "Robot.h"
+#include "TiledGrid.h"
+#include "MapFile.h"
+#include "MapPyramid.h"
+#include "MapJournal.h"
+#include "HierarchicalPlanner.h"
+#include "Landmarks.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "ComponentLabels.h"
 
 class Map
 {
 private:
+    // Process-unique id for cache keys. A copy gets a fresh id: it starts at
+    // the same version as its source but the two are edited independently.
+    // A retired id is dropped from the shared PathCache.
+    struct InstanceId
+    {
+        std::uint64_t value;
+        InstanceId();
+        InstanceId(const InstanceId&);
+        InstanceId& operator=(const InstanceId&);
+        ~InstanceId();
+    };
+
+    // Number of non-zero cells, UNKNOWN until first asked for when opened
+    // from a file that does not record it. Counting is idempotent, so
+    // concurrent readers may both count and store the same value.
+    struct ObstacleCount
+    {
+        static constexpr std::int64_t UNKNOWN = -1;
+        mutable std::atomic<std::int64_t> value;
+        explicit ObstacleCount(std::int64_t value = 0) : value(value) {}
+        ObstacleCount(const ObstacleCount& other) : value(other.value.load()) {}
+        ObstacleCount& operator=(const ObstacleCount& other)
+        {
+            value = other.value.load();
+            return *this;
+        }
+    };
+
+    InstanceId instanceId;
     int width;
     int height;
     std::string name;
     std::string mapUrl;
-    std::vector<std::vector<int>> grid; // 0 = accessible, 1 = inaccessible
+    TiledGrid grid; // 0 = accessible, 1 = inaccessible
+    MapPyramid pyramid; // max-pooled coarse levels of grid
+    MapJournal journal; // version and recently changed regions of grid
+    ObstacleCount obstacleCount; // cells of grid that are not accessible
+    mutable HierarchicalPlanner hierarchy; // HPA* clusters, built as queries reach them
+    LandmarkSet landmarks; // ALT distance fields, rebuilt lazily per version
+    mutable DStarLiteSet incremental; // D* Lite searches per robot and goal, repaired from the journal
+    FlowFieldSet flowFields; // per-goal distance/direction fields for the current version
+    mutable ComponentLabels components; // connected free regions, relabelled from the journal
     std::vector<Robot> robots;
 
+    explicit Map(MapFile::Contents contents);
+
 public:
-    // Constructor that takes width and height
-    Map(int width, int height, const std::string &name, const std::string &mapUrl);
+    // Constructor that takes width and height; layout picks the cell order inside each tile
+    Map(int width, int height, const std::string &name, const std::string &mapUrl, GridLayout layout = GridLayout::RowMajor);
+
+    // Open an .agmap file; cell data stays in the shared file mapping until written
+    explicit Map(const std::string &agmapPath, bool verifyChecksum = false);
 
     // Getter methods
     int getWidth() const;
@@ -36,6 +88,55 @@ public:
     // Grid access methods
     int getCell(int x, int y) const;
     void setCell(int x, int y, int value);
+    const TiledGrid& getGrid() const;
+    GridLayout getLayout() const;
+
+    // Replace the whole grid from a srcWidth x srcHeight occupancy raster
+    // (0 = accessible). When the raster and the map differ in size every map
+    // cell touched by a blocked source cell becomes blocked, so obstacles are
+    // never lost to resampling.
+    void importOccupancy(const std::vector<std::uint8_t> &cells, int srcWidth, int srcHeight);
+
+    // Change tracking. The version advances on every grid edit that changes a
+    // cell; changesSince reports the rectangles touched after a given version
+    // (false if they are too old to still be journaled).
+    std::uint64_t getVersion() const;
+    bool changesSince(std::uint64_t version, std::vector<MapChange> &out) const;
+    std::int64_t getObstacleCount() const;
+
+    // Identifies this map object; (instance id, version) pins down its contents
+    std::uint64_t getInstanceId() const;
+
+    // Multi-resolution occupancy. Level 0 is the grid; level n halves the
+    // size of level n-1 and a cell is blocked if any cell below it is.
+    int getLevelCount() const;
+    int getLevelWidth(int level) const;
+    int getLevelHeight(int level) const;
+    int getLevelCell(int level, int x, int y) const;
+    const TiledGrid& getLevelGrid(int level) const;
+
+    // Near-optimal path over the cluster abstraction (see HierarchicalPlanner)
+    PlanResult planHierarchical(GridPoint start, GridPoint goal) const;
+
+    // Minimum-cost path that reuses agent's previous search toward the same
+    // goal, repaired for the cells changed since (see DStarLite)
+    PlanResult planIncremental(GridPoint start, GridPoint goal, const std::string& agent = {}) const;
+    void setIncrementalBudget(std::size_t bytes); // memory for the D* Lite searches kept between queries
+    std::size_t getIncrementalEvictions() const; // searches dropped for memory so far
+
+    // Distance/direction field toward goal for the current version, built on
+    // first use and shared by every robot heading there
+    std::shared_ptr<const FlowField> getFlowField(GridPoint goal) const;
+
+    // ALT landmark fields for the current version, built on first use; null
+    // while another thread is building them
+    std::shared_ptr<const LandmarkTable> getLandmarks() const;
+
+    // Connected component of a free cell (ComponentLabels::NONE if blocked or
+    // out of bounds); labels may change with any edit. isReachable answers in
+    // O(1) whether planPath would find a path, without searching.
+    std::uint32_t getComponent(int x, int y) const;
+    bool isReachable(GridPoint start, GridPoint goal) const;
 
     // Utility methods
     bool isValidPosition(int x, int y) const;
@@ -45,6 +146,9 @@ public:
     void initializeEmpty();
     std::string serialize() const;
     std::string serializeRobots() const;
+
+    // Export the grid, name and mapUrl as an .agmap file
+    void saveAgmap(const std::string &agmapPath) const;
     // static Map deserialize(const std::string& data);
 };
 
@@ -0,0 +1,73 @@
+#ifndef H_MAP_FILE
+#define H_MAP_FILE
+
+#include "TiledGrid.h"
+#include <cstdint>
+#include <string>
+
+class Map;
+
+// Binary .agmap map format, laid out so a file can be mmapped and used in place:
+//
+//   [header]      fixed-size AgmapHeader, followed by the map name and mapUrl
+//   [tile table]  one uint64 per tile (row-major over tiles); entries with the
+//                 top bit set are uniform tiles whose value is in the low byte,
+//                 the others are the file offset of the tile's cell data
+//   [tile data]   TILE_CELLS bytes per non-uniform tile, each page aligned, with
+//                 cells in the grid's layout order so tiles map in unchanged
+//
+// All integers are little-endian. The checksum is FNV-1a over the tile table and
+// tile data; it is written on save but only verified on load when requested, so
+// opening a file costs one mmap plus a walk of the tile table. Version 2 adds the
+// count of blocked cells to the header so it need not be recounted on open;
+// version 1 files (where those words are reserved and zero) still load.
+struct AgmapHeader
+{
+    char magic[8];             // "AGMAP\r\n\x1a"
+    std::uint32_t version;
+    std::uint32_t headerSize;  // bytes before the tile table, including strings
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t tileSize;
+    std::uint32_t cellEncoding;
+    std::uint32_t layout;      // intra-tile cell order, see TiledGrid
+    std::uint32_t nameLength;
+    std::uint32_t mapUrlLength;
+    std::uint32_t obstacleCount[2]; // non-zero cells, low word first (version 2+)
+    std::uint64_t tileCount;
+    std::uint64_t tableOffset;
+    std::uint64_t checksum;
+};
+static_assert(sizeof(AgmapHeader) == 80, "AgmapHeader must have no padding");
+
+class MapFile
+{
+public:
+    static constexpr std::uint32_t VERSION = 2;
+    static constexpr std::uint32_t MIN_VERSION = 1; // oldest version open() accepts
+    static constexpr std::uint32_t CELL_ENCODING_U8 = 1; // one byte per cell, 0 = accessible
+    static constexpr std::uint64_t UNIFORM_TILE_FLAG = 1ull << 63;
+
+    // Contents of an opened file. Non-uniform tiles of the grid reference the
+    // file mapping directly and are copied only when a cell in them is written.
+    struct Contents
+    {
+        TiledGrid grid;
+        std::string name;
+        std::string mapUrl;
+        std::int64_t obstacleCount = -1; // non-zero cells, -1 if the file does not record it
+    };
+
+    // Write map to path atomically (via a temporary file and rename).
+    // Throws std::runtime_error on I/O failure.
+    static void save(const Map& map, const std::string& path);
+
+    // Map path read-only and shared. Throws std::runtime_error if the file is
+    // not a valid .agmap or (with verifyChecksum) its checksum does not match.
+    static Contents open(const std::string& path, bool verifyChecksum = false);
+
+    // Recompute the checksum of an existing file and compare with its header
+    static bool verify(const std::string& path);
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef H_MAP_JOURNAL
+#define H_MAP_JOURNAL
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cells [x0, x1) x [y0, y1) changed by the edit that produced version
+struct MapChange
+{
+    std::uint64_t version;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// Version counter plus a bounded ring of the most recent changed rectangles.
+// Anything derived from a map can remember the version it was built at and
+// later ask which regions changed since then, repairing only those. Edits next
+// to the newest entry are merged into it while the union stays within one
+// map tile, so a stroke of setCell calls takes a single slot.
+class MapJournal
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 256;
+
+    explicit MapJournal(std::size_t capacity = DEFAULT_CAPACITY);
+
+    std::uint64_t getVersion() const { return version; }
+
+    // Record a changed rectangle (exclusive upper bounds); returns the new version
+    std::uint64_t record(int x0, int y0, int x1, int y1);
+
+    // Append every change newer than sinceVersion to out, oldest first. Returns
+    // false if some of those changes have already dropped out of the ring, in
+    // which case the caller has to treat the whole map as changed.
+    bool changesSince(std::uint64_t sinceVersion, std::vector<MapChange>& out) const;
+
+private:
+    std::vector<MapChange> ring;
+    std::size_t head = 0;  // slot of the oldest entry
+    std::size_t count = 0;
+    std::uint64_t version = 0;
+    std::uint64_t oldestKnown = 0; // changes after this version are all in the ring
+};
+
+#endif
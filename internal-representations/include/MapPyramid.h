@@ -0,0 +1,41 @@
+#ifndef H_MAP_PYRAMID
+#define H_MAP_PYRAMID
+
+#include "TiledGrid.h"
+#include <mutex>
+#include <vector>
+
+// Downsampled occupancy levels above a base grid. Level 0 is the base grid
+// itself; each further level halves both dimensions (rounding up) and stores
+// the max of the 2x2 cells below it, so a free coarse cell guarantees that the
+// whole block underneath is free. Levels are built on first use and then kept
+// up to date one cell at a time as the base grid changes.
+class MapPyramid
+{
+public:
+    MapPyramid() = default;
+    MapPyramid(const MapPyramid& other);
+    MapPyramid& operator=(const MapPyramid& other);
+
+    // Number of levels including the base (down to a 1x1 level)
+    static int levelCount(int baseWidth, int baseHeight);
+
+    // Grid of level >= 1, building the pyramid from base if needed
+    const TiledGrid& level(const TiledGrid& base, int level) const;
+
+    // Propagate a change of base cell (x, y) upwards; no-op until built
+    void update(const TiledGrid& base, int x, int y);
+
+    // Forget all levels (after bulk changes); they are rebuilt on next use
+    void invalidate();
+
+private:
+    mutable std::mutex mu;
+    mutable std::vector<TiledGrid> levels; // levels[i] is pyramid level i + 1
+    mutable bool built = false;
+
+    void build(const TiledGrid& base) const;
+    static TiledGrid downsample(const TiledGrid& src);
+};
+
+#endif
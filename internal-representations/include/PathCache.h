@@ -0,0 +1,97 @@
+#ifndef H_PATH_CACHE
+#define H_PATH_CACHE
+
+#include "CompactPath.h"
+#include "PathPlanner.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Bounded LRU cache of planned paths and distances, shared by every planner
+// caller in the process. Entries are keyed by the map's instance id and
+// version, so an edit to a map makes all of its earlier entries unreachable;
+// they are dropped the first time the newer version is seen. Paths are kept
+// as CompactPaths, a byte per straight run. Unreachable results are cached
+// too (cost -1, empty path). All members are safe to call from several threads.
+class PathCache
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+    struct Key
+    {
+        std::uint64_t mapId;
+        std::uint64_t version;
+        GridPoint start;
+        GridPoint goal;
+        int connectivity; // 4 or 8, the motion model the result was planned for
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t entries = 0;
+        std::size_t capacity = 0;
+        std::size_t pathBytes = 0; // held by cached paths
+    };
+
+    explicit PathCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Process-wide cache used by Robot::pathfind and TaskManager
+    static PathCache& instance();
+
+    // Key for a query on the current version of map
+    static Key makeKey(const Map& map, GridPoint start, GridPoint goal, int connectivity);
+
+    // Full path (start..goal inclusive, empty if unreachable) and its cost.
+    // Distance-only entries do not satisfy a path lookup.
+    bool findPath(const Key& key, CompactPath& path, int& cost);
+    bool findDistance(const Key& key, int& cost);
+
+    void storePath(const Key& key, const CompactPath& path, int cost);
+    void storeDistance(const Key& key, int cost);
+
+    // Drop everything cached for a map that no longer exists
+    void forgetMap(std::uint64_t mapId);
+
+    Stats getStats() const;
+    void clear();
+
+private:
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        CompactPath path;
+        int cost;
+        bool hasPath;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    mutable std::mutex mu;
+    std::size_t capacity;
+    EntryList entries; // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    std::unordered_map<std::uint64_t, std::uint64_t> latestVersion; // per live map id
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+    // Caller holds mu. Entry for key moved to the front, or nullptr; drops
+    // older versions of the key's map when a new version shows up
+    Entry* lookup(const Key& key);
+    void insert(Entry entry);
+    void observeVersion(const Key& key);
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef H_PATH_PLANNER
+#define H_PATH_PLANNER
+
+#include "CompactPath.h"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Map;
+
+// Result of a single grid search
+struct PlanResult
+{
+    CompactPath path;                 // start..goal inclusive in single grid steps, empty if unreachable
+    std::vector<GridPoint> waypoints; // AnyAngle and smoothPath only: the turns path runs straight
+                                      // between, start and goal included
+    int cost = -1;                    // in planner cost units (10 per cardinal step), -1 if unreachable
+    std::size_t expanded = 0;         // nodes taken off the open list
+};
+
+// Search strategy for planPath. All but Hierarchical and AnyAngle return a
+// minimum-cost path; they differ in how many nodes they expand to find it.
+enum class PlannerAlgorithm
+{
+    Dijkstra, // uninformed, expands the whole disc around the start
+    AStar,    // octile-distance heuristic, ties broken toward higher g
+    Landmark, // A* with ALT landmark bounds (see Landmarks.h) on top of octile
+    JumpPoint,    // A* over jump points only (see JumpPointSearch.h)
+    Hierarchical, // HPA* over map clusters; near-optimal (see HierarchicalPlanner.h)
+    AnyAngle,     // Lazy Theta*; waypoints only, not grid steps (see AnyAnglePlanner.h)
+    Incremental,  // D* Lite kept per robot and goal, repaired after map edits (see DStarLite.h)
+    FlowField     // read from the goal's shared flow field, built once per map version; A* where no field fits (see FlowField.h)
+};
+
+// "dijkstra" / "astar" / "alt" / "jps" / "hpa" / "theta" / "dstar" / "flow" (case-sensitive); returns false for anything else
+bool parsePlannerAlgorithm(const std::string& name, PlannerAlgorithm& out);
+const char* plannerAlgorithmName(PlannerAlgorithm algorithm);
+
+// Exact 10/14 cost between two cells on an empty grid; a consistent heuristic
+int octileDistance(GridPoint a, GridPoint b);
+
+// 8-connected search over accessible cells with 10/14 step costs; this is
+// the motion model robots execute. No logging or robot state is touched.
+PlanResult planPath(const Map& map, GridPoint start, GridPoint goal,
+                    PlannerAlgorithm algorithm = PlannerAlgorithm::Dijkstra);
+
+#endif
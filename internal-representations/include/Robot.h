@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include "PathPlanner.h"
 
 // Forward declaration for Map class
 class Map;
@@ -27,8 +28,27 @@ struct Robot
     std::vector<float> getPos() const;
     void setPosition(float x, float y);
     void setPosition(const std::vector<float>& newPos);
-	void pathfind(const Map& map, const std::vector<float>& target);
-    void pathfind(const Map& map, const std::vector<float>& target, const std::vector<std::string>& taskModules);
+	void pathfind(const Map& map, const std::vector<float>& target, PlannerAlgorithm algorithm = PlannerAlgorithm::Dijkstra);
+    void pathfind(const Map& map, const std::vector<float>& target, const std::vector<std::string>& taskModules,
+                  PlannerAlgorithm algorithm = PlannerAlgorithm::Dijkstra);
+
+    // pathfind in two halves. planRoute only reads the map and the robot, so
+    // routes for different robots can be planned concurrently; followRoute
+    // then logs and moves exactly as pathfind does.
+    struct Route
+    {
+        enum class Status { NoTarget, OutOfBounds, Obstacle, Unreachable, AtTarget, Planned };
+        Status status = Status::NoTarget;
+        GridPoint start;
+        GridPoint goal;
+        PlanResult plan; // empty path if the target is unreachable
+    };
+    Route planRoute(const Map& map, const std::vector<float>& target,
+                    PlannerAlgorithm algorithm = PlannerAlgorithm::Dijkstra) const;
+    void followRoute(const Map& map, const Route& route);
+
+    // Invoke and clear currentTaskModules (done on arrival)
+    void invokeTaskModules();
     
     // Movement validation and execution
     bool canMoveTo(float x, float y, const Map& map) const;
@@ -0,0 +1,93 @@
+#ifndef H_SEARCH_WORKSPACE
+#define H_SEARCH_WORKSPACE
+
+#include "TiledGrid.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Per-thread search state (best distance and incoming direction for each
+// cell), reused from one query to the next. Storage follows the map's tiling
+// and cell layout and is allocated one tile at a time the first time any
+// search touches it. Every cell carries the generation of the query that last
+// wrote it, so starting a query is O(1) and a query only pays for the cells
+// it reaches, never for width*height. Blocks stay allocated for the next
+// query, up to MAX_RETAINED_TILES per workspace: a workspace that grew past
+// that (a flood over a huge map) is emptied when its next query starts.
+//
+// Parents are stored as the 3-bit code of the move into the cell (an index
+// into DX/DY); a path is read back by stepping against those moves until the
+// start cell is reached.
+class SearchWorkspace
+{
+public:
+    static constexpr int UNREACHED = std::numeric_limits<int>::max();
+
+    // Move codes: 0-3 cardinal (+x, -x, +y, -y), 4-7 diagonal
+    static constexpr int DX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    static constexpr int DY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+    static int directionOf(int dx, int dy);
+
+    using CellRef = TiledGrid::CellRef;
+
+    // One of the calling thread's workspaces, cleared for a new query on
+    // grid. Each slot serves one query at a time; searches that need two
+    // sets of state at once (bidirectional) use both slots.
+    static constexpr int SLOTS = 2;
+    static constexpr std::size_t MAX_RETAINED_TILES = 1024; // 32 MiB of blocks
+    static SearchWorkspace& acquire(const TiledGrid& grid, int slot = 0);
+
+    int getDist(int x, int y) const { return getDist(grid->ref(x, y)); }
+    int getDirection(int x, int y) const { return getDirection(grid->ref(x, y)); }
+    void set(int x, int y, int dist, int direction) { set(grid->ref(x, y), dist, direction); }
+
+    int getDist(CellRef cell) const;
+    int getDirection(CellRef cell) const; // only meaningful for reached cells
+    void set(CellRef cell, int dist, int direction);
+
+    std::size_t allocatedTiles() const { return allocated; }
+
+private:
+    static constexpr int DIRECTION_BITS = 3;
+    static constexpr std::uint32_t MAX_GENERATION = (1u << (32 - DIRECTION_BITS)) - 1;
+
+    struct Block
+    {
+        std::uint32_t tag[TiledGrid::TILE_CELLS]; // generation << 3 | direction
+        int dist[TiledGrid::TILE_CELLS];
+    };
+
+    const TiledGrid* grid = nullptr;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::uint32_t generation = 0;
+    std::size_t allocated = 0;
+
+    SearchWorkspace() = default;
+    void reset(const TiledGrid& target);
+    Block& blockFor(int tile);
+};
+
+inline int SearchWorkspace::getDist(CellRef cell) const
+{
+    const Block* block = blocks[cell.tile].get();
+    if (!block || (block->tag[cell.local] >> DIRECTION_BITS) != generation)
+    {
+        return UNREACHED;
+    }
+    return block->dist[cell.local];
+}
+
+inline int SearchWorkspace::getDirection(CellRef cell) const
+{
+    return static_cast<int>(blocks[cell.tile]->tag[cell.local] & ((1u << DIRECTION_BITS) - 1));
+}
+
+inline void SearchWorkspace::set(CellRef cell, int dist, int direction)
+{
+    Block& block = blockFor(cell.tile);
+    block.tag[cell.local] = (generation << DIRECTION_BITS) | static_cast<std::uint32_t>(direction);
+    block.dist[cell.local] = dist;
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef H_SIMULATION_LOGGER
 #define H_SIMULATION_LOGGER
 
+#include "CompactPath.h"
 #include <string>
 #include <mutex>
 #include <fstream>
@@ -19,7 +20,7 @@ public:
     void logPlannerStart(const std::string& robotId, const std::string& robotName, int startX, int startY, int goalX, int goalY, int mapW, int mapH);
     void logExpandNode(const std::string& robotId, int x, int y, int cost, int parentX, int parentY);
     void logPushNode(const std::string& robotId, int x, int y, int cost);
-    void logPathReconstructed(const std::string& robotId, const std::vector<std::pair<int,int>>& path);
+    void logPathReconstructed(const std::string& robotId, const CompactPath& path);
     void logMoveExecuted(const std::string& robotId, int x, int y);
 
 private:
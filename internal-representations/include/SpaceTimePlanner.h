@@ -0,0 +1,108 @@
+#ifndef H_SPACE_TIME_PLANNER
+#define H_SPACE_TIME_PLANNER
+
+#include "PathPlanner.h"
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class FlowField;
+class Map;
+
+// Cell occupied at each time step from t = 0; a wait repeats the cell
+using TimedPath = std::vector<GridPoint>;
+
+// Hashed space-time reservations for multi-robot planning. A robot occupies
+// one cell per time step and moves (or waits) between steps. Reserved cells
+// and blocked moves are kept per (cell, time); a parked cell stays reserved
+// from some time on, which is how a robot standing at its goal is kept.
+class ReservationTable
+{
+public:
+    void reserveCell(GridPoint cell, int t);
+    // Forbid moving from -> to between t and t + 1
+    void blockMove(GridPoint from, GridPoint to, int t);
+    void park(GridPoint cell, int fromTime);
+
+    // Reserve every cell of path, block the reverse of each of its moves (so
+    // no one can swap places with it) and park it at its last cell
+    void reservePath(const TimedPath& path);
+
+    bool isCellFree(GridPoint cell, int t) const;
+    bool isMoveFree(GridPoint from, GridPoint to, int t) const;
+    // Last time cell is reserved, -1 if never, INT_MAX if parked
+    int lastReserved(GridPoint cell) const;
+
+    void clear();
+
+private:
+    std::unordered_set<std::uint64_t> cells;              // key(cell, t)
+    std::unordered_map<std::uint64_t, std::uint8_t> moves; // key(from, t) -> bit per direction
+    std::unordered_map<std::uint64_t, int> parkedFrom;     // key(cell, 0) -> time
+    std::unordered_map<std::uint64_t, int> latest;         // key(cell, 0) -> last reserved time
+
+    static std::uint64_t key(GridPoint cell, int t)
+    {
+        return (static_cast<std::uint64_t>(t) << 42) | (static_cast<std::uint64_t>(cell.second) << 21) |
+               static_cast<std::uint64_t>(cell.first);
+    }
+};
+
+struct SpaceTimeOptions
+{
+    int maxTime = -1;           // steps; < 0 picks one from the distance to the goal
+    double suboptimality = 1.0; // bound on the path cost, relative to the best with avoid ignored
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const FlowField* distances = nullptr; // static distances to the goal, if already at hand
+};
+
+struct SpaceTimeStats
+{
+    std::size_t expanded = 0;
+    int lowerBound = 0; // no path within table costs less than this
+};
+
+// Space-time A* for one robot: 8-connected moves at the robot costs (10/14)
+// plus waits (10), against the reservations in table. The heuristic is the
+// exact static distance to the goal, from options.distances or else from a
+// reverse search that is resumed only as far as the queried cells need. The
+// goal is accepted once the robot can stay there for good. Returns an empty
+// path if that is not possible within maxTime steps (maxTime < 0 picks twice
+// the static distance, or the last reservation of the goal if later, plus
+// some slack), within a fixed expansion budget or before the deadline. The
+// start may be blocked, as in planPath.
+//
+// avoid holds soft reservations (other robots' current plans). With
+// suboptimality 1 the cheapest path is returned, and among those the one that
+// runs into the fewest soft reservations. Above 1 this is a focal search (the
+// low level of ECBS): of the states within suboptimality times the cheapest
+// open one, the one with the fewest soft conflicts so far is expanded next,
+// so the path costs at most suboptimality times the optimum and usually
+// dodges far more of the other plans.
+TimedPath planSpaceTime(const Map& map, GridPoint start, GridPoint goal, const ReservationTable& table,
+                        const ReservationTable* avoid = nullptr, const SpaceTimeOptions& options = {},
+                        SpaceTimeStats* stats = nullptr);
+
+struct AgentQuery
+{
+    GridPoint start;
+    GridPoint goal;
+};
+
+// Cooperative A*: plan agents one after another in the given (priority)
+// order, each against the reservations of those before it. All start cells
+// are reserved at t = 0 first. An agent that finds no plan stays where it is
+// (its path is just its start, parked) and later agents plan around it; the
+// earlier agents are not replanned, so such a path can still conflict.
+// Cells in stationary are occupied for the whole plan (robots not taking
+// part). Agents not yet planned when the deadline passes stay put as well.
+std::vector<TimedPath> planCooperative(const Map& map, const std::vector<AgentQuery>& agents,
+                                       const std::vector<GridPoint>& stationary = {},
+                                       std::chrono::steady_clock::time_point deadline =
+                                           std::chrono::steady_clock::time_point::max());
+
+#endif
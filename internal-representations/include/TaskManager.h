@@ -3,21 +3,30 @@
 
 #include "Task.h"
 #include "Map.h"
+#include "PathPlanner.h"
 #include <unordered_map>
 #include <vector>
 #include <optional>
 #include <functional>
+#include <limits>
 #include <map>
 #include <string>
 
-// Forward declaration
-using GridPoint = std::pair<int, int>;
+struct PathfindRequest;
 
 class TaskManager
 {
 public:
     explicit TaskManager(Map& map);
 
+    // How the robots of one optimal/balanced round are routed: each on its
+    // own shortest path, or jointly so they do not collide, either by
+    // cooperative space-time A* (higher-priority tasks plan first) or by
+    // Conflict-Based Search (falls back to the former when out of time)
+    enum class DispatchMode { Independent, Cooperative, ConflictBased };
+    void setDispatchMode(DispatchMode mode) { dispatchMode = mode; }
+    DispatchMode getDispatchMode() const { return dispatchMode; }
+
     // === Task Input Methods (Flexible Interface) ===
     
     // Simple: just coordinates - auto-generates ID and default priority
@@ -54,6 +63,10 @@ public:
     // === Query Methods ===
     
     std::vector<Task> getPendingTasks() const;
+
+    // Whether some robot on the map can drive to the position (an O(1)
+    // component lookup per robot, no search)
+    bool isReachableByAnyRobot(const std::vector<float>& position) const;
     std::optional<Task> getTaskById(const std::string& taskId) const;
     void markTaskComplete(const std::string& taskId);
 
@@ -71,15 +84,34 @@ private:
     std::vector<Task> pendingTasks;
     std::unordered_map<std::string, std::string> taskAssignments; // taskId -> robotId
     int nextTaskIdCounter = 0; // For auto-generating task IDs
+    DispatchMode dispatchMode = DispatchMode::Independent;
+
+    // Route and move one assignment round; ranks[i] orders moves[i] by
+    // task priority (lower first)
+    void dispatchRound(std::vector<PathfindRequest>& moves, const std::vector<std::size_t>& ranks);
 
     // === Distance Calculation ===
     
     static float calculateDistance(const std::vector<float>& a, const std::vector<float>& b);
     static bool hasValidPosition(const std::vector<float>& position);
     
-    // Pathfinding-aware distance calculation
-    int computePathDistance(GridPoint start, GridPoint goal) const;
-    std::vector<GridPoint> computePath(GridPoint start, GridPoint goal) const;
+    // Distance reported for a pair with no path. No path cost reaches it, and
+    // such pairs never get a cost of their own in the assignment queue.
+    static constexpr int UNREACHABLE = std::numeric_limits<int>::max();
+
+    // Pathfinding-aware distance calculation, with the robots' own motion
+    // model: the 10/14 cost of the path a robot would drive, UNREACHABLE if
+    // there is none. With maxCost >= 0 the search gives up past that cost and
+    // returns -1, so an unreachable or distant goal costs no more than the
+    // bound.
+    int computePathDistance(GridPoint start, GridPoint goal, int maxCost = -1) const;
+    CompactPath computePath(GridPoint start, GridPoint goal) const;
+
+    // result[i][j] == computePathDistance(from[i], to[j], maxCost), from
+    // one distance field per point on the shorter side
+    std::vector<std::vector<int>> computeDistanceMatrix(const std::vector<GridPoint>& from,
+                                                        const std::vector<GridPoint>& to,
+                                                        int maxCost = -1) const;
     
     // Helper to convert float position to grid point
     static GridPoint toGridPoint(const std::vector<float>& position);
@@ -92,18 +124,25 @@ private:
 
     // === Assignment Algorithms ===
     
-    // Hungarian algorithm implementation
+    // Hungarian algorithm implementation. robotPositions[j] is where robots[j]
+    // starts from; costFunction gets the path distance from there to the task
+    // and must not fall as the distance grows. Distances are searched up to a
+    // cap and only refined for pairs the assignment would otherwise pick.
+    // Pairs with no path are ranked after every reachable pair, among
+    // themselves by the cost of a zero distance (the priority alone).
     std::map<std::string, std::string> hungarianAssignment(
         const std::vector<Task>& tasks,
         const std::vector<std::reference_wrapper<Robot>>& robots,
-        std::function<float(const Robot&, const Task&)> costFunction
+        const std::vector<GridPoint>& robotPositions,
+        std::function<double(const Robot&, const Task&, int)> costFunction
     ) const;
     
-    // Cost function for pathfinding distance
-    float pathfindingCost(const Robot& robot, const Task& task) const;
+    // Cost function for pathfinding distance. Costs are doubles so that
+    // integer distances and priority penalties add exactly on any map.
+    static double pathfindingCost(const Robot& robot, const Task& task, int distance);
 
     // Cost function considering robot speed (for makespan)
-    float makespanCost(const Robot& robot, const Task& task) const;
+    static double makespanCost(const Robot& robot, const Task& task, int distance);
 };
 
 #endif
@@ -0,0 +1,173 @@
+#ifndef H_TILED_GRID
+#define H_TILED_GRID
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Order of cells inside a tile. RowMajor keeps vertical neighbours a full tile
+// row (64 bytes) apart; Morton interleaves x and y bits so the 8-neighbourhood
+// of a cell is usually within a few cache lines.
+enum class GridLayout
+{
+    RowMajor = 0,
+    Morton = 1
+};
+
+// Occupancy grid stored as fixed-size square tiles. A tile whose cells all hold
+// the same value is kept as that single value and only gets a cell buffer on the
+// first write that breaks uniformity. Cell buffers are shared between copies of
+// the grid and cloned on write, so copying a grid never duplicates cell data.
+// Tiles can also be attached to read-only external memory (e.g. an mmapped
+// .agmap file); those are cloned into private storage on their first write.
+class TiledGrid
+{
+public:
+    static constexpr int TILE_SHIFT = 6;
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT; // 64x64 cells per tile
+    static constexpr int TILE_MASK = TILE_SIZE - 1;
+    static constexpr int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    TiledGrid(int width, int height, std::uint8_t fillValue = 0, GridLayout layout = GridLayout::RowMajor);
+
+    // Location of a cell in tiled storage
+    struct CellRef
+    {
+        int tile;
+        int local;
+    };
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getTilesX() const { return tilesX; }
+    int getTilesY() const { return tilesY; }
+    GridLayout getLayout() const { return layout; }
+    std::size_t getTileCount() const { return tiles.size(); }
+
+    // Unchecked cell access; callers are responsible for bounds checks
+    std::uint8_t get(int x, int y) const;
+    std::uint8_t get(CellRef cell) const;
+    void set(int x, int y, std::uint8_t value);
+
+    // Reset every tile to a single uniform value, releasing all cell buffers
+    void fill(std::uint8_t value);
+
+    // Tile addressing
+    int tileIndex(int x, int y) const { return (y >> TILE_SHIFT) * tilesX + (x >> TILE_SHIFT); }
+    int localIndex(int x, int y) const;
+    CellRef ref(int x, int y) const { return {tileIndex(x, y), localIndex(x, y)}; }
+
+    // Reference of cell (x+dx, y+dy), |dx|,|dy| <= 1, given the reference of
+    // (x, y). Inside a tile this is the layout's own index arithmetic; only
+    // moves across a tile border recompute the reference from coordinates.
+    CellRef neighbour(CellRef cell, int x, int y, int dx, int dy) const;
+
+    bool isTileUniform(int tile) const;
+    std::uint8_t getTileValue(int tile) const; // value of a uniform tile
+    const std::uint8_t* getTileCells(int tile) const; // null for uniform tiles
+
+    // Back a tile with TILE_CELLS bytes of externally owned, read-only memory.
+    // The shared pointer keeps the owner (e.g. a file mapping) alive.
+    void attachTile(int tile, std::shared_ptr<const std::uint8_t> cells);
+    void setTileValue(int tile, std::uint8_t value);
+
+    // Collapse materialized tiles whose cells are all equal back to a single value.
+    // Returns the number of tiles released.
+    std::size_t compact();
+
+    // Number of in-bounds cells holding a non-zero value; uniform tiles are
+    // counted without touching their cells
+    std::int64_t countNonZero() const;
+
+    // Memory accounting
+    std::size_t materializedTileCount() const;
+    std::size_t memoryUsage() const;
+
+private:
+    struct Tile
+    {
+        std::shared_ptr<std::uint8_t> cells; // null while the tile is uniform
+        std::uint8_t value = 0;              // uniform value when cells is null
+        bool readOnly = false;               // cells point at external memory
+    };
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    GridLayout layout;
+    std::vector<Tile> tiles;
+
+    static int mortonEncode(int lx, int ly);
+    static int mortonStep(int code, int dx, int dy);
+
+    std::uint8_t* writableCells(Tile& tile);
+};
+
+inline int TiledGrid::mortonEncode(int lx, int ly)
+{
+    // Spread the 6 bits of each coordinate to even (x) and odd (y) positions
+    auto spread = [](unsigned v)
+    {
+        v = (v | (v << 4)) & 0x0F0Fu;
+        v = (v | (v << 2)) & 0x3333u;
+        v = (v | (v << 1)) & 0x5555u;
+        return v;
+    };
+    return static_cast<int>(spread(static_cast<unsigned>(lx)) | (spread(static_cast<unsigned>(ly)) << 1));
+}
+
+inline int TiledGrid::mortonStep(int code, int dx, int dy)
+{
+    // Add or subtract one in the x (even) or y (odd) bit lane; filling the other
+    // lane with ones (or masking it out) lets carries and borrows skip over it
+    const int X_BITS = 0x555;
+    const int Y_BITS = 0xAAA;
+    if (dx > 0) code = (((code | Y_BITS) + 1) & X_BITS) | (code & Y_BITS);
+    else if (dx < 0) code = (((code & X_BITS) - 1) & X_BITS) | (code & Y_BITS);
+    if (dy > 0) code = (((code | X_BITS) + 2) & Y_BITS) | (code & X_BITS);
+    else if (dy < 0) code = (((code & Y_BITS) - 2) & Y_BITS) | (code & X_BITS);
+    return code;
+}
+
+inline int TiledGrid::localIndex(int x, int y) const
+{
+    if (layout == GridLayout::Morton)
+    {
+        return mortonEncode(x & TILE_MASK, y & TILE_MASK);
+    }
+    return ((y & TILE_MASK) << TILE_SHIFT) | (x & TILE_MASK);
+}
+
+inline TiledGrid::CellRef TiledGrid::neighbour(CellRef cell, int x, int y, int dx, int dy) const
+{
+    const unsigned lx = static_cast<unsigned>((x & TILE_MASK) + dx);
+    const unsigned ly = static_cast<unsigned>((y & TILE_MASK) + dy);
+    if (lx >= static_cast<unsigned>(TILE_SIZE) || ly >= static_cast<unsigned>(TILE_SIZE))
+    {
+        return ref(x + dx, y + dy);
+    }
+    if (layout == GridLayout::Morton)
+    {
+        return {cell.tile, mortonStep(cell.local, dx, dy)};
+    }
+    return {cell.tile, cell.local + dy * TILE_SIZE + dx};
+}
+
+inline std::uint8_t TiledGrid::get(CellRef cell) const
+{
+    const Tile& tile = tiles[cell.tile];
+    if (!tile.cells)
+    {
+        return tile.value;
+    }
+    return tile.cells.get()[cell.local];
+}
+
+inline std::uint8_t TiledGrid::get(int x, int y) const
+{
+    return get(ref(x, y));
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef H_WORK_STEALING_POOL
+#define H_WORK_STEALING_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for parallel loops. parallelFor deals the
+// indices out round-robin to one deque per participant (the workers plus the
+// calling thread); each participant takes work from the back of its own deque
+// and, once that is empty, steals from the front of the others, so uneven job
+// lengths even out. Calls from inside a job run inline.
+class WorkStealingPool
+{
+public:
+    // threads counts the calling thread, so threads - 1 workers are started
+    explicit WorkStealingPool(unsigned threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Shared pool with one participant per hardware thread
+    static WorkStealingPool& instance();
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Run job(i) for every i in [0, count) and wait for all of them. The first
+    // exception thrown by a job is rethrown here once the others finished.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job);
+
+private:
+    struct Queue
+    {
+        std::mutex mu;
+        std::deque<std::size_t> items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] belongs to the caller
+    std::vector<std::thread> workers;
+
+    std::mutex batchMu; // one parallelFor at a time
+    std::mutex mu;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::uint64_t generation = 0;
+    unsigned active = 0; // workers inside the current batch
+    bool stopping = false;
+    std::atomic<std::size_t> remaining{0};
+    std::exception_ptr error;
+
+    void workerLoop(unsigned participant);
+    void work(unsigned participant, const std::function<void(std::size_t)>& fn);
+    bool take(unsigned participant, std::size_t& index);
+};
+
+#endif
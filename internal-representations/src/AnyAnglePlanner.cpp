@@ -0,0 +1,216 @@
+#include "AnyAnglePlanner.h"
+#include "Map.h"
+#include "GridSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    constexpr int OPEN = 0;
+    constexpr int CLOSED = 1;
+
+    // Supercover walk between the centres of a and b: each step moves to the
+    // next cell the segment enters, diagonally when it passes exactly through
+    // a corner, so consecutive cells are grid neighbours. It stays inside the
+    // bounding box of a and b. visit(x, y) is called for every cell after a
+    // and stops the walk (returning false) when it returns false.
+    template <typename Visit>
+    bool walkSegment(GridPoint a, GridPoint b, Visit visit)
+    {
+        int dx = std::abs(b.first - a.first);
+        int dy = std::abs(b.second - a.second);
+        const int sx = b.first > a.first ? 1 : -1;
+        const int sy = b.second > a.second ? 1 : -1;
+        int x = a.first;
+        int y = a.second;
+        int error = dx - dy;
+        dx *= 2;
+        dy *= 2;
+        while (x != b.first || y != b.second)
+        {
+            if (error > 0)
+            {
+                x += sx;
+                error -= dy;
+            }
+            else if (error < 0)
+            {
+                y += sy;
+                error += dx;
+            }
+            else
+            {
+                x += sx;
+                y += sy;
+                error += dx - dy;
+            }
+            if (!visit(x, y)) return false;
+        }
+        return true;
+    }
+
+    // Waypoints to a PlanResult: the grid steps a robot drives along their
+    // segments (the cells hasLineOfSight checked) and the segmentCost sum
+    void setWaypoints(PlanResult& result, std::vector<GridPoint> waypoints)
+    {
+        result.path = CompactPath(waypoints.front());
+        result.cost = 0;
+        for (std::size_t i = 1; i < waypoints.size(); ++i)
+        {
+            walkSegment(waypoints[i - 1], waypoints[i], [&](int x, int y) {
+                result.path.push_back({x, y});
+                return true;
+            });
+            result.cost += segmentCost(waypoints[i - 1], waypoints[i]);
+        }
+        result.waypoints = std::move(waypoints);
+    }
+
+    // Lower bound on segmentCost, so the heuristic never overestimates
+    int straightLineBound(GridPoint a, GridPoint b)
+    {
+        double dx = a.first - b.first;
+        double dy = a.second - b.second;
+        return static_cast<int>(10.0 * std::sqrt(dx * dx + dy * dy));
+    }
+}
+
+bool hasLineOfSight(const Map& map, GridPoint a, GridPoint b)
+{
+    if (!map.isValidPosition(a.first, a.second) || !map.isValidPosition(b.first, b.second)) return false;
+    const TiledGrid& grid = map.getGrid();
+    return walkSegment(a, b, [&](int x, int y) { return grid.get(x, y) == 0; });
+}
+
+int segmentCost(GridPoint a, GridPoint b)
+{
+    double dx = a.first - b.first;
+    double dy = a.second - b.second;
+    return static_cast<int>(std::lround(10.0 * std::sqrt(dx * dx + dy * dy)));
+}
+
+PlanResult lazyThetaStar(const Map& map, GridPoint start, GridPoint goal)
+{
+    PlanResult result;
+    const TiledGrid& grid = map.getGrid();
+
+    // Same start/goal rules as planPath
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return result;
+    }
+
+    // g per cell in the workspace, with OPEN/CLOSED as the direction field.
+    // Parents can be any earlier cell, so they go in a second workspace as
+    // y * width + x in place of a distance.
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+    SearchWorkspace& parents = SearchWorkspace::acquire(grid, 1);
+    const int width = grid.getWidth();
+    const int height = grid.getHeight();
+    auto parentOf = [&](int x, int y) {
+        int index = parents.getDist(x, y);
+        return GridPoint{index % width, index / width};
+    };
+    auto setParent = [&](int x, int y, GridPoint p) { parents.set(x, y, p.second * width + p.first, 0); };
+    // Segment costs are unbounded, so the open list has to be a heap
+    BinaryHeapQueue pq;
+
+    ws.set(start.first, start.second, 0, OPEN);
+    setParent(start.first, start.second, start);
+    pq.push({straightLineBound(start, goal), 0, start.first, start.second});
+
+    bool found = false;
+    while (!pq.empty())
+    {
+        SearchNode cur = pq.pop();
+        TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+        if (cur.cost != ws.getDist(curRef) || ws.getDirection(curRef) == CLOSED) continue; // stale
+        ++result.expanded;
+
+        // The parent was assumed visible when this cell was generated; if it
+        // is not, fall back to the best closed neighbour (there always is
+        // one: the cell this one was generated from)
+        GridPoint curParent = parentOf(cur.x, cur.y);
+        int g = cur.cost;
+        if (curParent != GridPoint{cur.x, cur.y} && !hasLineOfSight(map, curParent, {cur.x, cur.y}))
+        {
+            g = SearchWorkspace::UNREACHED;
+            for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+            {
+                int nx = cur.x + SearchWorkspace::DX[dir];
+                int ny = cur.y + SearchWorkspace::DY[dir];
+                if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+                TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, SearchWorkspace::DX[dir], SearchWorkspace::DY[dir]);
+                int nDist = ws.getDist(nRef);
+                if (nDist == SearchWorkspace::UNREACHED || ws.getDirection(nRef) != CLOSED) continue;
+                if (nDist + RobotCost::step(dir) < g)
+                {
+                    g = nDist + RobotCost::step(dir);
+                    curParent = {nx, ny};
+                }
+            }
+        }
+        ws.set(curRef, g, CLOSED);
+        setParent(cur.x, cur.y, curParent);
+
+        if (cur.x == goal.first && cur.y == goal.second)
+        {
+            found = true;
+            break;
+        }
+
+        const GridPoint from = curParent;
+        const int fromCost = ws.getDist(from.first, from.second);
+        for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+        {
+            int nx = cur.x + SearchWorkspace::DX[dir];
+            int ny = cur.y + SearchWorkspace::DY[dir];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, SearchWorkspace::DX[dir], SearchWorkspace::DY[dir]);
+            if (grid.get(nRef) != 0) continue;
+            int nDist = ws.getDist(nRef);
+            if (nDist != SearchWorkspace::UNREACHED && ws.getDirection(nRef) == CLOSED) continue;
+
+            int nCost = fromCost + segmentCost(from, {nx, ny});
+            if (nCost < nDist)
+            {
+                ws.set(nRef, nCost, OPEN);
+                setParent(nx, ny, from);
+                pq.push({nCost + straightLineBound({nx, ny}, goal), nCost, nx, ny});
+            }
+        }
+    }
+    if (!found) return result; // unreachable
+
+    std::vector<GridPoint> waypoints;
+    for (GridPoint at = goal;; at = parentOf(at.first, at.second))
+    {
+        waypoints.push_back(at);
+        if (at == start) break;
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+    setWaypoints(result, std::move(waypoints));
+    return result;
+}
+
+PlanResult smoothPath(const Map& map, const PlanResult& plan)
+{
+    PlanResult result;
+    result.expanded = plan.expanded;
+    if (plan.path.empty()) return result;
+    const std::vector<GridPoint> path = plan.path.toVector();
+
+    std::vector<GridPoint> waypoints{path.front()};
+    std::size_t anchor = 0;
+    for (std::size_t i = 1; i + 1 < path.size(); ++i)
+    {
+        if (!hasLineOfSight(map, path[anchor], path[i + 1]))
+        {
+            waypoints.push_back(path[i]);
+            anchor = i;
+        }
+    }
+    if (path.size() > 1) waypoints.push_back(path.back());
+    setWaypoints(result, std::move(waypoints));
+    return result;
+}
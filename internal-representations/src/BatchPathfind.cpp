@@ -0,0 +1,123 @@
+#include "BatchPathfind.h"
+#include "ConflictBasedSearch.h"
+#include "FlowField.h"
+#include "Map.h"
+#include "WorkStealingPool.h"
+#include <cmath>
+#include <map>
+#include <unordered_set>
+
+namespace {
+    // A field floods the goal's whole component, which a handful of searches
+    // that stop at their goals rarely cost as much as
+    constexpr int FLOW_FIELD_GROUP = 8;
+}
+
+void pathfindBatch(const Map& map, const std::vector<PathfindRequest>& requests, PlannerAlgorithm algorithm)
+{
+    // Groups of robots converging on one cell (a recall to the depot) share
+    // its flow field instead of searching each, when a field fits the map's
+    // field cache; only exact planners are swapped, so every route keeps its
+    // cost
+    std::map<GridPoint, int> goalCount;
+    auto goalOf = [](const std::vector<float>& target) {
+        return GridPoint{static_cast<int>(std::round(target[0])), static_cast<int>(std::round(target[1]))};
+    };
+    for (const auto& request : requests)
+    {
+        if (request.target.size() >= 2) ++goalCount[goalOf(request.target)];
+    }
+    const bool useFields = algorithm != PlannerAlgorithm::Hierarchical && algorithm != PlannerAlgorithm::AnyAngle &&
+                           FlowFieldSet::fits(map.getWidth(), map.getHeight());
+
+    // Planning only reads the map and the robots; each pool thread searches
+    // in its own thread-local workspace
+    std::vector<Robot::Route> routes(requests.size());
+    WorkStealingPool::instance().parallelFor(requests.size(), [&](std::size_t i) {
+        const std::vector<float>& target = requests[i].target;
+        const bool shared = useFields && target.size() >= 2 && goalCount.at(goalOf(target)) >= FLOW_FIELD_GROUP;
+        routes[i] = requests[i].robot->planRoute(map, target, shared ? PlannerAlgorithm::FlowField : algorithm);
+    });
+
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        Robot& robot = *requests[i].robot;
+        robot.currentTaskModules = requests[i].taskModules;
+        robot.followRoute(map, routes[i]);
+        robot.invokeTaskModules();
+    }
+}
+
+void pathfindCooperative(const Map& map, const std::vector<PathfindRequest>& requests, JointPlanner planner)
+{
+    std::vector<Robot::Route> routes(requests.size());
+    std::vector<AgentQuery> agents;
+    std::vector<std::size_t> agentRequest;
+    std::unordered_set<const Robot*> moving;
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        // Only the status and endpoints are needed here, so skip the search
+        const Robot& robot = *requests[i].robot;
+        Robot::Route& route = routes[i];
+        if (requests[i].target.size() < 2) continue;
+        route.start = robot.getGridPosition();
+        route.goal = {static_cast<int>(std::round(requests[i].target[0])),
+                      static_cast<int>(std::round(requests[i].target[1]))};
+        if (!map.isValidPosition(route.goal.first, route.goal.second))
+            route.status = Robot::Route::Status::OutOfBounds;
+        else if (!map.isAccessible(route.goal.first, route.goal.second))
+            route.status = Robot::Route::Status::Obstacle;
+        else if (route.start == route.goal)
+            route.status = Robot::Route::Status::AtTarget;
+        else if (!map.isReachable(route.start, route.goal))
+            route.status = Robot::Route::Status::Unreachable;
+        else
+        {
+            route.status = Robot::Route::Status::Planned;
+            agents.push_back({route.start, route.goal});
+            agentRequest.push_back(i);
+            moving.insert(&robot);
+        }
+    }
+
+    std::vector<GridPoint> stationary;
+    for (const Robot& robot : map.getRobots())
+    {
+        if (!moving.count(&robot) && robot.position.size() >= 2) stationary.push_back(robot.getGridPosition());
+    }
+
+    // ECBS-style 1.2 bound: a little extra path cost buys many more solved
+    // rounds in dense rows than optimal CBS does within the same time budget
+    std::vector<TimedPath> paths =
+        planner == JointPlanner::ConflictBased
+            ? planConflictBased(map, agents, stationary, std::chrono::milliseconds(200), 1.2).paths
+            : planCooperative(map, agents, stationary);
+    for (std::size_t a = 0; a < agents.size(); ++a)
+    {
+        Robot::Route& route = routes[agentRequest[a]];
+        if (paths[a].size() < 2)
+        {
+            // Reachable alone, but no plan around the other robots
+            route.status = Robot::Route::Status::Unreachable;
+            continue;
+        }
+        PlanResult& plan = route.plan;
+        const TimedPath& timed = paths[a];
+        plan.path = CompactPath(timed);
+        plan.cost = 0;
+        for (std::size_t t = 1; t < timed.size(); ++t)
+        {
+            int dx = timed[t].first - timed[t - 1].first;
+            int dy = timed[t].second - timed[t - 1].second;
+            plan.cost += (dx != 0 && dy != 0) ? 14 : 10; // a wait costs a step too
+        }
+    }
+
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        Robot& robot = *requests[i].robot;
+        robot.currentTaskModules = requests[i].taskModules;
+        robot.followRoute(map, routes[i]);
+        robot.invokeTaskModules();
+    }
+}
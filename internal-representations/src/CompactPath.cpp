@@ -0,0 +1,237 @@
+#include "CompactPath.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // SearchWorkspace's move codes, then WAIT
+    constexpr int STEP_DX[9] = {1, -1, 0, 0, 1, 1, -1, -1, 0};
+    constexpr int STEP_DY[9] = {0, 0, 1, -1, 1, -1, 1, -1, 0};
+
+    // Step code of (dx, dy), -1 if it is neither a step to a neighbour nor a wait
+    int stepCode(int dx, int dy)
+    {
+        for (int code = 0; code <= CompactPath::WAIT; ++code)
+        {
+            if (STEP_DX[code] == dx && STEP_DY[code] == dy) return code;
+        }
+        return -1;
+    }
+
+    template <typename T>
+    void putBytes(std::string& out, T value)
+    {
+        // Byte by byte, lowest first, whatever the host order
+        for (std::size_t b = 0; b < sizeof(T); ++b)
+        {
+            out.push_back(static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * b)) & 0xFF));
+        }
+    }
+
+    template <typename T>
+    T getBytes(const std::string& in, std::size_t& pos)
+    {
+        if (in.size() - pos < sizeof(T)) throw std::invalid_argument("Compact path data is truncated");
+        std::uint64_t value = 0;
+        for (std::size_t b = 0; b < sizeof(T); ++b)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[pos++])) << (8 * b);
+        }
+        return static_cast<T>(value);
+    }
+}
+
+CompactPath::CompactPath(GridPoint start)
+    : start(start), last(start), count(1)
+{
+}
+
+CompactPath::CompactPath(const std::vector<GridPoint>& cells)
+{
+    for (const GridPoint& cell : cells)
+    {
+        push_back(cell);
+    }
+    runs.shrink_to_fit();
+    checkpoints.shrink_to_fit();
+}
+
+bool CompactPath::isUnitStepPath(const std::vector<GridPoint>& cells)
+{
+    for (std::size_t i = 1; i < cells.size(); ++i)
+    {
+        if (stepCode(cells[i].first - cells[i - 1].first, cells[i].second - cells[i - 1].second) < 0) return false;
+    }
+    return true;
+}
+
+GridPoint CompactPath::operator[](std::size_t i) const
+{
+    if (i >= count) throw std::out_of_range("Compact path index out of range");
+    return seek(i).cell;
+}
+
+CompactPath::const_iterator CompactPath::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+CompactPath::const_iterator CompactPath::end() const
+{
+    return const_iterator(this, count);
+}
+
+void CompactPath::push_back(GridPoint cell)
+{
+    if (count == 0)
+    {
+        start = last = cell;
+        count = 1;
+        return;
+    }
+    const int code = stepCode(cell.first - last.first, cell.second - last.second);
+    if (code < 0) throw std::invalid_argument("Compact path steps must be to a neighbouring cell or a wait");
+    pushRun(code, 1);
+}
+
+void CompactPath::append(const CompactPath& other)
+{
+    if (other.count == 0) return;
+    if (count == 0)
+    {
+        *this = other;
+        return;
+    }
+    if (other.start != last) push_back(other.start);
+    for (std::uint8_t run : other.runs)
+    {
+        pushRun(runCode(run), runLength(run));
+    }
+}
+
+std::vector<GridPoint> CompactPath::toVector() const
+{
+    return std::vector<GridPoint>(begin(), end());
+}
+
+std::string CompactPath::serialize() const
+{
+    std::string out;
+    out.reserve(24 + runs.size());
+    putBytes<std::int32_t>(out, start.first);
+    putBytes<std::int32_t>(out, start.second);
+    putBytes<std::uint64_t>(out, count);
+    putBytes<std::uint64_t>(out, runs.size());
+    out.append(reinterpret_cast<const char*>(runs.data()), runs.size());
+    return out;
+}
+
+CompactPath CompactPath::deserialize(const std::string& bytes)
+{
+    std::size_t pos = 0;
+    const std::int32_t x = getBytes<std::int32_t>(bytes, pos);
+    const std::int32_t y = getBytes<std::int32_t>(bytes, pos);
+    const std::uint64_t cells = getBytes<std::uint64_t>(bytes, pos);
+    const std::uint64_t runCount = getBytes<std::uint64_t>(bytes, pos);
+    if (bytes.size() - pos != runCount) throw std::invalid_argument("Compact path data has the wrong length");
+
+    CompactPath path;
+    if (cells == 0)
+    {
+        if (runCount != 0) throw std::invalid_argument("Empty compact path with steps");
+        return path;
+    }
+    path = CompactPath(GridPoint{x, y});
+    path.runs.reserve(runCount);
+    for (; pos < bytes.size(); ++pos)
+    {
+        const std::uint8_t run = static_cast<std::uint8_t>(bytes[pos]);
+        if (runCode(run) > WAIT) throw std::invalid_argument("Compact path data holds an unknown step code");
+        path.pushRun(runCode(run), runLength(run));
+    }
+    if (path.count != cells) throw std::invalid_argument("Compact path step count does not match its runs");
+    return path;
+}
+
+std::size_t CompactPath::memoryBytes() const
+{
+    return sizeof(CompactPath) + runs.capacity() + checkpoints.capacity() * sizeof(Checkpoint);
+}
+
+bool CompactPath::operator==(const CompactPath& other) const
+{
+    // Runs are always filled before a new one starts, so equal paths have equal runs
+    return count == other.count && (count == 0 || (start == other.start && runs == other.runs));
+}
+
+void CompactPath::pushRun(int code, int length)
+{
+    while (length > 0)
+    {
+        int add;
+        if (!runs.empty() && runCode(runs.back()) == code && runLength(runs.back()) < MAX_RUN)
+        {
+            add = std::min(length, MAX_RUN - runLength(runs.back()));
+            runs.back() = static_cast<std::uint8_t>(runs.back() + add);
+        }
+        else
+        {
+            if (runs.size() % CHECKPOINT_RUNS == 0) checkpoints.push_back({count - 1, last});
+            add = std::min(length, MAX_RUN);
+            runs.push_back(static_cast<std::uint8_t>(code << 4 | (add - 1)));
+        }
+        last.first += STEP_DX[code] * add;
+        last.second += STEP_DY[code] * add;
+        count += add;
+        length -= add;
+    }
+}
+
+CompactPath::Position CompactPath::seek(std::size_t i) const
+{
+    if (i + 1 >= count) return {runs.size(), 0, last};
+
+    // Last checkpoint at or before cell i, then run by run from there
+    auto cp = std::upper_bound(checkpoints.begin(), checkpoints.end(), i,
+                               [](std::size_t step, const Checkpoint& c) { return step < c.step; }) - 1;
+    std::size_t run = static_cast<std::size_t>(cp - checkpoints.begin()) * CHECKPOINT_RUNS;
+    std::size_t step = cp->step;
+    GridPoint cell = cp->cell;
+    for (;; ++run)
+    {
+        const int code = runCode(runs[run]);
+        const int length = runLength(runs[run]);
+        const int taken = static_cast<int>(std::min<std::size_t>(i - step, length));
+        cell.first += STEP_DX[code] * taken;
+        cell.second += STEP_DY[code] * taken;
+        if (taken < length) return {run, taken, cell};
+        step += length;
+    }
+}
+
+CompactPath::const_iterator::const_iterator(const CompactPath* path, std::size_t index)
+    : path(path), index(index), at(path->seek(index))
+{
+}
+
+CompactPath::const_iterator& CompactPath::const_iterator::operator++()
+{
+    if (++index < path->count)
+    {
+        const std::uint8_t run = path->runs[at.run];
+        at.cell.first += STEP_DX[runCode(run)];
+        at.cell.second += STEP_DY[runCode(run)];
+        if (++at.offset == runLength(run))
+        {
+            ++at.run;
+            at.offset = 0;
+        }
+    }
+    return *this;
+}
+
+CompactPath::const_iterator& CompactPath::const_iterator::operator+=(difference_type n)
+{
+    index = static_cast<std::size_t>(static_cast<difference_type>(index) + n);
+    at = path->seek(index);
+    return *this;
+}
@@ -0,0 +1,282 @@
+#include "ComponentLabels.h"
+#include "GridSearch.h"
+#include "Map.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    constexpr int TILE = TiledGrid::TILE_SIZE;
+
+    std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t node)
+    {
+        while (parent[node] != node)
+        {
+            parent[node] = parent[parent[node]]; // path halving
+            node = parent[node];
+        }
+        return node;
+    }
+}
+
+ComponentLabels::ComponentLabels(const ComponentLabels& other)
+{
+    *this = other;
+}
+
+ComponentLabels& ComponentLabels::operator=(const ComponentLabels& other)
+{
+    if (this != &other)
+    {
+        std::scoped_lock lk(mu, other.mu);
+        built = other.built;
+        width = other.width;
+        height = other.height;
+        tilesX = other.tilesX;
+        tilesY = other.tilesY;
+        syncedVersion = other.syncedVersion;
+        tiles = other.tiles;
+        component = other.component;
+        componentTotal = other.componentTotal;
+    }
+    return *this;
+}
+
+std::uint32_t ComponentLabels::label(const Map& map, int x, int y)
+{
+    if (!map.isValidPosition(x, y)) return NONE;
+    std::lock_guard<std::mutex> lk(mu);
+    sync(map);
+    return lookup(x, y);
+}
+
+bool ComponentLabels::reachable(const Map& map, GridPoint start, GridPoint goal)
+{
+    if (!map.isValidPosition(start.first, start.second) || !map.isValidPosition(goal.first, goal.second))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(mu);
+    sync(map);
+    const std::uint32_t target = lookup(goal.first, goal.second);
+    if (target == NONE) return false;
+    if (start == goal) return true;
+    const std::uint32_t from = lookup(start.first, start.second);
+    if (from != NONE) return from == target;
+
+    // A robot on a blocked cell can still step onto any free neighbour
+    for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+    {
+        int nx = start.first + SearchWorkspace::DX[dir];
+        int ny = start.second + SearchWorkspace::DY[dir];
+        if (map.isValidPosition(nx, ny) && lookup(nx, ny) == target) return true;
+    }
+    return false;
+}
+
+std::size_t ComponentLabels::componentCount(const Map& map)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    sync(map);
+    return componentTotal;
+}
+
+void ComponentLabels::sync(const Map& map)
+{
+    const TiledGrid& grid = map.getGrid();
+    std::vector<MapChange> changes;
+    if (built && width == grid.getWidth() && height == grid.getHeight())
+    {
+        if (map.getVersion() == syncedVersion) return;
+        if (map.changesSince(syncedVersion, changes))
+        {
+            // Relabel only the tiles an edit touched, each once
+            std::vector<bool> dirty(tiles.size(), false);
+            for (const auto& change : changes)
+            {
+                for (int ty = change.y0 / TILE; ty <= (change.y1 - 1) / TILE; ++ty)
+                {
+                    for (int tx = change.x0 / TILE; tx <= (change.x1 - 1) / TILE; ++tx)
+                    {
+                        const int tile = ty * tilesX + tx;
+                        if (dirty[tile]) continue;
+                        dirty[tile] = true;
+                        labelTile(grid, tile);
+                    }
+                }
+            }
+            joinTiles();
+            syncedVersion = map.getVersion();
+            return;
+        }
+    }
+
+    width = grid.getWidth();
+    height = grid.getHeight();
+    tilesX = grid.getTilesX();
+    tilesY = grid.getTilesY();
+    tiles.assign(grid.getTileCount(), TileLabels());
+    for (int tile = 0; tile < static_cast<int>(tiles.size()); ++tile)
+    {
+        labelTile(grid, tile);
+    }
+    joinTiles();
+    built = true;
+    syncedVersion = map.getVersion();
+}
+
+void ComponentLabels::labelTile(const TiledGrid& grid, int tile)
+{
+    TileLabels& labels = tiles[tile];
+    if (grid.isTileUniform(tile))
+    {
+        // The in-map part of a tile is a rectangle, so free means one label
+        labels.count = grid.getTileValue(tile) == 0 ? 1 : 0;
+        labels.cells.clear();
+        labels.cells.shrink_to_fit();
+        return;
+    }
+
+    const int x0 = (tile % tilesX) * TILE;
+    const int y0 = (tile / tilesX) * TILE;
+    const int w = std::min(TILE, width - x0);
+    const int h = std::min(TILE, height - y0);
+    const std::uint8_t* cells = grid.getTileCells(tile);
+    auto isFree = [&](int lx, int ly) { return cells[grid.localIndex(x0 + lx, y0 + ly)] == 0; };
+
+    labels.count = 0;
+    labels.cells.assign(TiledGrid::TILE_CELLS, 0);
+    std::vector<int> stack;
+    for (int ly = 0; ly < h; ++ly)
+    {
+        for (int lx = 0; lx < w; ++lx)
+        {
+            if (labels.cells[ly * TILE + lx] != 0 || !isFree(lx, ly)) continue;
+
+            // Flood one 8-connected region of the tile
+            const std::uint16_t local = ++labels.count;
+            labels.cells[ly * TILE + lx] = local;
+            stack.push_back(ly * TILE + lx);
+            while (!stack.empty())
+            {
+                const int cx = stack.back() % TILE;
+                const int cy = stack.back() / TILE;
+                stack.pop_back();
+                for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+                {
+                    int nx = cx + SearchWorkspace::DX[dir];
+                    int ny = cy + SearchWorkspace::DY[dir];
+                    if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+                    std::uint16_t& mark = labels.cells[ny * TILE + nx];
+                    if (mark != 0 || !isFree(nx, ny)) continue;
+                    mark = local;
+                    stack.push_back(ny * TILE + nx);
+                }
+            }
+        }
+    }
+}
+
+void ComponentLabels::joinTiles()
+{
+    std::uint32_t nodes = 0;
+    for (TileLabels& labels : tiles)
+    {
+        labels.firstNode = nodes;
+        nodes += labels.count;
+    }
+    std::vector<std::uint32_t> parent(nodes);
+    std::iota(parent.begin(), parent.end(), 0u);
+
+    auto unite = [&](int tileA, std::uint16_t a, int tileB, std::uint16_t b) {
+        if (a == 0 || b == 0) return;
+        std::uint32_t ra = findRoot(parent, tiles[tileA].firstNode + a - 1);
+        std::uint32_t rb = findRoot(parent, tiles[tileB].firstNode + b - 1);
+        if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+    };
+
+    // Every tile but the last column and row is full-size, so each border
+    // below pairs in-map cells only
+    for (int ty = 0; ty < tilesY; ++ty)
+    {
+        const int h = std::min(TILE, height - ty * TILE);
+        for (int tx = 0; tx < tilesX; ++tx)
+        {
+            const int w = std::min(TILE, width - tx * TILE);
+            const int tile = ty * tilesX + tx;
+            if (tiles[tile].count == 0) continue;
+            const bool uniform = tiles[tile].cells.empty();
+
+            if (tx + 1 < tilesX)
+            {
+                const int right = tile + 1;
+                if (uniform && tiles[right].cells.empty())
+                {
+                    unite(tile, 1, right, tiles[right].count);
+                }
+                else
+                {
+                    for (int ly = 0; ly < h; ++ly)
+                    {
+                        const std::uint16_t a = localLabel(tile, TILE - 1, ly);
+                        if (a == 0) continue;
+                        for (int ny = std::max(ly - 1, 0); ny <= std::min(ly + 1, h - 1); ++ny)
+                        {
+                            unite(tile, a, right, localLabel(right, 0, ny));
+                        }
+                    }
+                }
+            }
+            if (ty + 1 < tilesY)
+            {
+                const int below = tile + tilesX;
+                if (uniform && tiles[below].cells.empty())
+                {
+                    unite(tile, 1, below, tiles[below].count);
+                }
+                else
+                {
+                    for (int lx = 0; lx < w; ++lx)
+                    {
+                        const std::uint16_t a = localLabel(tile, lx, TILE - 1);
+                        if (a == 0) continue;
+                        for (int nx = std::max(lx - 1, 0); nx <= std::min(lx + 1, w - 1); ++nx)
+                        {
+                            unite(tile, a, below, localLabel(below, nx, 0));
+                        }
+                    }
+                }
+                // Diagonal steps across a tile corner
+                if (tx + 1 < tilesX)
+                {
+                    unite(tile, localLabel(tile, TILE - 1, TILE - 1), below + 1, localLabel(below + 1, 0, 0));
+                }
+                if (tx > 0)
+                {
+                    unite(tile, localLabel(tile, 0, TILE - 1), below - 1, localLabel(below - 1, TILE - 1, 0));
+                }
+            }
+        }
+    }
+
+    // Roots come before their members, so one pass numbers the components
+    component.assign(nodes, NONE);
+    componentTotal = 0;
+    for (std::uint32_t node = 0; node < nodes; ++node)
+    {
+        std::uint32_t root = findRoot(parent, node);
+        component[node] = root == node ? ++componentTotal : component[root];
+    }
+}
+
+std::uint32_t ComponentLabels::lookup(int x, int y) const
+{
+    const int tile = (y / TILE) * tilesX + x / TILE;
+    const std::uint16_t local = localLabel(tile, x % TILE, y % TILE);
+    return local == 0 ? NONE : component[tiles[tile].firstNode + local - 1];
+}
+
+std::uint16_t ComponentLabels::localLabel(int tile, int lx, int ly) const
+{
+    const TileLabels& labels = tiles[tile];
+    return labels.cells.empty() ? labels.count : labels.cells[ly * TILE + lx];
+}
@@ -0,0 +1,293 @@
+#include "ConflictBasedSearch.h"
+#include "FlowField.h"
+#include "Map.h"
+#include "SearchWorkspace.h"
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <set>
+
+namespace {
+    // Forbids one agent to be at cell at step t, or, for an edge constraint,
+    // to move from cell to `to` between t and t + 1
+    struct Constraint
+    {
+        int agent;
+        bool edge;
+        GridPoint cell;
+        GridPoint to;
+        int t;
+    };
+
+    struct Conflict
+    {
+        bool found = false;
+        bool edge = false;
+        int a = -1;
+        int b = -1;
+        int t = 0;
+        int count = 0; // conflicting pairs over all steps
+    };
+
+    // Constraint tree node; constraints are shared with the ancestors
+    struct Node
+    {
+        int parent;
+        Constraint constraint;
+        std::vector<TimedPath> paths;
+        std::vector<int> lowerBounds; // per agent, from its low-level search
+        int cost;
+        int lowerBound; // sum of lowerBounds: no solution below this node costs less
+        Conflict conflict;
+    };
+
+    GridPoint at(const TimedPath& path, std::size_t t)
+    {
+        return t < path.size() ? path[t] : path.back(); // stays at the goal
+    }
+
+    int pathCost(const TimedPath& path)
+    {
+        int cost = 0;
+        for (std::size_t t = 1; t < path.size(); ++t)
+        {
+            bool diagonal = path[t].first != path[t - 1].first && path[t].second != path[t - 1].second;
+            cost += diagonal ? 14 : 10; // a wait costs a cardinal step
+        }
+        return cost;
+    }
+
+    // Earliest conflict between any two agents, plus how many there are.
+    // Who stands where at each step is kept in a search workspace, with the
+    // agent's index as the distance, so nothing is allocated per call.
+    Conflict findConflict(const std::vector<TimedPath>& paths, const TiledGrid& grid)
+    {
+        Conflict first;
+        std::size_t horizon = 0;
+        for (const TimedPath& path : paths) horizon = std::max(horizon, path.size());
+        auto record = [&first](bool edge, std::size_t a, std::size_t b, std::size_t t) {
+            if (!first.found)
+            {
+                first = {true, edge, static_cast<int>(std::min(a, b)), static_cast<int>(std::max(a, b)),
+                         static_cast<int>(t), 0};
+            }
+            ++first.count;
+        };
+
+        for (std::size_t t = 0; t < horizon; ++t)
+        {
+            SearchWorkspace& owner = SearchWorkspace::acquire(grid);
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                GridPoint cell = at(paths[i], t);
+                int j = owner.getDist(cell.first, cell.second);
+                if (j != SearchWorkspace::UNREACHED) record(false, j, i, t);
+                else owner.set(cell.first, cell.second, static_cast<int>(i), 0);
+            }
+            if (t + 1 >= horizon) break;
+            // Swaps: i moves onto the cell of some j that moves onto i's
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                GridPoint from = at(paths[i], t);
+                GridPoint to = at(paths[i], t + 1);
+                if (from == to) continue;
+                int j = owner.getDist(to.first, to.second);
+                if (j != SearchWorkspace::UNREACHED && static_cast<std::size_t>(j) > i && at(paths[j], t + 1) == from)
+                {
+                    record(true, i, j, t);
+                }
+            }
+        }
+        return first;
+    }
+
+    // Focal list order: fewest conflicts, then cheapest, then newest
+    struct FocalOrder
+    {
+        const std::vector<Node>* nodes;
+        bool operator()(int lhs, int rhs) const
+        {
+            const Node& a = (*nodes)[lhs];
+            const Node& b = (*nodes)[rhs];
+            if (a.conflict.count != b.conflict.count) return a.conflict.count > b.conflict.count;
+            if (a.cost != b.cost) return a.cost > b.cost;
+            return lhs < rhs;
+        }
+    };
+}
+
+JointPlan planConflictBased(const Map& map, const std::vector<AgentQuery>& agents,
+                           const std::vector<GridPoint>& stationary, std::chrono::milliseconds budget,
+                           double suboptimality)
+{
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    suboptimality = std::max(suboptimality, 1.0);
+    JointPlan result;
+
+    // Every agent is replanned many times, so its static distances come from
+    // the map's flow fields when all of them fit the cache at once; otherwise
+    // each search grows its own reverse search as before
+    std::vector<std::shared_ptr<const FlowField>> fields(agents.size());
+    if (FlowFieldSet::fieldBytes(map.getWidth(), map.getHeight()) * agents.size() <= FlowFieldSet::MEMORY_BUDGET)
+    {
+        for (std::size_t i = 0; i < agents.size(); ++i) fields[i] = map.getFlowField(agents[i].goal);
+    }
+
+    // Plan one agent of node against its constraints (from node up to the
+    // root, plus extra if given) and the stationary robots; the other agents'
+    // paths in node are soft reservations that the focal search steers clear of
+    auto replan = [&](const std::vector<Node>& nodes, int node, int agent, const Constraint* extra,
+                      SpaceTimeStats& stats) {
+        ReservationTable table;
+        for (const GridPoint& cell : stationary)
+        {
+            table.park(cell, 0);
+        }
+        auto apply = [&table](const Constraint& c) {
+            if (c.edge) table.blockMove(c.cell, c.to, c.t);
+            else table.reserveCell(c.cell, c.t);
+        };
+        if (extra) apply(*extra);
+        for (int n = node; n > 0; n = nodes[n].parent)
+        {
+            if (nodes[n].constraint.agent == agent) apply(nodes[n].constraint);
+        }
+        ReservationTable others;
+        for (std::size_t i = 0; i < nodes[node].paths.size(); ++i)
+        {
+            if (static_cast<int>(i) != agent && !nodes[node].paths[i].empty()) others.reservePath(nodes[node].paths[i]);
+        }
+        SpaceTimeOptions options;
+        options.suboptimality = suboptimality;
+        options.deadline = deadline;
+        options.distances = fields[agent].get();
+        return planSpaceTime(map, agents[agent].start, agents[agent].goal, table, &others, options, &stats);
+    };
+
+    const TiledGrid& grid = map.getGrid();
+    std::vector<Node> nodes;
+    nodes.push_back({-1, {}, std::vector<TimedPath>(agents.size()), std::vector<int>(agents.size(), 0), 0, 0, {}});
+    bool solvable = true;
+    for (std::size_t i = 0; i < agents.size() && solvable; ++i)
+    {
+        SpaceTimeStats stats;
+        TimedPath path = replan(nodes, 0, static_cast<int>(i), nullptr, stats);
+        solvable = !path.empty();
+        nodes[0].cost += pathCost(path);
+        nodes[0].lowerBounds[i] = stats.lowerBound;
+        nodes[0].lowerBound += stats.lowerBound;
+        nodes[0].paths[i] = std::move(path);
+    }
+
+    if (solvable)
+    {
+        // Unexpanded nodes are kept by lower bound and by cost; focal holds
+        // those costing at most suboptimality times the least lower bound,
+        // by fewest conflicts. That bound never drops below its best so far,
+        // which is still at most the optimum.
+        nodes[0].conflict = findConflict(nodes[0].paths, grid);
+        std::set<std::pair<int, int>> byLowerBound;
+        std::set<std::pair<int, int>> byCost;
+        std::priority_queue<int, std::vector<int>, FocalOrder> focal(FocalOrder{&nodes});
+        double focalBound = -1;
+        auto enqueue = [&](int id) {
+            byLowerBound.insert({nodes[id].lowerBound, id});
+            byCost.insert({nodes[id].cost, id});
+            if (nodes[id].cost <= focalBound) focal.push(id);
+        };
+        enqueue(0);
+        while (!byCost.empty() && std::chrono::steady_clock::now() < deadline)
+        {
+            const double bound = byLowerBound.begin()->first * suboptimality;
+            if (bound > focalBound)
+            {
+                for (auto it = byCost.begin(); it != byCost.end() && it->first <= bound; ++it)
+                {
+                    if (it->first > focalBound) focal.push(it->second);
+                }
+                focalBound = bound;
+            }
+
+            const int current = focal.top();
+            focal.pop();
+            byLowerBound.erase({nodes[current].lowerBound, current});
+            byCost.erase({nodes[current].cost, current});
+            ++result.nodes;
+            const Conflict conflict = nodes[current].conflict;
+            if (!conflict.found)
+            {
+                result.paths = nodes[current].paths;
+                result.solved = true;
+                return result;
+            }
+            if (!conflict.edge && conflict.t == 0) break; // two agents start on the same cell
+
+            // One child per agent of the conflict, each keeping that agent
+            // off the contested cell (or move) at that step
+            struct Child
+            {
+                Constraint constraint;
+                TimedPath path;
+                int lowerBound;
+                int cost;
+                Conflict conflict;
+            };
+            std::vector<Child> children;
+            for (int agent : {conflict.a, conflict.b})
+            {
+                const TimedPath& own = nodes[current].paths[agent];
+                Constraint c{agent, conflict.edge, at(own, conflict.t), at(own, conflict.t + 1), conflict.t};
+                if (!c.edge) c.to = c.cell;
+                SpaceTimeStats stats;
+                TimedPath path = replan(nodes, current, agent, &c, stats);
+                if (path.empty()) continue; // this branch has no solution
+
+                std::vector<TimedPath> paths = nodes[current].paths;
+                const int cost = nodes[current].cost - pathCost(paths[agent]) + pathCost(path);
+                paths[agent] = path;
+                children.push_back({c, std::move(path), stats.lowerBound, cost, findConflict(paths, grid)});
+            }
+
+            // Bypass: a child path that costs no more and conflicts less is
+            // just as good an answer for this node, so take it over instead
+            // of splitting the tree
+            const Child* bypass = nullptr;
+            for (const Child& child : children)
+            {
+                if (child.cost <= nodes[current].cost && child.conflict.count < nodes[current].conflict.count &&
+                    (!bypass || child.conflict.count < bypass->conflict.count))
+                {
+                    bypass = &child;
+                }
+            }
+            if (bypass)
+            {
+                Node& node = nodes[current];
+                node.paths[bypass->constraint.agent] = bypass->path;
+                node.cost = bypass->cost;
+                node.conflict = bypass->conflict;
+                enqueue(current);
+                continue;
+            }
+
+            for (Child& child : children)
+            {
+                const int agent = child.constraint.agent;
+                Node added{current, child.constraint, nodes[current].paths, nodes[current].lowerBounds,
+                           child.cost, 0, child.conflict};
+                added.paths[agent] = std::move(child.path);
+                added.lowerBound = nodes[current].lowerBound - added.lowerBounds[agent] +
+                                   std::max(child.lowerBound, added.lowerBounds[agent]);
+                added.lowerBounds[agent] = std::max(child.lowerBound, added.lowerBounds[agent]);
+                nodes.push_back(std::move(added));
+                enqueue(static_cast<int>(nodes.size()) - 1);
+            }
+        }
+    }
+
+    // The fallback gets a budget of its own, so a search that ran out of
+    // time still leaves room to plan every robot
+    result.paths = planCooperative(map, agents, stationary, std::chrono::steady_clock::now() + budget);
+    result.solved = false;
+    return result;
+}
@@ -0,0 +1,417 @@
+#include "DStarLite.h"
+#include "GridSearch.h"
+#include "Map.h"
+#include <algorithm>
+#include <iterator>
+
+DStarLite::DStarLite(GridPoint goal)
+    : goal(goal)
+{
+}
+
+PlanResult DStarLite::plan(const Map& map, GridPoint start)
+{
+    PlanResult result;
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return result;
+    }
+
+    if (!initialized || width != map.getWidth() || height != map.getHeight())
+    {
+        reset(map, start);
+    }
+    else
+    {
+        if (start != lastStart)
+        {
+            // Keys stay comparable if every later one grows by how far the
+            // heuristic origin moved
+            km += octileDistance(lastStart, start);
+            lastStart = start;
+            if (km > KM_LIMIT) rekey();
+        }
+        sync(map);
+    }
+
+    // A blocked start is nobody's successor, so nothing has updated it yet
+    if (start != goal) updateVertex(map, start);
+    result.expanded = computeShortestPath(map);
+
+    if (start != goal && stateAt(start).rhs == INF) return result; // unreachable
+
+    // Walk down the g values; each step goes to the successor on a cheapest path
+    GridPoint at = start;
+    int cost = 0;
+    result.path.push_back(at);
+    for (std::size_t guard = stateCount(); at != goal && guard > 0; --guard)
+    {
+        int best = INF;
+        int bestDir = -1;
+        const TiledGrid::CellRef atRef = map.getGrid().ref(at.first, at.second);
+        for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+        {
+            int nx = at.first + SearchWorkspace::DX[dir];
+            int ny = at.second + SearchWorkspace::DY[dir];
+            if (!passable(map.getGrid(), atRef, at, dir)) continue;
+            int g = gOf({nx, ny});
+            if (g != INF && g + RobotCost::step(dir) < best)
+            {
+                best = g + RobotCost::step(dir);
+                bestDir = dir;
+            }
+        }
+        if (bestDir < 0) break;
+        at = {at.first + SearchWorkspace::DX[bestDir], at.second + SearchWorkspace::DY[bestDir]};
+        cost += RobotCost::step(bestDir);
+        result.path.push_back(at);
+    }
+    if (at != goal)
+    {
+        result.path = CompactPath();
+        return result;
+    }
+    result.cost = cost;
+    return result;
+}
+
+void DStarLite::reset(const Map& map, GridPoint start)
+{
+    width = map.getWidth();
+    height = map.getHeight();
+    blocksWide = (width + BLOCK - 1) / BLOCK;
+    blocks.assign(static_cast<std::size_t>(blocksWide) * ((height + BLOCK - 1) / BLOCK), {});
+    allocatedBlocks = 0;
+    buckets.clear();
+    queued = 0;
+    km = 0;
+    lastStart = start;
+    syncedVersion = map.getVersion();
+    initialized = true;
+
+    State& g = stateAt(goal);
+    g.rhs = 0;
+    enqueue(goal, g);
+}
+
+void DStarLite::rekey()
+{
+    // Every open state gets the key it would get from a fresh enqueue at the
+    // current start, with no moves to make up for
+    std::vector<GridPoint> open;
+    open.reserve(queued);
+    for (const auto& [key1, bucket] : buckets)
+    {
+        for (const Entry& e : bucket.entries)
+        {
+            const State* s = findState({e.x, e.y});
+            if (s != nullptr && s->g != s->rhs) open.push_back({e.x, e.y});
+        }
+    }
+    std::sort(open.begin(), open.end());
+    open.erase(std::unique(open.begin(), open.end()), open.end()); // some were queued twice
+    buckets.clear();
+    queued = 0;
+    km = 0;
+    for (GridPoint u : open)
+    {
+        enqueue(u, stateAt(u));
+    }
+}
+
+void DStarLite::sync(const Map& map)
+{
+    if (map.getVersion() == syncedVersion)
+    {
+        return;
+    }
+
+    std::vector<MapChange> changes;
+    bool journaled = map.changesSince(syncedVersion, changes);
+    std::size_t area = 0;
+    for (const auto& change : changes)
+    {
+        area += static_cast<std::size_t>(change.x1 - change.x0) * (change.y1 - change.y0);
+    }
+    // Repairing more cells than the search ever reached costs more than
+    // starting over
+    if (!journaled || area > stateCount())
+    {
+        reset(map, lastStart);
+        return;
+    }
+
+    // A changed cell changes the cost of every step into it, so its
+    // neighbours (and the cell itself, if it became free) need new rhs values.
+    // Cells the search never touched still have nothing to repair.
+    for (const auto& change : changes)
+    {
+        for (int y = std::max(change.y0 - 1, 0); y <= std::min(change.y1, height - 1); ++y)
+        {
+            for (int x = std::max(change.x0 - 1, 0); x <= std::min(change.x1, width - 1); ++x)
+            {
+                const bool inside = x >= change.x0 && x < change.x1 && y >= change.y0 && y < change.y1;
+                const State* s = findState({x, y});
+                if (!inside && (s == nullptr || (s->g == INF && s->rhs == INF))) continue;
+                if (!passable(map, x, y)) continue;
+                updateVertex(map, {x, y});
+            }
+        }
+    }
+    syncedVersion = map.getVersion();
+}
+
+std::size_t DStarLite::computeShortestPath(const Map& map)
+{
+    std::size_t expanded = 0;
+    Entry top;
+    int minKey2;
+    while (topEntry(top, minKey2))
+    {
+        State& start = stateAt(lastStart);
+        int startKey1, startKey2;
+        calculateKey(start, lastStart, startKey1, startKey2);
+        // Some queued key is below the start's (minKey2 may only err low)
+        const bool beforeStart = top.key1 < startKey1 || (top.key1 == startKey1 && minKey2 < startKey2);
+        if (!beforeStart && start.rhs <= start.g) break;
+
+        popEntry();
+        GridPoint u{top.x, top.y};
+        State& s = stateAt(u);
+        int key1, key2;
+        calculateKey(s, u, key1, key2);
+        if (top.key1 < key1 || (top.key1 == key1 && top.key2 < key2))
+        {
+            // Queued before the start moved; requeue with the current key
+            enqueue(u, s);
+            continue;
+        }
+
+        ++expanded;
+        if (s.g > s.rhs)
+        {
+            // g only went down, so a predecessor's rhs can only improve
+            // through u; no need to rescan all its successors
+            s.g = s.rhs;
+            const int g = s.g;
+            forEachPredecessor(map, u, [&](GridPoint p, int step) {
+                if (p == goal) return;
+                State& ps = stateAt(p);
+                if (g + step < ps.rhs)
+                {
+                    ps.rhs = g + step;
+                    enqueue(p, ps);
+                }
+            });
+        }
+        else
+        {
+            s.g = INF;
+            updateVertex(map, u);
+            forEachPredecessor(map, u, [&](GridPoint p, int) { updateVertex(map, p); });
+        }
+    }
+    return expanded;
+}
+
+void DStarLite::updateVertex(const Map& map, GridPoint u)
+{
+    State& s = stateAt(u);
+    if (u != goal)
+    {
+        int best = INF;
+        const TiledGrid::CellRef cell = map.getGrid().ref(u.first, u.second);
+        for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+        {
+            int nx = u.first + SearchWorkspace::DX[dir];
+            int ny = u.second + SearchWorkspace::DY[dir];
+            if (!passable(map.getGrid(), cell, u, dir)) continue;
+            int g = gOf({nx, ny});
+            if (g != INF) best = std::min(best, g + RobotCost::step(dir));
+        }
+        s.rhs = best;
+    }
+    enqueue(u, s);
+}
+
+template <typename Visit>
+void DStarLite::forEachPredecessor(const Map& map, GridPoint u, Visit&& visit) const
+{
+    // Steps into a blocked cell cost INF whatever its g is
+    if (!passable(map, u.first, u.second)) return;
+    const TiledGrid::CellRef cell = map.getGrid().ref(u.first, u.second);
+    for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+    {
+        GridPoint p{u.first + SearchWorkspace::DX[dir], u.second + SearchWorkspace::DY[dir]};
+        if (p.first < 0 || p.first >= width || p.second < 0 || p.second >= height) continue;
+        // Blocked cells are only ever left by a robot starting on one
+        if (!passable(map.getGrid(), cell, u, dir) && p != lastStart) continue;
+        visit(p, RobotCost::step(dir)); // the step p -> u costs the same as u -> p
+    }
+}
+
+void DStarLite::enqueue(GridPoint u, State& s)
+{
+    if (s.g == s.rhs) return;
+    int key1, key2;
+    calculateKey(s, u, key1, key2);
+    pushEntry({key1, key2, u.first, u.second});
+}
+
+void DStarLite::pushEntry(const Entry& entry)
+{
+    Bucket& bucket = buckets[entry.key1];
+    bucket.entries.push_back(entry);
+    bucket.minKey2 = std::min(bucket.minKey2, entry.key2);
+    ++queued;
+}
+
+bool DStarLite::topEntry(Entry& out, int& minKey2)
+{
+    while (queued > 0)
+    {
+        const Bucket& bucket = buckets.begin()->second;
+        const Entry& e = bucket.entries.back();
+        const State* s = findState({e.x, e.y});
+        if (s != nullptr && s->g != s->rhs)
+        {
+            // An open state always has an entry at or below its current key
+            // (keys only grow with km between changes), so one above it was
+            // superseded; one below was queued before the start moved
+            int key1, key2;
+            calculateKey(*s, {e.x, e.y}, key1, key2);
+            if (e.key1 < key1 || (e.key1 == key1 && e.key2 <= key2))
+            {
+                out = e;
+                minKey2 = bucket.minKey2;
+                return true;
+            }
+        }
+        popEntry(); // superseded
+    }
+    return false;
+}
+
+void DStarLite::popEntry()
+{
+    auto lowest = buckets.begin();
+    lowest->second.entries.pop_back();
+    if (lowest->second.entries.empty()) buckets.erase(lowest);
+    --queued;
+}
+
+void DStarLite::calculateKey(const State& s, GridPoint u, int& key1, int& key2) const
+{
+    const int m = std::min(s.g, s.rhs);
+    if (m == INF)
+    {
+        key1 = key2 = INF;
+        return;
+    }
+    key1 = m + octileDistance(lastStart, u) + km;
+    key2 = m;
+}
+
+bool DStarLite::passable(const Map& map, int x, int y) const
+{
+    return x >= 0 && x < width && y >= 0 && y < height && map.getGrid().get(x, y) == 0;
+}
+
+bool DStarLite::passable(const TiledGrid& grid, TiledGrid::CellRef cell, GridPoint from, int dir) const
+{
+    const int dx = SearchWorkspace::DX[dir];
+    const int dy = SearchWorkspace::DY[dir];
+    const int x = from.first + dx;
+    const int y = from.second + dy;
+    return x >= 0 && x < width && y >= 0 && y < height &&
+           grid.get(grid.neighbour(cell, from.first, from.second, dx, dy)) == 0;
+}
+
+int DStarLite::gOf(GridPoint u) const
+{
+    const State* s = findState(u);
+    return s == nullptr ? INF : s->g;
+}
+
+const DStarLite::State* DStarLite::findState(GridPoint u) const
+{
+    const std::vector<State>& block = blocks[(u.second / BLOCK) * blocksWide + u.first / BLOCK];
+    return block.empty() ? nullptr : &block[(u.second % BLOCK) * BLOCK + u.first % BLOCK];
+}
+
+std::size_t DStarLite::memoryBytes() const
+{
+    // A map node costs about four pointers besides its bucket
+    return stateCount() * sizeof(State) + blocks.size() * sizeof(std::vector<State>) + queued * sizeof(Entry) +
+           buckets.size() * (sizeof(std::pair<const int, Bucket>) + 4 * sizeof(void*));
+}
+
+DStarLiteSet::DStarLiteSet(const DStarLiteSet& other) : budget(other.budget.load())
+{
+    std::lock_guard<std::mutex> lk(other.mu);
+    for (const auto& [key, slot] : other.slots)
+    {
+        std::lock_guard<std::mutex> slotLock(slot->mu);
+        slots.emplace_back(key, std::make_shared<Slot>(slot->planner));
+    }
+}
+
+DStarLiteSet& DStarLiteSet::operator=(const DStarLiteSet& other)
+{
+    if (this != &other)
+    {
+        std::scoped_lock lk(mu, other.mu);
+        budget = other.budget.load();
+        slots.clear();
+        for (const auto& [key, slot] : other.slots)
+        {
+            std::lock_guard<std::mutex> slotLock(slot->mu);
+            slots.emplace_back(key, std::make_shared<Slot>(slot->planner));
+        }
+    }
+    return *this;
+}
+
+PlanResult DStarLiteSet::plan(const Map& map, GridPoint start, GridPoint goal, const std::string& agent)
+{
+    const SlotKey key{agent, goal};
+    std::shared_ptr<Slot> slot;
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        auto it = std::find_if(slots.begin(), slots.end(), [&](const auto& entry) { return entry.first == key; });
+        if (it != slots.end())
+        {
+            slots.splice(slots.begin(), slots, it);
+        }
+        else
+        {
+            slots.emplace_front(key, std::make_shared<Slot>(DStarLite(goal)));
+        }
+        slot = slots.front().second;
+    }
+
+    PlanResult result;
+    {
+        std::lock_guard<std::mutex> lk(slot->mu);
+        result = slot->planner.plan(map, start);
+        slot->bytes = slot->planner.memoryBytes();
+    }
+
+    // Searches only grow while they are used, so the budget is enforced
+    // after each query; a search still in use elsewhere lives on with its
+    // caller until that query returns
+    std::lock_guard<std::mutex> lk(mu);
+    const std::size_t limit = budget;
+    std::size_t total = 0;
+    for (auto it = slots.begin(); it != slots.end(); ++it)
+    {
+        total += it->second->bytes;
+        if (total > limit && it != slots.begin())
+        {
+            evictions += static_cast<std::size_t>(std::distance(it, slots.end()));
+            slots.erase(it, slots.end());
+            break;
+        }
+    }
+    return result;
+}
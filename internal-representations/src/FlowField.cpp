@@ -0,0 +1,144 @@
+#include "FlowField.h"
+#include "GridSearch.h"
+#include <algorithm>
+
+FlowField::FlowField(const TiledGrid& grid, std::uint64_t version, GridPoint goal)
+    : width(grid.getWidth()), height(grid.getHeight()), version(version), goal(goal)
+{
+    const std::size_t cells = static_cast<std::size_t>(width) * height;
+    dist.assign(cells, UNREACHED);
+    next.assign(cells, NONE);
+    if (!inBounds(goal) || grid.get(goal.first, goal.second) != 0) return;
+
+    // Steps cost the same both ways, and a flood out of the goal enters the
+    // same free cells a robot would drive through toward it
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+    expanded = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, goal, {-1, -1},
+                                                                      [](int, int) { return 0; }).expanded;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            int d = ws.getDist(x, y);
+            if (d == SearchWorkspace::UNREACHED) continue;
+            std::size_t i = index({x, y});
+            dist[i] = d;
+            // Code of the flood's move into the cell; stepping back against it heads for the goal
+            if (GridPoint{x, y} != goal) next[i] = static_cast<std::uint8_t>(ws.getDirection(x, y));
+        }
+    }
+}
+
+int FlowField::distance(GridPoint from) const
+{
+    if (!inBounds(from)) return UNREACHED;
+    int d = dist[index(from)];
+    if (d != UNREACHED) return d;
+    int cost;
+    return bestNeighbour(from, cost) < 0 ? UNREACHED : cost;
+}
+
+GridPoint FlowField::nextStep(GridPoint from) const
+{
+    if (!inBounds(from)) return {-1, -1};
+    const std::size_t i = index(from);
+    if (dist[i] == 0) return from;
+    if (next[i] != NONE)
+    {
+        return {from.first - SearchWorkspace::DX[next[i]], from.second - SearchWorkspace::DY[next[i]]};
+    }
+    int cost;
+    int dir = bestNeighbour(from, cost);
+    if (dir < 0) return {-1, -1};
+    return {from.first + SearchWorkspace::DX[dir], from.second + SearchWorkspace::DY[dir]};
+}
+
+PlanResult FlowField::path(GridPoint from) const
+{
+    PlanResult result;
+    const int cost = distance(from);
+    if (cost == UNREACHED) return result;
+    result.path.push_back(from);
+    for (GridPoint at = from; at != goal;)
+    {
+        at = nextStep(at);
+        result.path.push_back(at);
+    }
+    result.cost = cost;
+    return result;
+}
+
+int FlowField::bestNeighbour(GridPoint from, int& cost) const
+{
+    // Only reached cells hold a distance, and they are all free
+    int best = -1;
+    cost = UNREACHED;
+    for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+    {
+        GridPoint n{from.first + SearchWorkspace::DX[dir], from.second + SearchWorkspace::DY[dir]};
+        if (!inBounds(n)) continue;
+        int d = dist[index(n)];
+        if (d != UNREACHED && d + RobotCost::step(dir) < cost)
+        {
+            cost = d + RobotCost::step(dir);
+            best = dir;
+        }
+    }
+    return best;
+}
+
+FlowFieldSet::FlowFieldSet(const FlowFieldSet& other)
+{
+    *this = other;
+}
+
+FlowFieldSet& FlowFieldSet::operator=(const FlowFieldSet& other)
+{
+    if (this != &other)
+    {
+        // Built fields are immutable, so the copies share them
+        std::scoped_lock lk(mu, other.mu);
+        version = other.version;
+        slots.clear();
+        for (const auto& [goal, slot] : other.slots)
+        {
+            auto copy = std::make_shared<Slot>();
+            std::lock_guard<std::mutex> slotLock(slot->mu);
+            copy->field = slot->field;
+            if (copy->field) slots.emplace_back(goal, std::move(copy));
+        }
+    }
+    return *this;
+}
+
+std::shared_ptr<const FlowField> FlowFieldSet::get(const TiledGrid& grid, std::uint64_t version, GridPoint goal) const
+{
+    std::shared_ptr<Slot> slot;
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        if (version != this->version)
+        {
+            slots.clear();
+            this->version = version;
+        }
+        auto it = std::find_if(slots.begin(), slots.end(), [&](const auto& entry) { return entry.first == goal; });
+        if (it != slots.end())
+        {
+            slots.splice(slots.begin(), slots, it);
+            slot = slots.front().second;
+        }
+        else
+        {
+            slot = std::make_shared<Slot>();
+            const std::size_t keep =
+                MEMORY_BUDGET / std::max<std::size_t>(fieldBytes(grid.getWidth(), grid.getHeight()), 1);
+            if (keep > 0) slots.emplace_front(goal, slot);
+            while (slots.size() > keep) slots.pop_back();
+        }
+    }
+
+    // Built outside the set's lock, so other goals are not held up
+    std::lock_guard<std::mutex> lk(slot->mu);
+    if (!slot->field) slot->field = std::make_shared<const FlowField>(grid, version, goal);
+    return slot->field;
+}
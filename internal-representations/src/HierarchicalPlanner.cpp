@@ -0,0 +1,601 @@
+#include "HierarchicalPlanner.h"
+#include "Map.h"
+#include "SearchWorkspace.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+    constexpr int UNREACHED = SearchWorkspace::UNREACHED;
+
+    bool isFree(const TiledGrid& grid, int x, int y)
+    {
+        return x >= 0 && x < grid.getWidth() && y >= 0 && y < grid.getHeight() && grid.get(x, y) == 0;
+    }
+
+    int stepCost(GridPoint a, GridPoint b)
+    {
+        return (a.first != b.first && a.second != b.second) ? 14 : 10;
+    }
+
+    // Search confined to the rectangle [x0, x1) x [y0, y1). Without a target
+    // it is a full Dijkstra; with one it is A* that stops at the target.
+    // Buffers are kept between runs.
+    class LocalSearch
+    {
+    public:
+        void run(const TiledGrid& grid, int rx0, int ry0, int rx1, int ry1, GridPoint from, const GridPoint* target = nullptr)
+        {
+            x0 = rx0;
+            y0 = ry0;
+            w = rx1 - rx0;
+            h = ry1 - ry0;
+            // Generation stamps make a rerun cost only the cells it touches
+            std::size_t cells = static_cast<std::size_t>(w) * h;
+            if (stamp.size() < cells)
+            {
+                dist.resize(cells);
+                parent.resize(cells);
+                stamp.assign(cells, 0);
+            }
+            if (++generation == 0)
+            {
+                std::fill(stamp.begin(), stamp.end(), 0);
+                generation = 1;
+            }
+            auto visit = [&](int i, int d, int p)
+            {
+                stamp[i] = generation;
+                dist[i] = d;
+                parent[i] = p;
+            };
+
+            struct Item { int f; int cost; int index; };
+            struct Cmp
+            {
+                bool operator()(const Item& a, const Item& b) const
+                {
+                    return a.f != b.f ? a.f > b.f : a.cost < b.cost;
+                }
+            };
+            std::priority_queue<Item, std::vector<Item>, Cmp> pq;
+            auto heuristic = [&](int lx, int ly)
+            {
+                return target ? octileDistance({x0 + lx, y0 + ly}, *target) : 0;
+            };
+            const int goalIndex = target ? index(target->first, target->second) : -1;
+
+            const int dx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+            const int dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+            const int cost[8] = {10, 10, 10, 10, 14, 14, 14, 14};
+
+            int origin = index(from.first, from.second);
+            visit(origin, 0, -1);
+            pq.push({heuristic(from.first - x0, from.second - y0), 0, origin});
+            while (!pq.empty())
+            {
+                Item cur = pq.top();
+                pq.pop();
+                if (cur.cost != dist[cur.index]) continue; // stale
+                if (cur.index == goalIndex) break;
+
+                int lx = cur.index % w;
+                int ly = cur.index / w;
+                for (int dir = 0; dir < 8; ++dir)
+                {
+                    int nx = lx + dx[dir];
+                    int ny = ly + dy[dir];
+                    if (nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+                    int n = ny * w + nx;
+                    int nCost = cur.cost + cost[dir];
+                    if (stamp[n] == generation && nCost >= dist[n]) continue;
+                    if (grid.get(x0 + nx, y0 + ny) != 0) continue;
+
+                    visit(n, nCost, cur.index);
+                    pq.push({nCost + heuristic(nx, ny), nCost, n});
+                }
+            }
+        }
+
+        int at(int x, int y) const
+        {
+            int i = index(x, y);
+            return stamp[i] == generation ? dist[i] : UNREACHED;
+        }
+
+        // Cells after the search origin up to and including (x, y)
+        void appendPathTo(int x, int y, CompactPath& out) const
+        {
+            std::vector<GridPoint> cells;
+            for (int at = index(x, y); parent[at] != -1; at = parent[at])
+            {
+                cells.emplace_back(x0 + at % w, y0 + at / w);
+            }
+            for (auto it = cells.rbegin(); it != cells.rend(); ++it) out.push_back(*it);
+        }
+
+    private:
+        int x0 = 0;
+        int y0 = 0;
+        int w = 0;
+        int h = 0;
+        std::vector<int> dist;
+        std::vector<int> parent;
+        std::vector<unsigned> stamp;
+        unsigned generation = 0;
+
+        int index(int x, int y) const { return (y - y0) * w + (x - x0); }
+    };
+
+    // Crossings between two facing border lines of length n. aCell(i) and
+    // bCell(i) are the cells at position i on either side. For every pair of
+    // free runs (one per side) that touch, straight or diagonally, at least
+    // one crossing is emitted, so no connection between the clusters is lost.
+    template <typename CellA, typename CellB>
+    void lineTransitions(const TiledGrid& grid, int n, CellA aCell, CellB bCell,
+                         std::vector<std::pair<GridPoint, GridPoint>>& out)
+    {
+        auto runs = [&](auto cellAt)
+        {
+            std::vector<std::pair<int, int>> result; // inclusive [lo, hi]
+            for (int i = 0; i < n; ++i)
+            {
+                GridPoint c = cellAt(i);
+                if (!isFree(grid, c.first, c.second)) continue;
+                if (!result.empty() && result.back().second == i - 1) result.back().second = i;
+                else result.emplace_back(i, i);
+            }
+            return result;
+        };
+        auto runsA = runs(aCell);
+        auto runsB = runs(bCell);
+
+        for (const auto& ra : runsA)
+        {
+            for (const auto& rb : runsB)
+            {
+                int lo = std::max(ra.first, rb.first);
+                int hi = std::min(ra.second, rb.second);
+                if (lo <= hi)
+                {
+                    int length = hi - lo + 1;
+                    int count = (length + HierarchicalPlanner::ENTRANCE_SPACING - 1) / HierarchicalPlanner::ENTRANCE_SPACING;
+                    for (int t = 0; t < count; ++t)
+                    {
+                        int i = lo + (2 * t + 1) * length / (2 * count);
+                        out.emplace_back(aCell(i), bCell(i));
+                    }
+                }
+                else if (ra.second + 1 == rb.first)
+                {
+                    out.emplace_back(aCell(ra.second), bCell(rb.first));
+                }
+                else if (rb.second + 1 == ra.first)
+                {
+                    out.emplace_back(aCell(ra.first), bCell(rb.second));
+                }
+            }
+        }
+    }
+}
+
+HierarchicalPlanner::HierarchicalPlanner(const HierarchicalPlanner& other)
+{
+    std::lock_guard<std::mutex> lk(other.mu);
+    clusters = other.clusters;
+    clustersX = other.clustersX;
+    clustersY = other.clustersY;
+    syncedVersion = other.syncedVersion;
+}
+
+HierarchicalPlanner& HierarchicalPlanner::operator=(const HierarchicalPlanner& other)
+{
+    if (this != &other)
+    {
+        std::scoped_lock lk(mu, other.mu);
+        clusters = other.clusters;
+        clustersX = other.clustersX;
+        clustersY = other.clustersY;
+        syncedVersion = other.syncedVersion;
+    }
+    return *this;
+}
+
+std::size_t HierarchicalPlanner::builtClusterCount() const
+{
+    std::lock_guard<std::mutex> lk(mu);
+    return static_cast<std::size_t>(std::count_if(clusters.begin(), clusters.end(),
+        [](const Cluster& cluster) { return cluster.built; }));
+}
+
+void HierarchicalPlanner::sync(const Map& map)
+{
+    int cx = (map.getWidth() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    int cy = (map.getHeight() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    if (clusters.empty() || cx != clustersX || cy != clustersY)
+    {
+        clustersX = cx;
+        clustersY = cy;
+        clusters.assign(static_cast<std::size_t>(cx) * cy, Cluster());
+        syncedVersion = map.getVersion();
+        return;
+    }
+    if (map.getVersion() == syncedVersion)
+    {
+        return;
+    }
+
+    std::vector<MapChange> changes;
+    if (!map.changesSince(syncedVersion, changes))
+    {
+        clusters.assign(clusters.size(), Cluster());
+    }
+    else
+    {
+        // A change on a border also moves the entrances of the cluster
+        // across it, hence the one cell margin
+        for (const auto& change : changes)
+        {
+            int cx0 = std::max(change.x0 - 1, 0) / CLUSTER_SIZE;
+            int cy0 = std::max(change.y0 - 1, 0) / CLUSTER_SIZE;
+            int cx1 = std::min(change.x1, map.getWidth() - 1) / CLUSTER_SIZE;
+            int cy1 = std::min(change.y1, map.getHeight() - 1) / CLUSTER_SIZE;
+            for (int y = cy0; y <= cy1; ++y)
+            {
+                for (int x = cx0; x <= cx1; ++x)
+                {
+                    clusters[y * clustersX + x] = Cluster();
+                }
+            }
+        }
+    }
+    syncedVersion = map.getVersion();
+}
+
+HierarchicalPlanner::Cluster& HierarchicalPlanner::built(const TiledGrid& grid, int index)
+{
+    if (!clusters[index].built)
+    {
+        build(grid, index);
+    }
+    return clusters[index];
+}
+
+void HierarchicalPlanner::build(const TiledGrid& grid, int index)
+{
+    Cluster& cluster = clusters[index];
+    cluster.nodes.clear();
+
+    const int cx = index % clustersX;
+    const int cy = index / clustersX;
+    const int x0 = cx * CLUSTER_SIZE;
+    const int y0 = cy * CLUSTER_SIZE;
+    const int x1 = std::min(x0 + CLUSTER_SIZE, grid.getWidth());
+    const int y1 = std::min(y0 + CLUSTER_SIZE, grid.getHeight());
+
+    auto addLink = [&](GridPoint own, int otherCluster, GridPoint other)
+    {
+        auto it = std::find_if(cluster.nodes.begin(), cluster.nodes.end(),
+            [&](const Node& node) { return node.x == own.first && node.y == own.second; });
+        if (it == cluster.nodes.end())
+        {
+            cluster.nodes.push_back({own.first, own.second, {}});
+            it = cluster.nodes.end() - 1;
+        }
+        it->links.push_back({otherCluster, other.first, other.second});
+    };
+
+    // Borders are always evaluated with the lower cluster as side A so both
+    // clusters of a border derive the same crossings
+    std::vector<std::pair<GridPoint, GridPoint>> crossings;
+    auto border = [&](int other, bool ownIsA, int n, auto aCell, auto bCell)
+    {
+        crossings.clear();
+        lineTransitions(grid, n, aCell, bCell, crossings);
+        for (const auto& c : crossings)
+        {
+            if (ownIsA) addLink(c.first, other, c.second);
+            else addLink(c.second, other, c.first);
+        }
+    };
+    if (cx + 1 < clustersX)
+    {
+        border(index + 1, true, y1 - y0, [&](int i) { return GridPoint{x1 - 1, y0 + i}; }, [&](int i) { return GridPoint{x1, y0 + i}; });
+    }
+    if (cx > 0)
+    {
+        border(index - 1, false, y1 - y0, [&](int i) { return GridPoint{x0 - 1, y0 + i}; }, [&](int i) { return GridPoint{x0, y0 + i}; });
+    }
+    if (cy + 1 < clustersY)
+    {
+        border(index + clustersX, true, x1 - x0, [&](int i) { return GridPoint{x0 + i, y1 - 1}; }, [&](int i) { return GridPoint{x0 + i, y1}; });
+    }
+    if (cy > 0)
+    {
+        border(index - clustersX, false, x1 - x0, [&](int i) { return GridPoint{x0 + i, y0 - 1}; }, [&](int i) { return GridPoint{x0 + i, y0}; });
+    }
+
+    // Diagonal steps across the four corners
+    const int cornerDx[4] = {1, -1, 1, -1};
+    const int cornerDy[4] = {1, -1, -1, 1};
+    for (int k = 0; k < 4; ++k)
+    {
+        int ox = cx + cornerDx[k];
+        int oy = cy + cornerDy[k];
+        if (ox < 0 || ox >= clustersX || oy < 0 || oy >= clustersY) continue;
+        GridPoint own{cornerDx[k] > 0 ? x1 - 1 : x0, cornerDy[k] > 0 ? y1 - 1 : y0};
+        GridPoint other{own.first + cornerDx[k], own.second + cornerDy[k]};
+        if (isFree(grid, own.first, own.second) && isFree(grid, other.first, other.second))
+        {
+            addLink(own, oy * clustersX + ox, other);
+        }
+    }
+
+    const std::size_t n = cluster.nodes.size();
+    cluster.dist.assign(n * n, UNREACHED);
+    cluster.routes.assign(n * n, {});
+    bool open = true;
+    for (int y = y0; y < y1 && open; ++y)
+    {
+        for (int x = x0; x < x1 && open; ++x)
+        {
+            open = grid.get(x, y) == 0;
+        }
+    }
+    if (open)
+    {
+        // Nothing to route around: distances are octile
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                cluster.dist[i * n + j] = octileDistance({cluster.nodes[i].x, cluster.nodes[i].y}, {cluster.nodes[j].x, cluster.nodes[j].y});
+            }
+        }
+        cluster.built = true;
+        return;
+    }
+
+    // Distances are symmetric, so each pair is searched once
+    LocalSearch search;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        cluster.dist[i * n + i] = 0;
+    }
+    for (std::size_t i = 0; i + 1 < n; ++i)
+    {
+        search.run(grid, x0, y0, x1, y1, {cluster.nodes[i].x, cluster.nodes[i].y});
+        for (std::size_t j = i + 1; j < n; ++j)
+        {
+            int d = search.at(cluster.nodes[j].x, cluster.nodes[j].y);
+            cluster.dist[i * n + j] = d;
+            cluster.dist[j * n + i] = d;
+        }
+    }
+    cluster.built = true;
+}
+
+PlanResult HierarchicalPlanner::plan(const Map& map, GridPoint start, GridPoint goal)
+{
+    PlanResult result;
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return result;
+    }
+    if (!map.isAccessible(start.first, start.second))
+    {
+        // Entrances only cover free cells, so a robot standing on an
+        // obstacle plans on the full grid
+        return planPath(map, start, goal, PlannerAlgorithm::AStar);
+    }
+    if (start == goal)
+    {
+        result.path.push_back(start);
+        result.cost = 0;
+        return result;
+    }
+
+    // The lock covers syncing, building clusters and the route memo; a built
+    // cluster is not touched again until the map changes, so the search
+    // reads it unlocked and queries on one planner run side by side
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        sync(map);
+    }
+    const TiledGrid& grid = map.getGrid();
+    auto ready = [&](int index) -> const Cluster&
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        return built(grid, index);
+    };
+
+    auto bounds = [&](int index, int& x0, int& y0, int& x1, int& y1)
+    {
+        x0 = (index % clustersX) * CLUSTER_SIZE;
+        y0 = (index / clustersX) * CLUSTER_SIZE;
+        x1 = std::min(x0 + CLUSTER_SIZE, grid.getWidth());
+        y1 = std::min(y0 + CLUSTER_SIZE, grid.getHeight());
+    };
+    auto localSearch = [&](LocalSearch& search, int index, GridPoint from, const GridPoint* target)
+    {
+        int x0, y0, x1, y1;
+        bounds(index, x0, y0, x1, y1);
+        search.run(grid, x0, y0, x1, y1, from, target);
+    };
+
+    const int startCluster = clusterOf(start.first, start.second);
+    const int goalCluster = clusterOf(goal.first, goal.second);
+    LocalSearch fromStart;
+    LocalSearch toGoal;
+    LocalSearch refine;
+    localSearch(fromStart, startCluster, start, nullptr);
+    localSearch(toGoal, goalCluster, goal, nullptr);
+
+    // Abstract nodes are keyed by cluster and node index; start and goal
+    // get keys of their own
+    const std::int64_t START = -1;
+    const std::int64_t GOAL = -2;
+    auto key = [](int cluster, int node) { return (static_cast<std::int64_t>(cluster) << 20) | node; };
+    auto cellOf = [&](std::int64_t k) -> GridPoint
+    {
+        if (k == START) return start;
+        if (k == GOAL) return goal;
+        const Node& node = clusters[k >> 20].nodes[k & 0xFFFFF];
+        return {node.x, node.y};
+    };
+
+    // Search state of this query, per cluster it touches
+    struct SearchState
+    {
+        std::vector<int> cost;
+        std::vector<std::int64_t> parent;
+    };
+    std::unordered_map<int, SearchState> searchState;
+    int goalCost = UNREACHED;
+    std::int64_t goalParent = START;
+    auto state = [&](std::int64_t k) -> std::pair<int*, std::int64_t*>
+    {
+        if (k == GOAL) return {&goalCost, &goalParent};
+        const int c = static_cast<int>(k >> 20);
+        auto [it, added] = searchState.try_emplace(c);
+        if (added)
+        {
+            it->second.cost.assign(clusters[c].nodes.size(), UNREACHED);
+            it->second.parent.assign(clusters[c].nodes.size(), START);
+        }
+        std::size_t i = static_cast<std::size_t>(k & 0xFFFFF);
+        return {&it->second.cost[i], &it->second.parent[i]};
+    };
+    struct Item { int f; int cost; std::int64_t key; };
+    struct Cmp
+    {
+        bool operator()(const Item& a, const Item& b) const
+        {
+            return a.f != b.f ? a.f > b.f : a.cost < b.cost;
+        }
+    };
+    std::priority_queue<Item, std::vector<Item>, Cmp> pq;
+
+    auto relax = [&](std::int64_t k, int cost, std::int64_t parent)
+    {
+        auto st = state(k);
+        if (*st.first <= cost) return;
+        *st.first = cost;
+        *st.second = parent;
+        pq.push({cost + octileDistance(cellOf(k), goal), cost, k});
+    };
+
+    // Connect the start to its cluster's entrances (and straight to the goal
+    // when both are in the same cluster)
+    const Cluster& first = ready(startCluster);
+    for (std::size_t i = 0; i < first.nodes.size(); ++i)
+    {
+        int d = fromStart.at(first.nodes[i].x, first.nodes[i].y);
+        if (d != UNREACHED) relax(key(startCluster, static_cast<int>(i)), d, START);
+    }
+    if (startCluster == goalCluster && fromStart.at(goal.first, goal.second) != UNREACHED)
+    {
+        relax(GOAL, fromStart.at(goal.first, goal.second), START);
+    }
+
+    while (!pq.empty())
+    {
+        Item cur = pq.top();
+        pq.pop();
+        if (cur.cost != *state(cur.key).first) continue; // stale
+        ++result.expanded;
+        if (cur.key == GOAL) break;
+
+        const int c = static_cast<int>(cur.key >> 20);
+        const int i = static_cast<int>(cur.key & 0xFFFFF);
+        const std::size_t n = clusters[c].nodes.size();
+
+        for (std::size_t j = 0; j < n; ++j)
+        {
+            int d = clusters[c].dist[i * n + j];
+            if (d != UNREACHED && j != static_cast<std::size_t>(i))
+            {
+                relax(key(c, static_cast<int>(j)), cur.cost + d, cur.key);
+            }
+        }
+        if (c == goalCluster)
+        {
+            const Node& node = clusters[c].nodes[i];
+            int d = toGoal.at(node.x, node.y);
+            if (d != UNREACHED) relax(GOAL, cur.cost + d, cur.key);
+        }
+        for (std::size_t l = 0; l < clusters[c].nodes[i].links.size(); ++l)
+        {
+            Link link = clusters[c].nodes[i].links[l];
+            const Node& from = clusters[c].nodes[i];
+            int step = stepCost({from.x, from.y}, {link.x, link.y});
+            const Cluster& other = ready(link.cluster);
+            for (std::size_t j = 0; j < other.nodes.size(); ++j)
+            {
+                if (other.nodes[j].x == link.x && other.nodes[j].y == link.y)
+                {
+                    relax(key(link.cluster, static_cast<int>(j)), cur.cost + step, cur.key);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (goalCost == UNREACHED) return result; // unreachable
+
+    std::vector<std::int64_t> abstractPath;
+    for (std::int64_t k = GOAL; ; k = *state(k).second)
+    {
+        abstractPath.push_back(k);
+        if (k == START) break;
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    // Refine: a hop between clusters is one step, everything else is a
+    // search inside the cluster both ends share
+    result.path.push_back(start);
+    for (std::size_t a = 1; a < abstractPath.size(); ++a)
+    {
+        std::int64_t u = abstractPath[a - 1];
+        std::int64_t v = abstractPath[a];
+        GridPoint from = cellOf(u);
+        GridPoint to = cellOf(v);
+        if (u == START)
+        {
+            fromStart.appendPathTo(to.first, to.second, result.path);
+        }
+        else if (v != GOAL && (u >> 20) != (v >> 20))
+        {
+            result.path.push_back(to);
+        }
+        else if (v != GOAL)
+        {
+            // Entrance to entrance: refined once, then reused
+            const Cluster& cluster = clusters[u >> 20];
+            const std::size_t r = (u & 0xFFFFF) * cluster.nodes.size() + (v & 0xFFFFF);
+            std::shared_ptr<const CompactPath> route;
+            {
+                std::lock_guard<std::mutex> lk(mu);
+                route = cluster.routes[r];
+            }
+            if (!route)
+            {
+                localSearch(refine, static_cast<int>(u >> 20), from, &to);
+                CompactPath cells(from);
+                refine.appendPathTo(to.first, to.second, cells);
+                route = std::make_shared<const CompactPath>(std::move(cells));
+                std::lock_guard<std::mutex> lk(mu);
+                clusters[u >> 20].routes[r] = route;
+            }
+            // The path so far already ends at the route's first cell
+            result.path.append(*route);
+        }
+        else
+        {
+            localSearch(refine, static_cast<int>(u >> 20), from, &to);
+            refine.appendPathTo(to.first, to.second, result.path);
+        }
+    }
+    result.cost = goalCost;
+    return result;
+}
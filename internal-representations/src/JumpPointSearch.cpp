@@ -0,0 +1,186 @@
+#include "JumpPointSearch.h"
+#include "Map.h"
+#include "GridSearch.h"
+#include <algorithm>
+
+namespace {
+    class Jumper
+    {
+    public:
+        Jumper(const TiledGrid& grid, GridPoint goal)
+            : grid(grid), width(grid.getWidth()), height(grid.getHeight()), goal(goal)
+        {
+        }
+
+        // Whether (x+dx, y+dy) is free, stepping from the reference of (x, y)
+        bool free(TiledGrid::CellRef cell, int x, int y, int dx, int dy) const
+        {
+            const int nx = x + dx;
+            const int ny = y + dy;
+            return nx >= 0 && nx < width && ny >= 0 && ny < height &&
+                   grid.get(grid.neighbour(cell, x, y, dx, dy)) == 0;
+        }
+
+        // A neighbour reached around a blocked cell beside the run, which no
+        // cheaper path avoiding (x, y) can reach
+        bool hasForced(TiledGrid::CellRef cell, int x, int y, int dx, int dy) const
+        {
+            if (dx != 0 && dy != 0)
+            {
+                return (!free(cell, x, y, -dx, 0) && free(cell, x, y, -dx, dy)) ||
+                       (!free(cell, x, y, 0, -dy) && free(cell, x, y, dx, -dy));
+            }
+            if (dx != 0)
+            {
+                return (!free(cell, x, y, 0, 1) && free(cell, x, y, dx, 1)) ||
+                       (!free(cell, x, y, 0, -1) && free(cell, x, y, dx, -1));
+            }
+            return (!free(cell, x, y, 1, 0) && free(cell, x, y, 1, dy)) ||
+                   (!free(cell, x, y, -1, 0) && free(cell, x, y, -1, dy));
+        }
+
+        // Next jump point from (x, y) in direction (dx, dy), or false if the
+        // run hits an obstacle or the map border first. The run steps its
+        // cell reference with the layout's neighbour arithmetic.
+        bool jump(TiledGrid::CellRef cell, int x, int y, int dx, int dy, GridPoint& out) const
+        {
+            GridPoint unused;
+            for (;;)
+            {
+                if (!free(cell, x, y, dx, dy)) return false;
+                cell = grid.neighbour(cell, x, y, dx, dy);
+                x += dx;
+                y += dy;
+                if (x == goal.first && y == goal.second) break;
+                if (hasForced(cell, x, y, dx, dy)) break;
+                if (dx != 0 && dy != 0 && (jump(cell, x, y, dx, 0, unused) || jump(cell, x, y, 0, dy, unused))) break;
+            }
+            out = {x, y};
+            return true;
+        }
+
+    private:
+        const TiledGrid& grid;
+        int width;
+        int height;
+        GridPoint goal;
+    };
+}
+
+PlanResult jumpPointSearch(const Map& map, GridPoint start, GridPoint goal)
+{
+    PlanResult result;
+    const TiledGrid& grid = map.getGrid();
+
+    // Same start/goal rules as planPath
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return result;
+    }
+
+    Jumper jumper(grid, goal);
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+
+    // Jumps have unbounded cost, so the open list has to be a heap
+    BinaryHeapQueue pq;
+
+    ws.set(start.first, start.second, 0, 0);
+    pq.push({octileDistance(start, goal), 0, start.first, start.second});
+
+    const int* dx = SearchWorkspace::DX;
+    const int* dy = SearchWorkspace::DY;
+
+    while (!pq.empty())
+    {
+        SearchNode cur = pq.pop();
+
+        if (cur.cost != ws.getDist(cur.x, cur.y)) continue; // stale
+        ++result.expanded;
+
+        if (cur.x == goal.first && cur.y == goal.second) break;
+        const TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+
+        // Directions worth jumping in: all 8 at the start, otherwise the
+        // natural continuations of the incoming move plus forced neighbours
+        int dirs[8][2];
+        int dirCount = 0;
+        auto addDir = [&](int ddx, int ddy) { dirs[dirCount][0] = ddx; dirs[dirCount][1] = ddy; ++dirCount; };
+
+        if (cur.x == start.first && cur.y == start.second)
+        {
+            for (int dir = 0; dir < 8; ++dir) addDir(dx[dir], dy[dir]);
+        }
+        else
+        {
+            int incoming = ws.getDirection(cur.x, cur.y);
+            int px = dx[incoming];
+            int py = dy[incoming];
+            if (px != 0 && py != 0)
+            {
+                addDir(px, py);
+                addDir(px, 0);
+                addDir(0, py);
+                if (!jumper.free(curRef, cur.x, cur.y, -px, 0)) addDir(-px, py);
+                if (!jumper.free(curRef, cur.x, cur.y, 0, -py)) addDir(px, -py);
+            }
+            else if (px != 0)
+            {
+                addDir(px, 0);
+                if (!jumper.free(curRef, cur.x, cur.y, 0, 1)) addDir(px, 1);
+                if (!jumper.free(curRef, cur.x, cur.y, 0, -1)) addDir(px, -1);
+            }
+            else
+            {
+                addDir(0, py);
+                if (!jumper.free(curRef, cur.x, cur.y, 1, 0)) addDir(1, py);
+                if (!jumper.free(curRef, cur.x, cur.y, -1, 0)) addDir(-1, py);
+            }
+        }
+
+        for (int i = 0; i < dirCount; ++i)
+        {
+            GridPoint next;
+            if (!jumper.jump(curRef, cur.x, cur.y, dirs[i][0], dirs[i][1], next)) continue;
+
+            int nCost = cur.cost + octileDistance({cur.x, cur.y}, next);
+            if (nCost < ws.getDist(next.first, next.second))
+            {
+                ws.set(next.first, next.second, nCost, SearchWorkspace::directionOf(dirs[i][0], dirs[i][1]));
+                pq.push({nCost + octileDistance(next, goal), nCost, next.first, next.second});
+            }
+        }
+    }
+
+    int goalCost = ws.getDist(goal.first, goal.second);
+    if (goalCost == SearchWorkspace::UNREACHED) return result; // unreachable
+
+    // Only jump points are recorded, each with the direction of the jump that
+    // reached it. Walking back along that direction, the first reached cell
+    // whose cost plus the run so far equals ours is an optimal predecessor:
+    // the jump's own origin at the latest, or an earlier jump point on the
+    // same line with the same cost. Cells on the run are all free.
+    GridPoint at = goal;
+    int atCost = goalCost;
+    std::vector<GridPoint> cells{at};
+    while (at != start)
+    {
+        int dir = ws.getDirection(at.first, at.second);
+        int step = dir < 4 ? 10 : 14;
+        for (int k = 1; ; ++k)
+        {
+            at.first -= dx[dir];
+            at.second -= dy[dir];
+            cells.push_back(at);
+            int d = ws.getDist(at.first, at.second);
+            if (d != SearchWorkspace::UNREACHED && d + k * step == atCost)
+            {
+                atCost = d;
+                break;
+            }
+        }
+    }
+    std::reverse(cells.begin(), cells.end());
+    result.path = CompactPath(cells);
+    result.cost = goalCost;
+    return result;
+}
@@ -0,0 +1,236 @@
+#include "Landmarks.h"
+#include "GridSearch.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+namespace {
+    // Fill ws with the distance from source to every reachable cell
+    void flood(const TiledGrid& grid, SearchWorkspace& ws, GridPoint source)
+    {
+        searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, source, {-1, -1}, [](int, int) { return 0; });
+    }
+}
+
+std::size_t LandmarkTable::fieldBytes(int width, int height, int blockSize)
+{
+    const std::size_t blocks = static_cast<std::size_t>((width + blockSize - 1) / blockSize) *
+                               ((height + blockSize - 1) / blockSize);
+    return blocks * (blockSize == 1 ? 1 : 2) * sizeof(std::uint16_t);
+}
+
+LandmarkTable::LandmarkTable(const TiledGrid& grid, std::uint64_t version, int count,
+                             const std::vector<GridPoint>& previous, std::size_t budget)
+    : width(grid.getWidth()), height(grid.getHeight()), blocksX(width), version(version)
+{
+    // Exact fields while MIN_LANDMARKS of them fit, coarser ones after that
+    count = std::max(count, 0);
+    const std::size_t wanted = static_cast<std::size_t>(std::min(count, MIN_LANDMARKS));
+    std::size_t affordable = budget / std::max<std::size_t>(fieldBytes(width, height, blockSize), 1);
+    while (affordable < wanted && blockSize < MAX_BLOCK_SIZE)
+    {
+        blockSize *= 2;
+        affordable = budget / std::max<std::size_t>(fieldBytes(width, height, blockSize), 1);
+    }
+    count = static_cast<int>(std::min<std::size_t>(count, affordable));
+    if (count == 0) return; // not even one field fits: an empty table, whose bound is 0
+
+    const int s = blockSize;
+    blocksX = (width + s - 1) / s;
+    const std::size_t blocks = static_cast<std::size_t>(blocksX) * ((height + s - 1) / s);
+    auto blockOf = [&](int x, int y) { return static_cast<std::size_t>(y / s) * blocksX + x / s; };
+
+    // Free cells only; a landmark on an obstacle would see nothing
+    for (const GridPoint& p : previous)
+    {
+        if (static_cast<int>(landmarks.size()) < count && p.first >= 0 && p.first < width &&
+            p.second >= 0 && p.second < height && grid.get(p.first, p.second) == 0)
+        {
+            landmarks.push_back(p);
+        }
+    }
+
+    // nearest[b]: distance from block b to the closest landmark so far; a
+    // coarse block is represented by the first of its cells a flood reached
+    std::vector<int> nearest(blocks, INT_MAX);
+    std::vector<GridPoint> representative(s == 1 ? 0 : blocks, GridPoint{-1, -1});
+    std::vector<std::vector<std::uint16_t>> lows;
+    std::vector<std::vector<std::uint16_t>> highs;
+    auto farthest = [&]() {
+        GridPoint best{-1, -1};
+        int bestDist = -1;
+        for (std::size_t b = 0; b < blocks; ++b)
+        {
+            if (nearest[b] != INT_MAX && nearest[b] > bestDist)
+            {
+                bestDist = nearest[b];
+                best = s == 1 ? GridPoint{static_cast<int>(b % blocksX), static_cast<int>(b / blocksX)}
+                              : representative[b];
+            }
+        }
+        return best;
+    };
+    auto addField = [&](GridPoint source, bool keep) {
+        SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+        flood(grid, ws, source);
+        std::vector<std::uint16_t> low(keep ? blocks : 0, UNKNOWN);
+        std::vector<std::uint16_t> high(keep && s > 1 ? blocks : 0, 0);
+        std::vector<bool> partial(keep && s > 1 ? blocks : 0, false); // holds free cells the flood missed
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int d = ws.getDist(x, y);
+                std::size_t b = blockOf(x, y);
+                if (d == SearchWorkspace::UNREACHED)
+                {
+                    if (keep && s > 1 && grid.get(x, y) == 0) partial[b] = true;
+                    continue;
+                }
+                nearest[b] = std::min(nearest[b], d);
+                if (s > 1 && representative[b].first < 0) representative[b] = {x, y};
+                if (!keep) continue;
+                // Clamping never widens a difference, so the bound stays
+                // admissible and consistent past the 16-bit range
+                auto v = static_cast<std::uint16_t>(std::min(d, UNKNOWN - 1));
+                low[b] = std::min(low[b], v);
+                if (s > 1) high[b] = std::max(high[b], v);
+            }
+        }
+        if (keep)
+        {
+            // A block only partly seen by the landmark bounds nothing
+            for (std::size_t b = 0; b < partial.size(); ++b)
+            {
+                if (partial[b]) low[b] = UNKNOWN;
+            }
+            lows.push_back(std::move(low));
+            highs.push_back(std::move(high));
+        }
+    };
+
+    for (const GridPoint& p : landmarks)
+    {
+        addField(p, true);
+    }
+    if (static_cast<int>(landmarks.size()) < count && landmarks.empty())
+    {
+        // Seed the selection from some free cell; its own field is not kept
+        for (int y = 0; y < height && landmarks.empty(); ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                if (grid.get(x, y) == 0)
+                {
+                    addField({x, y}, false);
+                    GridPoint first = farthest();
+                    std::fill(nearest.begin(), nearest.end(), INT_MAX);
+                    landmarks.push_back(first);
+                    addField(first, true);
+                    break;
+                }
+            }
+        }
+    }
+    while (static_cast<int>(landmarks.size()) < count)
+    {
+        GridPoint next = farthest();
+        if (next.first < 0 || std::find(landmarks.begin(), landmarks.end(), next) != landmarks.end())
+        {
+            break; // every reachable cell (or block) already holds a landmark
+        }
+        landmarks.push_back(next);
+        addField(next, true);
+    }
+
+    // Interleave so one block's distances to all landmarks sit together
+    const std::size_t k = landmarks.size();
+    dist.assign(blocks * stride(), UNKNOWN);
+    for (std::size_t i = 0; i < k; ++i)
+    {
+        for (std::size_t b = 0; b < blocks; ++b)
+        {
+            dist[b * stride() + i] = lows[i][b];
+            if (s > 1) dist[b * stride() + k + i] = highs[i][b];
+        }
+    }
+}
+
+LandmarkTable::Bound::Bound(const LandmarkTable& table, GridPoint goal)
+    : table(table), goalLow(table.landmarks.size(), -1), goalHigh(table.landmarks.size(), -1)
+{
+    if (goal.first < 0 || goal.first >= table.width || goal.second < 0 || goal.second >= table.height) return;
+    const std::uint16_t* g = table.row(goal.first, goal.second);
+    const std::size_t high = table.stride() - goalLow.size(); // 0 for exact fields
+    for (std::size_t i = 0; i < goalLow.size(); ++i)
+    {
+        if (g[i] == UNKNOWN) continue;
+        goalLow[i] = g[i];
+        goalHigh[i] = g[high + i];
+    }
+}
+
+int LandmarkTable::Bound::operator()(int x, int y) const
+{
+    // A cell a landmark cannot see is in another component than the goal
+    // (or is the blocked start), where a bound of 0 is always safe. The true
+    // distances lie within each block's low and high, which are one value
+    // for exact fields.
+    const std::uint16_t* d = table.row(x, y);
+    const std::size_t high = table.stride() - goalLow.size();
+    int best = 0;
+    for (std::size_t i = 0; i < goalLow.size(); ++i)
+    {
+        if (goalLow[i] < 0 || d[i] == UNKNOWN) continue;
+        best = std::max(best, std::max(goalLow[i] - static_cast<int>(d[high + i]),
+                                       static_cast<int>(d[i]) - goalHigh[i]));
+    }
+    return best;
+}
+
+LandmarkSet::LandmarkSet(const LandmarkSet& other)
+{
+    std::lock_guard<std::mutex> lk(other.mu);
+    table = other.table;
+}
+
+LandmarkSet& LandmarkSet::operator=(const LandmarkSet& other)
+{
+    if (this != &other)
+    {
+        std::scoped_lock lk(mu, other.mu);
+        table = other.table;
+    }
+    return *this;
+}
+
+std::shared_ptr<const LandmarkTable> LandmarkSet::get(const TiledGrid& grid, std::uint64_t version) const
+{
+    std::vector<GridPoint> previous;
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        if (table && table->getVersion() == version) return table;
+        if (building) return nullptr;
+        building = true;
+        if (table) previous = table->getLandmarks();
+    }
+
+    // A rebuild floods the whole map once per landmark; other queries must
+    // not wait on the lock for it
+    std::shared_ptr<const LandmarkTable> fresh;
+    try
+    {
+        fresh = std::make_shared<const LandmarkTable>(grid, version, LandmarkTable::DEFAULT_LANDMARKS, previous);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        building = false;
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lk(mu);
+    building = false;
+    if (!table || table->getVersion() < version) table = fresh;
+    return fresh;
+}
@@ -1,25 +1,59 @@
 #include "Map.h"
+#include "PathCache.h"
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 
-Map::Map(int width, int height, const std::string &name, const std::string &mapUrl)
-    : width(width), height(height), name(name), mapUrl(mapUrl)
-{
-    // Validate dimensions
-    if (width <= 0 || height <= 0)
-    {
-        throw std::invalid_argument("Map dimensions must be positive");
-    }
-    
-    // Initialize the 2D grid with the specified dimensions
-    grid.resize(height);
-    for (int i = 0; i < height; ++i)
+namespace {
+    std::uint64_t nextInstanceId()
     {
-        grid[i].resize(width, 0); // Initialize all cells as accessible for now
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
     }
 }
 
+Map::InstanceId::InstanceId()
+    : value(nextInstanceId())
+{
+}
+
+Map::InstanceId::InstanceId(const InstanceId&)
+    : value(nextInstanceId())
+{
+}
+
+Map::InstanceId& Map::InstanceId::operator=(const InstanceId&)
+{
+    PathCache::instance().forgetMap(value);
+    value = nextInstanceId();
+    return *this;
+}
+
+Map::InstanceId::~InstanceId()
+{
+    PathCache::instance().forgetMap(value);
+}
+
+Map::Map(int width, int height, const std::string &name, const std::string &mapUrl, GridLayout layout)
+    : width(width), height(height), name(name), mapUrl(mapUrl), grid(width, height, 0, layout)
+{
+    // The tiled grid validates dimensions and starts with every tile uniformly
+    // accessible, so no per-cell storage exists until cells are written
+}
+
+Map::Map(const std::string &agmapPath, bool verifyChecksum)
+    : Map(MapFile::open(agmapPath, verifyChecksum))
+{
+}
+
+Map::Map(MapFile::Contents contents)
+    : width(contents.grid.getWidth()), height(contents.grid.getHeight()),
+      name(std::move(contents.name)), mapUrl(std::move(contents.mapUrl)), grid(std::move(contents.grid)),
+      obstacleCount(contents.obstacleCount)
+{
+}
+
 int Map::getWidth() const
 {
     return width;
@@ -98,7 +132,7 @@ int Map::getCell(int x, int y) const
     {
         throw std::out_of_range("Position is out of bounds");
     }
-    return grid[y][x];
+    return grid.get(x, y);
 }
 
 void Map::setCell(int x, int y, int value)
@@ -107,7 +141,172 @@ void Map::setCell(int x, int y, int value)
     {
         throw std::out_of_range("Position is out of bounds");
     }
-    grid[y][x] = value;
+    if (value < 0 || value > 255)
+    {
+        throw std::invalid_argument("Cell value must be in [0, 255]");
+    }
+    const std::uint8_t previous = grid.get(x, y);
+    if (previous == value)
+    {
+        return; // no change, version stays put
+    }
+    grid.set(x, y, static_cast<std::uint8_t>(value));
+    if (obstacleCount.value != ObstacleCount::UNKNOWN)
+    {
+        obstacleCount.value += (value != 0) - (previous != 0);
+    }
+    pyramid.update(grid, x, y);
+    journal.record(x, y, x + 1, y + 1);
+}
+
+const TiledGrid& Map::getGrid() const
+{
+    return grid;
+}
+
+GridLayout Map::getLayout() const
+{
+    return grid.getLayout();
+}
+
+void Map::importOccupancy(const std::vector<std::uint8_t> &cells, int srcWidth, int srcHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || cells.size() < static_cast<size_t>(srcWidth) * static_cast<size_t>(srcHeight))
+    {
+        throw std::invalid_argument("Occupancy raster is smaller than its dimensions");
+    }
+
+    TiledGrid imported(width, height, 0, grid.getLayout());
+    for (int sy = 0; sy < srcHeight; ++sy)
+    {
+        // Map rows covered by source row sy
+        int y0 = static_cast<int>(static_cast<long long>(sy) * height / srcHeight);
+        int y1 = static_cast<int>((static_cast<long long>(sy + 1) * height + srcHeight - 1) / srcHeight);
+        for (int sx = 0; sx < srcWidth; ++sx)
+        {
+            std::uint8_t value = cells[static_cast<size_t>(sy) * srcWidth + sx];
+            if (value == 0)
+            {
+                continue;
+            }
+            int x0 = static_cast<int>(static_cast<long long>(sx) * width / srcWidth);
+            int x1 = static_cast<int>((static_cast<long long>(sx + 1) * width + srcWidth - 1) / srcWidth);
+            for (int y = y0; y < std::min(y1, height); ++y)
+            {
+                for (int x = x0; x < std::min(x1, width); ++x)
+                {
+                    imported.set(x, y, std::max(imported.get(x, y), value));
+                }
+            }
+        }
+    }
+
+    grid = std::move(imported);
+    obstacleCount.value = grid.countNonZero();
+    pyramid.invalidate();
+    journal.record(0, 0, width, height);
+}
+
+std::uint64_t Map::getVersion() const
+{
+    return journal.getVersion();
+}
+
+bool Map::changesSince(std::uint64_t version, std::vector<MapChange> &out) const
+{
+    return journal.changesSince(version, out);
+}
+
+std::int64_t Map::getObstacleCount() const
+{
+    std::int64_t count = obstacleCount.value;
+    if (count == ObstacleCount::UNKNOWN)
+    {
+        // Reads every materialized tile, so a file opened without the count
+        // is only faulted in if someone asks
+        count = grid.countNonZero();
+        obstacleCount.value = count;
+    }
+    return count;
+}
+
+std::uint64_t Map::getInstanceId() const
+{
+    return instanceId.value;
+}
+
+int Map::getLevelCount() const
+{
+    return MapPyramid::levelCount(width, height);
+}
+
+int Map::getLevelWidth(int level) const
+{
+    return getLevelGrid(level).getWidth();
+}
+
+int Map::getLevelHeight(int level) const
+{
+    return getLevelGrid(level).getHeight();
+}
+
+int Map::getLevelCell(int level, int x, int y) const
+{
+    const TiledGrid& levelGrid = getLevelGrid(level);
+    if (x < 0 || x >= levelGrid.getWidth() || y < 0 || y >= levelGrid.getHeight())
+    {
+        throw std::out_of_range("Position is out of bounds");
+    }
+    return levelGrid.get(x, y);
+}
+
+const TiledGrid& Map::getLevelGrid(int level) const
+{
+    if (level == 0)
+    {
+        return grid;
+    }
+    return pyramid.level(grid, level);
+}
+
+PlanResult Map::planHierarchical(GridPoint start, GridPoint goal) const
+{
+    return hierarchy.plan(*this, start, goal);
+}
+
+PlanResult Map::planIncremental(GridPoint start, GridPoint goal, const std::string& agent) const
+{
+    return incremental.plan(*this, start, goal, agent);
+}
+
+void Map::setIncrementalBudget(std::size_t bytes)
+{
+    incremental.setMemoryBudget(bytes);
+}
+
+std::size_t Map::getIncrementalEvictions() const
+{
+    return incremental.getEvictions();
+}
+
+std::shared_ptr<const FlowField> Map::getFlowField(GridPoint goal) const
+{
+    return flowFields.get(grid, getVersion(), goal);
+}
+
+std::shared_ptr<const LandmarkTable> Map::getLandmarks() const
+{
+    return landmarks.get(grid, getVersion());
+}
+
+std::uint32_t Map::getComponent(int x, int y) const
+{
+    return components.label(*this, x, y);
+}
+
+bool Map::isReachable(GridPoint start, GridPoint goal) const
+{
+    return components.reachable(*this, start, goal);
 }
 
 bool Map::isValidPosition(int x, int y) const
@@ -121,18 +320,15 @@ bool Map::isAccessible(int x, int y) const
     {
         return false;
     }
-    return grid[y][x] == 0; // 0 means accessible
+    return grid.get(x, y) == 0; // 0 means accessible
 }
 
 void Map::initializeEmpty()
 {
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
-        {
-            grid[y][x] = 0; // Set all cells as accessible
-        }
-    }
+    grid.fill(0); // Set all cells as accessible
+    obstacleCount.value = 0;
+    pyramid.invalidate();
+    journal.record(0, 0, width, height);
 }
 
 std::string Map::serialize() const
@@ -147,7 +343,7 @@ std::string Map::serialize() const
         out << "[";
         for (int x = 0; x < width; ++x)
         {
-            out << grid[y][x];
+            out << static_cast<int>(grid.get(x, y));
             if (x < width - 1) out << ",";
         }
         out << "]";
@@ -158,6 +354,11 @@ std::string Map::serialize() const
     return out.str();
 }
 
+void Map::saveAgmap(const std::string &agmapPath) const
+{
+    MapFile::save(*this, agmapPath);
+}
+
 std::string Map::serializeRobots() const
 {
     std::ostringstream out;
@@ -0,0 +1,286 @@
+#include "MapFile.h"
+#include "Map.h"
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char AGMAP_MAGIC[8] = {'A', 'G', 'M', 'A', 'P', '\r', '\n', '\x1a'};
+    const std::uint64_t PAGE_ALIGN = 4096;
+    const std::uint64_t FNV_OFFSET = 1469598103934665603ull;
+    const std::uint64_t FNV_PRIME = 1099511628211ull;
+
+    std::uint64_t alignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t len)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        for (std::size_t i = 0; i < len; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    bool hostIsLittleEndian()
+    {
+        const std::uint16_t probe = 1;
+        std::uint8_t first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    // Read-only shared mapping of a whole file, released when the last tile
+    // referencing it goes away
+    std::shared_ptr<const std::uint8_t> mapFile(const std::string& path, std::size_t& size)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open map file: " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(AgmapHeader)))
+        {
+            ::close(fd);
+            throw std::runtime_error("Map file too small: " + path);
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            throw std::runtime_error("Cannot mmap map file: " + path);
+        }
+        std::size_t len = size;
+        return std::shared_ptr<const std::uint8_t>(static_cast<const std::uint8_t*>(addr),
+            [len](const std::uint8_t* p) { munmap(const_cast<std::uint8_t*>(p), len); });
+    }
+
+    std::uint64_t storedObstacleCount(const AgmapHeader& header)
+    {
+        return header.obstacleCount[0] | (static_cast<std::uint64_t>(header.obstacleCount[1]) << 32);
+    }
+
+    const AgmapHeader& validateHeader(const std::uint8_t* base, std::size_t size, const std::string& path)
+    {
+        const auto& header = *reinterpret_cast<const AgmapHeader*>(base);
+        if (std::memcmp(header.magic, AGMAP_MAGIC, sizeof(AGMAP_MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not an .agmap file: " + path);
+        }
+        if (header.version < MapFile::MIN_VERSION || header.version > MapFile::VERSION || header.cellEncoding != MapFile::CELL_ENCODING_U8 ||
+            header.tileSize != static_cast<std::uint32_t>(TiledGrid::TILE_SIZE) ||
+            header.layout > static_cast<std::uint32_t>(GridLayout::Morton))
+        {
+            throw std::runtime_error("Unsupported .agmap version or encoding: " + path);
+        }
+        if (header.width == 0 || header.height == 0 || header.width > 0x7fffffffu || header.height > 0x7fffffffu)
+        {
+            throw std::runtime_error("Invalid .agmap dimensions: " + path);
+        }
+        std::uint64_t tilesX = (header.width + TiledGrid::TILE_MASK) >> TiledGrid::TILE_SHIFT;
+        std::uint64_t tilesY = (header.height + TiledGrid::TILE_MASK) >> TiledGrid::TILE_SHIFT;
+        // Written so no sum or product can wrap: every offset is checked
+        // against the file size before anything is added to it
+        if (header.tileCount != tilesX * tilesY || header.headerSize > size ||
+            static_cast<std::uint64_t>(sizeof(AgmapHeader)) + header.nameLength + header.mapUrlLength > header.headerSize ||
+            header.tableOffset < header.headerSize || header.tableOffset % sizeof(std::uint64_t) != 0 ||
+            header.tableOffset > size || header.tileCount > (size - header.tableOffset) / sizeof(std::uint64_t))
+        {
+            throw std::runtime_error("Corrupt .agmap header: " + path);
+        }
+        if (header.version >= 2 &&
+            storedObstacleCount(header) > static_cast<std::uint64_t>(header.width) * header.height)
+        {
+            throw std::runtime_error("Corrupt .agmap header: " + path);
+        }
+        return header;
+    }
+
+    // Whether a tile table entry points at a whole page of cells inside the file
+    bool tileInFile(std::uint64_t entry, std::size_t size)
+    {
+        return entry % PAGE_ALIGN == 0 && entry <= size && size - entry >= TiledGrid::TILE_CELLS;
+    }
+
+    std::uint64_t computeChecksum(const std::uint8_t* base, const AgmapHeader& header)
+    {
+        const auto* table = reinterpret_cast<const std::uint64_t*>(base + header.tableOffset);
+        std::uint64_t hash = fnv1a(FNV_OFFSET, table, header.tileCount * sizeof(std::uint64_t));
+        for (std::uint64_t i = 0; i < header.tileCount; ++i)
+        {
+            if (!(table[i] & MapFile::UNIFORM_TILE_FLAG))
+            {
+                hash = fnv1a(hash, base + table[i], TiledGrid::TILE_CELLS);
+            }
+        }
+        return hash;
+    }
+}
+
+void MapFile::save(const Map& map, const std::string& path)
+{
+    if (!hostIsLittleEndian())
+    {
+        throw std::runtime_error(".agmap export requires a little-endian host");
+    }
+
+    const TiledGrid& grid = map.getGrid();
+    const std::string name = map.getName();
+    const std::string mapUrl = map.getMapUrl();
+
+    AgmapHeader header{};
+    std::memcpy(header.magic, AGMAP_MAGIC, sizeof(AGMAP_MAGIC));
+    header.version = VERSION;
+    header.headerSize = static_cast<std::uint32_t>(sizeof(AgmapHeader) + name.size() + mapUrl.size());
+    header.width = static_cast<std::uint32_t>(grid.getWidth());
+    header.height = static_cast<std::uint32_t>(grid.getHeight());
+    header.tileSize = TiledGrid::TILE_SIZE;
+    header.cellEncoding = CELL_ENCODING_U8;
+    header.layout = static_cast<std::uint32_t>(grid.getLayout());
+    header.nameLength = static_cast<std::uint32_t>(name.size());
+    header.mapUrlLength = static_cast<std::uint32_t>(mapUrl.size());
+    header.tileCount = grid.getTileCount();
+    header.tableOffset = alignUp(header.headerSize, sizeof(std::uint64_t));
+    const auto obstacles = static_cast<std::uint64_t>(map.getObstacleCount());
+    header.obstacleCount[0] = static_cast<std::uint32_t>(obstacles);
+    header.obstacleCount[1] = static_cast<std::uint32_t>(obstacles >> 32);
+
+    // Uniform tiles live in the table; the rest get consecutive pages
+    std::vector<std::uint64_t> table(header.tileCount);
+    std::uint64_t dataOffset = alignUp(header.tableOffset + header.tileCount * sizeof(std::uint64_t), PAGE_ALIGN);
+    std::uint64_t next = dataOffset;
+    for (std::uint64_t i = 0; i < header.tileCount; ++i)
+    {
+        int tile = static_cast<int>(i);
+        if (grid.isTileUniform(tile))
+        {
+            table[i] = UNIFORM_TILE_FLAG | grid.getTileValue(tile);
+        }
+        else
+        {
+            table[i] = next;
+            next += TiledGrid::TILE_CELLS;
+        }
+    }
+
+    std::uint64_t checksum = fnv1a(FNV_OFFSET, table.data(), table.size() * sizeof(std::uint64_t));
+    for (std::uint64_t i = 0; i < header.tileCount; ++i)
+    {
+        if (!(table[i] & UNIFORM_TILE_FLAG))
+        {
+            checksum = fnv1a(checksum, grid.getTileCells(static_cast<int>(i)), TiledGrid::TILE_CELLS);
+        }
+    }
+    header.checksum = checksum;
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("Cannot write map file: " + tmpPath);
+        }
+        const std::vector<char> padding(PAGE_ALIGN, 0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(name.data(), name.size());
+        out.write(mapUrl.data(), mapUrl.size());
+        out.write(padding.data(), header.tableOffset - header.headerSize);
+        out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(std::uint64_t));
+        out.write(padding.data(), dataOffset - (header.tableOffset + table.size() * sizeof(std::uint64_t)));
+        for (std::uint64_t i = 0; i < header.tileCount; ++i)
+        {
+            if (!(table[i] & UNIFORM_TILE_FLAG))
+            {
+                out.write(reinterpret_cast<const char*>(grid.getTileCells(static_cast<int>(i))), TiledGrid::TILE_CELLS);
+            }
+        }
+        out.flush();
+        if (!out)
+        {
+            std::remove(tmpPath.c_str());
+            throw std::runtime_error("Failed writing map file: " + tmpPath);
+        }
+    }
+
+    // Rename keeps existing mappings of the old file valid
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        throw std::runtime_error("Cannot replace map file: " + path);
+    }
+}
+
+MapFile::Contents MapFile::open(const std::string& path, bool verifyChecksum)
+{
+    if (!hostIsLittleEndian())
+    {
+        throw std::runtime_error(".agmap import requires a little-endian host");
+    }
+
+    std::size_t size = 0;
+    std::shared_ptr<const std::uint8_t> region = mapFile(path, size);
+    const std::uint8_t* base = region.get();
+    const AgmapHeader& header = validateHeader(base, size, path);
+
+    const char* strings = reinterpret_cast<const char*>(base + sizeof(AgmapHeader));
+    Contents contents{
+        TiledGrid(static_cast<int>(header.width), static_cast<int>(header.height), 0, static_cast<GridLayout>(header.layout)),
+        std::string(strings, header.nameLength),
+        std::string(strings + header.nameLength, header.mapUrlLength)};
+    if (header.version >= 2)
+    {
+        contents.obstacleCount = static_cast<std::int64_t>(storedObstacleCount(header));
+    }
+
+    const auto* table = reinterpret_cast<const std::uint64_t*>(base + header.tableOffset);
+    for (std::uint64_t i = 0; i < header.tileCount; ++i)
+    {
+        int tile = static_cast<int>(i);
+        std::uint64_t entry = table[i];
+        if (entry & UNIFORM_TILE_FLAG)
+        {
+            contents.grid.setTileValue(tile, static_cast<std::uint8_t>(entry & 0xff));
+            continue;
+        }
+        if (!tileInFile(entry, size))
+        {
+            throw std::runtime_error("Corrupt tile table in map file: " + path);
+        }
+        // Aliasing pointer: shares ownership of the mapping, points at the tile
+        contents.grid.attachTile(tile, std::shared_ptr<const std::uint8_t>(region, base + entry));
+    }
+
+    if (verifyChecksum && computeChecksum(base, header) != header.checksum)
+    {
+        throw std::runtime_error("Checksum mismatch in map file: " + path);
+    }
+    return contents;
+}
+
+bool MapFile::verify(const std::string& path)
+{
+    std::size_t size = 0;
+    std::shared_ptr<const std::uint8_t> region = mapFile(path, size);
+    const AgmapHeader& header = validateHeader(region.get(), size, path);
+    const auto* table = reinterpret_cast<const std::uint64_t*>(region.get() + header.tableOffset);
+    for (std::uint64_t i = 0; i < header.tileCount; ++i)
+    {
+        if (!(table[i] & UNIFORM_TILE_FLAG) && !tileInFile(table[i], size))
+        {
+            return false;
+        }
+    }
+    return computeChecksum(region.get(), header) == header.checksum;
+}
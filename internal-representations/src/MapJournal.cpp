@@ -0,0 +1,62 @@
+#include "MapJournal.h"
+#include "TiledGrid.h"
+#include <algorithm>
+#include <stdexcept>
+
+MapJournal::MapJournal(std::size_t capacity)
+    : ring(capacity)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("Journal capacity must be positive");
+    }
+}
+
+std::uint64_t MapJournal::record(int x0, int y0, int x1, int y1)
+{
+    ++version;
+
+    if (count > 0)
+    {
+        MapChange& last = ring[(head + count - 1) % ring.size()];
+        int ux0 = std::min(last.x0, x0);
+        int uy0 = std::min(last.y0, y0);
+        int ux1 = std::max(last.x1, x1);
+        int uy1 = std::max(last.y1, y1);
+        bool touching = x0 <= last.x1 && last.x0 <= x1 && y0 <= last.y1 && last.y0 <= y1;
+        if (touching && ux1 - ux0 <= TiledGrid::TILE_SIZE && uy1 - uy0 <= TiledGrid::TILE_SIZE)
+        {
+            // The merged entry carries the newest version, so a reader that
+            // saw the older edit only gets a superset of what changed
+            last = {version, ux0, uy0, ux1, uy1};
+            return version;
+        }
+    }
+
+    if (count == ring.size())
+    {
+        oldestKnown = ring[head].version;
+        head = (head + 1) % ring.size();
+        --count;
+    }
+    ring[(head + count) % ring.size()] = {version, x0, y0, x1, y1};
+    ++count;
+    return version;
+}
+
+bool MapJournal::changesSince(std::uint64_t sinceVersion, std::vector<MapChange>& out) const
+{
+    if (sinceVersion < oldestKnown)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const MapChange& change = ring[(head + i) % ring.size()];
+        if (change.version > sinceVersion)
+        {
+            out.push_back(change);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#include "MapPyramid.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // Max of the (up to) 2x2 cells of src below coarse cell (cx, cy)
+    std::uint8_t pooledValue(const TiledGrid& src, int cx, int cy)
+    {
+        const int x0 = cx * 2;
+        const int y0 = cy * 2;
+        const int x1 = std::min(x0 + 1, src.getWidth() - 1);
+        const int y1 = std::min(y0 + 1, src.getHeight() - 1);
+        std::uint8_t value = src.get(x0, y0);
+        value = std::max(value, src.get(x1, y0));
+        value = std::max(value, src.get(x0, y1));
+        value = std::max(value, src.get(x1, y1));
+        return value;
+    }
+}
+
+MapPyramid::MapPyramid(const MapPyramid& other)
+{
+    std::lock_guard<std::mutex> lk(other.mu);
+    levels = other.levels;
+    built = other.built;
+}
+
+MapPyramid& MapPyramid::operator=(const MapPyramid& other)
+{
+    if (this != &other)
+    {
+        std::scoped_lock lk(mu, other.mu);
+        levels = other.levels;
+        built = other.built;
+    }
+    return *this;
+}
+
+int MapPyramid::levelCount(int baseWidth, int baseHeight)
+{
+    int count = 1;
+    while (baseWidth > 1 || baseHeight > 1)
+    {
+        baseWidth = (baseWidth + 1) / 2;
+        baseHeight = (baseHeight + 1) / 2;
+        ++count;
+    }
+    return count;
+}
+
+const TiledGrid& MapPyramid::level(const TiledGrid& base, int level) const
+{
+    std::lock_guard<std::mutex> lk(mu);
+    if (!built)
+    {
+        build(base);
+    }
+    if (level < 1 || level > static_cast<int>(levels.size()))
+    {
+        throw std::out_of_range("Pyramid level is out of range");
+    }
+    return levels[level - 1];
+}
+
+void MapPyramid::update(const TiledGrid& base, int x, int y)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    if (!built)
+    {
+        return;
+    }
+    const TiledGrid* below = &base;
+    for (auto& coarse : levels)
+    {
+        x >>= 1;
+        y >>= 1;
+        std::uint8_t value = pooledValue(*below, x, y);
+        if (coarse.get(x, y) == value)
+        {
+            break; // nothing above can change either
+        }
+        coarse.set(x, y, value);
+        below = &coarse;
+    }
+}
+
+void MapPyramid::invalidate()
+{
+    std::lock_guard<std::mutex> lk(mu);
+    levels.clear();
+    built = false;
+}
+
+void MapPyramid::build(const TiledGrid& base) const
+{
+    levels.clear();
+    const TiledGrid* below = &base;
+    while (below->getWidth() > 1 || below->getHeight() > 1)
+    {
+        levels.push_back(downsample(*below));
+        below = &levels.back();
+    }
+    built = true;
+}
+
+TiledGrid MapPyramid::downsample(const TiledGrid& src)
+{
+    TiledGrid dst((src.getWidth() + 1) / 2, (src.getHeight() + 1) / 2, 0, src.getLayout());
+
+    for (int ty = 0; ty < dst.getTilesY(); ++ty)
+    {
+        for (int tx = 0; tx < dst.getTilesX(); ++tx)
+        {
+            // A coarse tile covers 2x2 source tiles; if those are all uniform
+            // with one value the coarse tile is uniform too
+            bool uniform = true;
+            int uniformValue = -1;
+            for (int sy = ty * 2; sy < std::min(ty * 2 + 2, src.getTilesY()) && uniform; ++sy)
+            {
+                for (int sx = tx * 2; sx < std::min(tx * 2 + 2, src.getTilesX()); ++sx)
+                {
+                    int srcTile = sy * src.getTilesX() + sx;
+                    if (!src.isTileUniform(srcTile) ||
+                        (uniformValue >= 0 && uniformValue != src.getTileValue(srcTile)))
+                    {
+                        uniform = false;
+                        break;
+                    }
+                    uniformValue = src.getTileValue(srcTile);
+                }
+            }
+
+            int dstTile = ty * dst.getTilesX() + tx;
+            if (uniform)
+            {
+                dst.setTileValue(dstTile, static_cast<std::uint8_t>(uniformValue));
+                continue;
+            }
+
+            const int x0 = tx * TiledGrid::TILE_SIZE;
+            const int y0 = ty * TiledGrid::TILE_SIZE;
+            const int x1 = std::min(x0 + TiledGrid::TILE_SIZE, dst.getWidth());
+            const int y1 = std::min(y0 + TiledGrid::TILE_SIZE, dst.getHeight());
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = x0; x < x1; ++x)
+                {
+                    dst.set(x, y, pooledValue(src, x, y));
+                }
+            }
+        }
+    }
+    return dst;
+}
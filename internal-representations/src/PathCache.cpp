@@ -0,0 +1,184 @@
+#include "PathCache.h"
+#include "Map.h"
+#include <functional>
+
+bool PathCache::Key::operator==(const Key& other) const
+{
+    return mapId == other.mapId && version == other.version && start == other.start &&
+           goal == other.goal && connectivity == other.connectivity;
+}
+
+std::size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+    std::uint64_t h = key.mapId * 0x9E3779B97F4A7C15ULL;
+    auto mix = [&h](std::uint64_t v) { h = (h ^ v) * 0x100000001B3ULL; };
+    mix(key.version);
+    mix(static_cast<std::uint32_t>(key.start.first));
+    mix(static_cast<std::uint32_t>(key.start.second));
+    mix(static_cast<std::uint32_t>(key.goal.first));
+    mix(static_cast<std::uint32_t>(key.goal.second));
+    mix(static_cast<std::uint64_t>(key.connectivity));
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+PathCache::PathCache(std::size_t capacity)
+    : capacity(capacity)
+{
+}
+
+PathCache& PathCache::instance()
+{
+    // Never destroyed: maps held in static storage forget themselves here
+    // when they are destroyed at exit
+    static PathCache* cache = new PathCache();
+    return *cache;
+}
+
+PathCache::Key PathCache::makeKey(const Map& map, GridPoint start, GridPoint goal, int connectivity)
+{
+    return Key{map.getInstanceId(), map.getVersion(), start, goal, connectivity};
+}
+
+bool PathCache::findPath(const Key& key, CompactPath& path, int& cost)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    Entry* entry = lookup(key);
+    if (!entry || !entry->hasPath)
+    {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    path = entry->path;
+    cost = entry->cost;
+    return true;
+}
+
+bool PathCache::findDistance(const Key& key, int& cost)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    Entry* entry = lookup(key);
+    if (!entry)
+    {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    cost = entry->cost;
+    return true;
+}
+
+void PathCache::storePath(const Key& key, const CompactPath& path, int cost)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    observeVersion(key);
+    if (key.version < latestVersion[key.mapId]) return; // planned on a map that has moved on
+    insert(Entry{key, path, cost, true});
+}
+
+void PathCache::storeDistance(const Key& key, int cost)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    observeVersion(key);
+    if (key.version < latestVersion[key.mapId]) return;
+    if (lookup(key)) return; // keep the existing entry, it may carry a path
+    insert(Entry{key, {}, cost, false});
+}
+
+void PathCache::forgetMap(std::uint64_t mapId)
+{
+    std::lock_guard<std::mutex> lk(mu);
+    if (latestVersion.erase(mapId) == 0) return; // never seen
+    for (auto e = entries.begin(); e != entries.end();)
+    {
+        if (e->key.mapId == mapId)
+        {
+            index.erase(e->key);
+            e = entries.erase(e);
+        }
+        else
+        {
+            ++e;
+        }
+    }
+}
+
+PathCache::Stats PathCache::getStats() const
+{
+    std::lock_guard<std::mutex> lk(mu);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = entries.size();
+    stats.capacity = capacity;
+    for (const Entry& entry : entries)
+    {
+        stats.pathBytes += entry.path.memoryBytes();
+    }
+    return stats;
+}
+
+void PathCache::clear()
+{
+    std::lock_guard<std::mutex> lk(mu);
+    entries.clear();
+    index.clear();
+    latestVersion.clear();
+    hits = 0;
+    misses = 0;
+}
+
+PathCache::Entry* PathCache::lookup(const Key& key)
+{
+    observeVersion(key);
+    auto it = index.find(key);
+    if (it == index.end())
+    {
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    return &entries.front();
+}
+
+void PathCache::insert(Entry entry)
+{
+    if (capacity == 0) return;
+
+    auto it = index.find(entry.key);
+    if (it != index.end())
+    {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    while (entries.size() >= capacity)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(std::move(entry));
+    index.emplace(entries.front().key, entries.begin());
+}
+
+void PathCache::observeVersion(const Key& key)
+{
+    auto [it, inserted] = latestVersion.try_emplace(key.mapId, key.version);
+    if (inserted || key.version <= it->second)
+    {
+        return;
+    }
+
+    // The map changed: nothing cached for its older versions can be hit again
+    it->second = key.version;
+    for (auto e = entries.begin(); e != entries.end();)
+    {
+        if (e->key.mapId == key.mapId)
+        {
+            index.erase(e->key);
+            e = entries.erase(e);
+        }
+        else
+        {
+            ++e;
+        }
+    }
+}
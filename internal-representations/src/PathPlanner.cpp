@@ -0,0 +1,166 @@
+#include "PathPlanner.h"
+#include "AnyAnglePlanner.h"
+#include "JumpPointSearch.h"
+#include "Map.h"
+#include "GridSearch.h"
+#include <algorithm>
+#include <cstdlib>
+
+bool parsePlannerAlgorithm(const std::string& name, PlannerAlgorithm& out)
+{
+    if (name == "dijkstra")
+    {
+        out = PlannerAlgorithm::Dijkstra;
+        return true;
+    }
+    if (name == "astar")
+    {
+        out = PlannerAlgorithm::AStar;
+        return true;
+    }
+    if (name == "alt")
+    {
+        out = PlannerAlgorithm::Landmark;
+        return true;
+    }
+    if (name == "jps")
+    {
+        out = PlannerAlgorithm::JumpPoint;
+        return true;
+    }
+    if (name == "hpa")
+    {
+        out = PlannerAlgorithm::Hierarchical;
+        return true;
+    }
+    if (name == "theta")
+    {
+        out = PlannerAlgorithm::AnyAngle;
+        return true;
+    }
+    if (name == "dstar")
+    {
+        out = PlannerAlgorithm::Incremental;
+        return true;
+    }
+    if (name == "flow")
+    {
+        out = PlannerAlgorithm::FlowField;
+        return true;
+    }
+    return false;
+}
+
+const char* plannerAlgorithmName(PlannerAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case PlannerAlgorithm::AStar: return "astar";
+        case PlannerAlgorithm::Landmark: return "alt";
+        case PlannerAlgorithm::JumpPoint: return "jps";
+        case PlannerAlgorithm::Hierarchical: return "hpa";
+        case PlannerAlgorithm::AnyAngle: return "theta";
+        case PlannerAlgorithm::Incremental: return "dstar";
+        case PlannerAlgorithm::FlowField: return "flow";
+        case PlannerAlgorithm::Dijkstra: break;
+    }
+    return "dijkstra";
+}
+
+int octileDistance(GridPoint a, GridPoint b)
+{
+    int dx = std::abs(a.first - b.first);
+    int dy = std::abs(a.second - b.second);
+    // 10 per straight step plus 4 extra for each step that is diagonal
+    return 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+}
+
+PlanResult planPath(const Map& map, GridPoint start, GridPoint goal, PlannerAlgorithm algorithm)
+{
+    if (algorithm == PlannerAlgorithm::JumpPoint)
+    {
+        return jumpPointSearch(map, start, goal);
+    }
+    if (algorithm == PlannerAlgorithm::Hierarchical)
+    {
+        return map.planHierarchical(start, goal);
+    }
+    if (algorithm == PlannerAlgorithm::AnyAngle)
+    {
+        return lazyThetaStar(map, start, goal);
+    }
+    if (algorithm == PlannerAlgorithm::Incremental)
+    {
+        return map.planIncremental(start, goal);
+    }
+    // A field is dense over the whole map, so where one does not fit the
+    // map's field cache the query runs as plain A* instead
+    if (algorithm == PlannerAlgorithm::FlowField && !FlowFieldSet::fits(map.getWidth(), map.getHeight()))
+    {
+        algorithm = PlannerAlgorithm::AStar;
+    }
+    if (algorithm == PlannerAlgorithm::FlowField)
+    {
+        if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+        {
+            return PlanResult();
+        }
+        return map.getFlowField(goal)->path(start);
+    }
+
+    PlanResult result;
+    const TiledGrid& grid = map.getGrid();
+
+    // The start only has to be on the map: a robot standing on a cell that has
+    // since been marked as an obstacle can still drive off it
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return result;
+    }
+
+    // Landmark fields may need a (re)build, which uses the workspace too.
+    // While another thread rebuilds them the query runs as plain A*.
+    std::shared_ptr<const LandmarkTable> landmarks;
+    if (algorithm == PlannerAlgorithm::Landmark)
+    {
+        landmarks = map.getLandmarks();
+    }
+
+    // search state, reused across queries on this thread
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+    SearchStats stats;
+    if (landmarks)
+    {
+        LandmarkTable::Bound bound(*landmarks, goal);
+        auto heuristic = [&](int x, int y) { return std::max(octileDistance({x, y}, goal), bound(x, y)); };
+        if (landmarks->isConsistent() && map.isAccessible(start.first, start.second))
+        {
+            stats = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, start, goal, heuristic);
+        }
+        else
+        {
+            // No landmark sees a blocked start, so the bound jumps on the
+            // first step by more than the bucket window allows; coarse
+            // fields jump between blocks anywhere, and their cells may need
+            // reopening
+            stats = searchGrid<RobotNeighbourhood, RobotCost, BinaryHeapQueue>(grid, ws, start, goal, heuristic);
+        }
+    }
+    else if (algorithm == PlannerAlgorithm::AStar || algorithm == PlannerAlgorithm::Landmark)
+    {
+        stats = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, start, goal,
+            [&](int x, int y) { return octileDistance({x, y}, goal); });
+    }
+    else
+    {
+        stats = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, start, goal,
+            [](int, int) { return 0; });
+    }
+
+    result.expanded = stats.expanded;
+    if (stats.goalCost == SearchWorkspace::UNREACHED) return result; // unreachable
+
+    result.path = CompactPath(readPath(ws, start, goal));
+    result.cost = stats.goalCost;
+    return result;
+}
@@ -2,14 +2,15 @@
 #include "Map.h"
 #include "SimulationLogger.h"
 #include "ModuleManager.h"
+#include "PathPlanner.h"
+#include "PathCache.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
 #include <cmath>
-#include <queue>
-#include <limits>
+#include <cstdlib>
 
 namespace {
     std::string escapeString(const std::string& input)
@@ -381,113 +382,107 @@ std::vector<Robot> Robot::deserializeList(const std::string& data) {
     return robots;
 }
 
-void Robot::pathfind(const Map& map, const std::vector<float>& target)
+void Robot::pathfind(const Map& map, const std::vector<float>& target, PlannerAlgorithm algorithm)
 {
-    if (target.size() < 2) return;
+    followRoute(map, planRoute(map, target, algorithm));
+}
+
+Robot::Route Robot::planRoute(const Map& map, const std::vector<float>& target, PlannerAlgorithm algorithm) const
+{
+    Route route;
+    if (target.size() < 2) return route;
 
     // Convert to grid
-    std::pair<int, int> start = getGridPosition();
-    int goalX = static_cast<int>(std::round(target[0]));
-    int goalY = static_cast<int>(std::round(target[1]));
+    route.start = getGridPosition();
+    route.goal = {static_cast<int>(std::round(target[0])), static_cast<int>(std::round(target[1]))};
+    const int goalX = route.goal.first;
+    const int goalY = route.goal.second;
 
     if (goalX < 0 || goalX >= map.getWidth() || goalY < 0 || goalY >= map.getHeight()) {
-        SimulationLogger simlog("simulation.log");
-        simlog.log("WARNING: Pathfind failed - Target out of bounds for robot " + id);
-        return;
+        route.status = Route::Status::OutOfBounds;
+        return route;
     }
     if (!map.isAccessible(goalX, goalY)) {
-        SimulationLogger simlog("simulation.log");
-        simlog.log("WARNING: Pathfind failed - Target is an obstacle for robot " + id);
-        return;
+        route.status = Route::Status::Obstacle;
+        return route;
     }
-    if (start.first == goalX && start.second == goalY) {
-        SimulationLogger simlog("simulation.log");
-        simlog.log("INFO: Robot " + id + " already at target");
-        return;
+    if (route.start == route.goal) {
+        route.status = Route::Status::AtTarget;
+        return route;
     }
-
-    const int width = map.getWidth();
-    const int height = map.getHeight();
-    const int total = width * height;
-
-    // Create a simulation logger instance (append to simulation.log)
-    SimulationLogger simlog("simulation.log");
-    simlog.logPlannerStart(id, name, this->getGridPosition().first, this->getGridPosition().second, goalX, goalY, width, height);
-
-    auto indexOf = [width](int x, int y) { return y * width + x; };
-
-    // dijkstra structs
-    std::vector<int> dist(total, std::numeric_limits<int>::max());
-    std::vector<int> prev(total, -1);
-
-    struct Node { int cost; int x; int y; };
-    struct Cmp { bool operator()(const Node& a, const Node& b) const { return a.cost > b.cost; } };
-    std::priority_queue<Node, std::vector<Node>, Cmp> pq;
-
-    int sx = start.first;
-    int sy = start.second;
-    dist[indexOf(sx, sy)] = 0;
-    pq.push({0, sx, sy});
-
-    // 8 directional movement (including diagonals)
-    const int dx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
-    const int dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
-    const int cost[8] = {10, 10, 10, 10, 14, 14, 14, 14}; // 10 for cardinal, 14 for diagonal (approx sqrt(2)*10)
-
-    while (!pq.empty())
+    // Component labels settle this without a search that floods everything
+    // the robot can reach
+    if (!map.isReachable(route.start, route.goal)) {
+        route.status = Route::Status::Unreachable;
+        return route;
+    }
+    route.status = Route::Status::Planned;
+
+    // Exact planners all return a minimum-cost path, so they can share cached
+    // results; HPA* and any-angle paths are not grid-optimal and are never
+    // cached, and a flow field read is as cheap as a cache hit (on maps too
+    // large for a field, planPath runs A* instead)
+    const bool cacheable = algorithm != PlannerAlgorithm::Hierarchical && algorithm != PlannerAlgorithm::AnyAngle &&
+                           (algorithm != PlannerAlgorithm::FlowField ||
+                            !FlowFieldSet::fits(map.getWidth(), map.getHeight()));
+    const PathCache::Key cacheKey = PathCache::makeKey(map, route.start, route.goal, 8);
+    if (!cacheable || !PathCache::instance().findPath(cacheKey, route.plan.path, route.plan.cost))
     {
-        Node cur = pq.top();
-        pq.pop();
-
-        // Log expansion
-        int parentX = -1, parentY = -1;
-        int curIdx = indexOf(cur.x, cur.y);
-        if (prev[curIdx] != -1) { parentX = prev[curIdx] % width; parentY = prev[curIdx] / width; }
-        // simlog.logExpandNode(id, cur.x, cur.y, cur.cost, parentX, parentY);
-
-        if (cur.x == goalX && cur.y == goalY) break;
-
-        int curIdx2 = indexOf(cur.x, cur.y);
-        if (cur.cost != dist[curIdx2]) continue; // stale
+        // D* Lite searches follow one robot, so its moves keep them cheap
+        route.plan = algorithm == PlannerAlgorithm::Incremental ? map.planIncremental(route.start, route.goal, id)
+                                                                : planPath(map, route.start, route.goal, algorithm);
+        if (cacheable) PathCache::instance().storePath(cacheKey, route.plan.path, route.plan.cost);
+    }
+    return route;
+}
 
-        for (int dir = 0; dir < 8; ++dir)
-        {
-            int nx = cur.x + dx[dir];
-            int ny = cur.y + dy[dir];
-            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
-            if (!map.isAccessible(nx, ny)) continue;
-
-            int nIdx = indexOf(nx, ny);
-            int nCost = cur.cost + cost[dir];
-            if (nCost < dist[nIdx])
-            {
-                dist[nIdx] = nCost;
-                prev[nIdx] = curIdx;
-                pq.push({nCost, nx, ny});
-                // simlog.logPushNode(id, nx, ny, nCost);
-            }
+void Robot::followRoute(const Map& map, const Route& route)
+{
+    switch (route.status)
+    {
+        case Route::Status::NoTarget:
+            return;
+        case Route::Status::OutOfBounds: {
+            SimulationLogger simlog("simulation.log");
+            simlog.log("WARNING: Pathfind failed - Target out of bounds for robot " + id);
+            return;
+        }
+        case Route::Status::Obstacle: {
+            SimulationLogger simlog("simulation.log");
+            simlog.log("WARNING: Pathfind failed - Target is an obstacle for robot " + id);
+            return;
+        }
+        case Route::Status::Unreachable: {
+            SimulationLogger simlog("simulation.log");
+            simlog.log("WARNING: Pathfind failed - Target is not reachable for robot " + id);
+            return;
+        }
+        case Route::Status::AtTarget: {
+            SimulationLogger simlog("simulation.log");
+            simlog.log("INFO: Robot " + id + " already at target");
+            return;
         }
+        case Route::Status::Planned:
+            break;
     }
 
-    // Reconstruct path
-    int goalIdx = indexOf(goalX, goalY);
-    if (prev[goalIdx] == -1) return; // unreachable
+    // Create a simulation logger instance (append to simulation.log)
+    SimulationLogger simlog("simulation.log");
+    simlog.logPlannerStart(id, name, route.start.first, route.start.second, route.goal.first, route.goal.second,
+                           map.getWidth(), map.getHeight());
 
-    std::vector<std::pair<int,int>> path;
-    for (int at = goalIdx; at != -1; at = prev[at])
-    {
-        int x = at % width;
-        int y = at / width;
-        path.emplace_back(x, y);
-    }
-    std::reverse(path.begin(), path.end());
+    if (route.plan.path.empty()) return; // unreachable
+    const CompactPath& path = route.plan.path;
+    const std::vector<GridPoint>& waypoints = route.plan.waypoints;
 
     simlog.logPathReconstructed(id, path);
 
-    // Move along the path
-    for (size_t i = 1; i < path.size(); ++i)
+    // Move along the path, decoding it one step at a time
+    std::size_t nextWaypoint = 1;
+    std::size_t i = 1;
+    for (auto it = path.begin() + 1; it != path.end(); ++it, ++i)
     {
-        const auto& step = path[i];
+        const GridPoint step = *it;
         if (!moveToGrid(step.first, step.second, map))
         {
             // If a step becomes invalid stop
@@ -495,23 +490,32 @@ void Robot::pathfind(const Map& map, const std::vector<float>& target)
             break;
         }
 
-        // Log every 10th move to reduce log verbosity
-        if (i % 10 == 0 || i == path.size() - 1) {
+        // Log every 10th move to reduce log verbosity; the turns of an
+        // any-angle path are always logged
+        const bool waypoint = nextWaypoint < waypoints.size() && step == waypoints[nextWaypoint];
+        if (waypoint) ++nextWaypoint;
+        if (i % 10 == 0 || i == path.size() - 1 || waypoint) {
             simlog.logMoveExecuted(id, step.first, step.second);
         }
     }
 }
 
 // Pathfind with task module invocation
-void Robot::pathfind(const Map& map, const std::vector<float>& target, const std::vector<std::string>& taskModules)
+void Robot::pathfind(const Map& map, const std::vector<float>& target, const std::vector<std::string>& taskModules,
+                     PlannerAlgorithm algorithm)
 {
     // Store task modules
     currentTaskModules = taskModules;
 
     // Execute normal pathfinding
-    pathfind(map, target);
+    pathfind(map, target, algorithm);
 
     // After reaching destination, invoke all task modules
+    invokeTaskModules();
+}
+
+void Robot::invokeTaskModules()
+{
     if (!currentTaskModules.empty()) {
         // Build context JSON for the plugin
         std::ostringstream context;
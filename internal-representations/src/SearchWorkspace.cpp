@@ -0,0 +1,62 @@
+#include "SearchWorkspace.h"
+#include <algorithm>
+
+int SearchWorkspace::directionOf(int dx, int dy)
+{
+    for (int dir = 0; dir < 8; ++dir)
+    {
+        if (DX[dir] == dx && DY[dir] == dy)
+        {
+            return dir;
+        }
+    }
+    return 0;
+}
+
+SearchWorkspace& SearchWorkspace::acquire(const TiledGrid& grid, int slot)
+{
+    thread_local SearchWorkspace workspaces[SLOTS];
+    SearchWorkspace& workspace = workspaces[slot];
+    workspace.reset(grid);
+    return workspace;
+}
+
+void SearchWorkspace::reset(const TiledGrid& target)
+{
+    grid = &target;
+    if (allocated > MAX_RETAINED_TILES)
+    {
+        // Each thread keeps its workspaces for good, so one flood over a
+        // huge map must not pin gigabytes; the next query reallocates
+        // only what it touches
+        blocks.clear();
+        blocks.shrink_to_fit();
+        allocated = 0;
+    }
+    // Blocks are indexed by tile, so a larger map only adds slots; cells from
+    // earlier queries (on any map) are stale by generation
+    if (blocks.size() < target.getTileCount())
+    {
+        blocks.resize(target.getTileCount());
+    }
+    if (++generation > MAX_GENERATION)
+    {
+        for (auto& block : blocks)
+        {
+            if (block) std::fill(std::begin(block->tag), std::end(block->tag), 0u);
+        }
+        generation = 1;
+    }
+}
+
+SearchWorkspace::Block& SearchWorkspace::blockFor(int tile)
+{
+    auto& slot = blocks[tile];
+    if (!slot)
+    {
+        slot = std::make_unique<Block>();
+        std::fill(std::begin(slot->tag), std::end(slot->tag), 0u);
+        ++allocated;
+    }
+    return *slot;
+}
@@ -63,7 +63,7 @@ void SimulationLogger::logPushNode(const std::string& robotId, int x, int y, int
     writeLine(timestamp() + " " + ss.str());
 }
 
-void SimulationLogger::logPathReconstructed(const std::string& robotId, const std::vector<std::pair<int,int>>& path)
+void SimulationLogger::logPathReconstructed(const std::string& robotId, const CompactPath& path)
 {
     std::ostringstream ss;
     ss << "PATH robotId=\"" << robotId << "\" size=" << path.size();
@@ -0,0 +1,344 @@
+#include "SpaceTimePlanner.h"
+#include "FlowField.h"
+#include "GridSearch.h"
+#include "Map.h"
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <tuple>
+
+namespace {
+    constexpr int WAIT_COST = 10;
+    constexpr int WAIT = 8; // move code for staying put, after the eight moves
+    constexpr std::size_t MAX_EXPANSIONS = 2000000; // per agent, before giving up
+
+    // Reverse Resumable A*-style heuristic: a Dijkstra from the goal over free
+    // cells that only expands until the queried cell is settled, then pauses.
+    // Settled cells carry direction 1 in the workspace, open ones 0.
+    class ReverseDistance
+    {
+    public:
+        ReverseDistance(const TiledGrid& grid, GridPoint goal)
+            : grid(grid), ws(SearchWorkspace::acquire(grid, 1)), open(RobotCost::MAX_STEP)
+        {
+            ws.set(goal.first, goal.second, 0, 0);
+            open.push({0, 0, goal.first, goal.second});
+        }
+
+        // Exact static distance from (x, y) to the goal, UNREACHED if none
+        int operator()(int x, int y)
+        {
+            TiledGrid::CellRef target = grid.ref(x, y);
+            while (!isSettled(target))
+            {
+                if (open.empty()) return SearchWorkspace::UNREACHED;
+                expandNext();
+            }
+            return ws.getDist(target);
+        }
+
+    private:
+        const TiledGrid& grid;
+        SearchWorkspace& ws;
+        BucketQueue open;
+
+        bool isSettled(TiledGrid::CellRef cell) const
+        {
+            return ws.getDist(cell) != SearchWorkspace::UNREACHED && ws.getDirection(cell) == 1;
+        }
+
+        void expandNext()
+        {
+            SearchNode cur = open.pop();
+            TiledGrid::CellRef curRef = grid.ref(cur.x, cur.y);
+            if (cur.cost != ws.getDist(curRef) || ws.getDirection(curRef) == 1) return; // stale
+            ws.set(curRef, cur.cost, 1);
+
+            for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+            {
+                int nx = cur.x + SearchWorkspace::DX[dir];
+                int ny = cur.y + SearchWorkspace::DY[dir];
+                if (nx < 0 || nx >= grid.getWidth() || ny < 0 || ny >= grid.getHeight()) continue;
+                TiledGrid::CellRef nRef = grid.neighbour(curRef, cur.x, cur.y, SearchWorkspace::DX[dir], SearchWorkspace::DY[dir]);
+                if (grid.get(nRef) != 0) continue;
+                int nCost = cur.cost + RobotCost::step(dir);
+                if (nCost < ws.getDist(nRef))
+                {
+                    ws.set(nRef, nCost, 0);
+                    open.push({nCost, nCost, nx, ny});
+                }
+            }
+        }
+    };
+
+    struct StateKey
+    {
+        static std::uint64_t of(int x, int y, int t)
+        {
+            return (static_cast<std::uint64_t>(t) << 42) | (static_cast<std::uint64_t>(y) << 21) |
+                   static_cast<std::uint64_t>(x);
+        }
+    };
+
+    struct OpenState
+    {
+        int f;
+        int g;
+        int conflicts; // with the soft reservations, along the way here
+        int x;
+        int y;
+        int t;
+    };
+
+    // Open states by f, then fewest conflicts, then deepest; focal states by
+    // fewest conflicts, then f, then deepest. Ties fall to the state id.
+    using OpenKey = std::tuple<int, int, int, int>;
+
+    struct Visit
+    {
+        int g;
+        int conflicts;
+        std::uint64_t parent;
+        int state; // index of its entry in the open and focal lists
+    };
+
+    constexpr std::size_t DEADLINE_CHECK = 1024; // expansions between clock reads
+}
+
+void ReservationTable::reserveCell(GridPoint cell, int t)
+{
+    cells.insert(key(cell, t));
+    int& last = latest[key(cell, 0)];
+    last = std::max(last, t);
+}
+
+void ReservationTable::blockMove(GridPoint from, GridPoint to, int t)
+{
+    int dir = SearchWorkspace::directionOf(to.first - from.first, to.second - from.second);
+    moves[key(from, t)] |= static_cast<std::uint8_t>(1u << dir);
+}
+
+void ReservationTable::park(GridPoint cell, int fromTime)
+{
+    auto [it, inserted] = parkedFrom.try_emplace(key(cell, 0), fromTime);
+    if (!inserted) it->second = std::min(it->second, fromTime);
+}
+
+void ReservationTable::reservePath(const TimedPath& path)
+{
+    for (std::size_t t = 0; t < path.size(); ++t)
+    {
+        reserveCell(path[t], static_cast<int>(t));
+        if (t + 1 < path.size() && path[t + 1] != path[t])
+        {
+            blockMove(path[t + 1], path[t], static_cast<int>(t));
+        }
+    }
+    if (!path.empty())
+    {
+        park(path.back(), static_cast<int>(path.size()) - 1);
+    }
+}
+
+bool ReservationTable::isCellFree(GridPoint cell, int t) const
+{
+    auto parked = parkedFrom.find(key(cell, 0));
+    if (parked != parkedFrom.end() && parked->second <= t) return false;
+    return cells.find(key(cell, t)) == cells.end();
+}
+
+bool ReservationTable::isMoveFree(GridPoint from, GridPoint to, int t) const
+{
+    auto it = moves.find(key(from, t));
+    if (it == moves.end()) return true;
+    int dir = SearchWorkspace::directionOf(to.first - from.first, to.second - from.second);
+    return (it->second & (1u << dir)) == 0;
+}
+
+int ReservationTable::lastReserved(GridPoint cell) const
+{
+    if (parkedFrom.count(key(cell, 0))) return INT_MAX;
+    auto it = latest.find(key(cell, 0));
+    return it == latest.end() ? -1 : it->second;
+}
+
+void ReservationTable::clear()
+{
+    cells.clear();
+    moves.clear();
+    parkedFrom.clear();
+    latest.clear();
+}
+
+TimedPath planSpaceTime(const Map& map, GridPoint start, GridPoint goal, const ReservationTable& table,
+                        const ReservationTable* avoid, const SpaceTimeOptions& options, SpaceTimeStats* stats)
+{
+    if (stats) *stats = {};
+    if (!map.isValidPosition(start.first, start.second) || !map.isAccessible(goal.first, goal.second))
+    {
+        return {};
+    }
+
+    const TiledGrid& grid = map.getGrid();
+    std::optional<ReverseDistance> reverse;
+    if (!options.distances) reverse.emplace(grid, goal);
+    auto h = [&](int x, int y) { return options.distances ? options.distances->distance({x, y}) : (*reverse)(x, y); };
+
+    // A blocked start is not reached by the reverse search; bound it by its
+    // best free neighbour instead
+    int startH = map.isAccessible(start.first, start.second) ? h(start.first, start.second) : SearchWorkspace::UNREACHED;
+    if (startH == SearchWorkspace::UNREACHED && start == goal) startH = 0;
+    if (startH == SearchWorkspace::UNREACHED)
+    {
+        for (int dir = 0; dir < RobotNeighbourhood::MOVES; ++dir)
+        {
+            int nx = start.first + SearchWorkspace::DX[dir];
+            int ny = start.second + SearchWorkspace::DY[dir];
+            if (!map.isAccessible(nx, ny)) continue;
+            int hn = h(nx, ny);
+            if (hn != SearchWorkspace::UNREACHED) startH = std::min(startH, hn + RobotCost::step(dir));
+        }
+        if (startH == SearchWorkspace::UNREACHED) return {};
+    }
+    const int goalFreeAfter = table.lastReserved(goal);
+    if (goalFreeAfter == INT_MAX) return {}; // someone parks on the goal
+    const int maxTime = options.maxTime >= 0 ? options.maxTime : std::max(2 * (startH / 10), goalFreeAfter) + 64;
+    const double suboptimality = std::max(options.suboptimality, 1.0);
+    const bool useFocal = suboptimality > 1.0;
+
+    std::vector<OpenState> states;
+    std::set<OpenKey> open;
+    std::set<OpenKey> focal; // open states with f within focalBound, when useFocal
+    int focalBound = -1;
+    auto openKey = [&states](int id) { return OpenKey{states[id].f, states[id].conflicts, -states[id].g, id}; };
+    auto focalKey = [&states](int id) { return OpenKey{states[id].conflicts, states[id].f, -states[id].g, id}; };
+    auto push = [&](const OpenState& state) {
+        const int id = static_cast<int>(states.size());
+        states.push_back(state);
+        open.insert(openKey(id));
+        if (useFocal && state.f <= focalBound) focal.insert(focalKey(id));
+        return id;
+    };
+    auto drop = [&](int id) {
+        open.erase(openKey(id));
+        if (useFocal && states[id].f <= focalBound) focal.erase(focalKey(id));
+    };
+
+    std::unordered_map<std::uint64_t, Visit> visited;
+    const std::uint64_t startKey = StateKey::of(start.first, start.second, 0);
+    visited[startKey] = {0, 0, startKey, push({startH, 0, 0, start.first, start.second, 0})};
+
+    std::uint64_t goalKey = 0;
+    bool found = false;
+    std::size_t expansions = 0;
+    while (!open.empty() && expansions < MAX_EXPANSIONS)
+    {
+        if (expansions % DEADLINE_CHECK == 0 && std::chrono::steady_clock::now() >= options.deadline) break;
+        const int fMin = std::get<0>(*open.begin());
+        if (stats) stats->lowerBound = fMin;
+        int id;
+        if (useFocal)
+        {
+            // The cheapest open state only ever gets dearer, so the bound grows
+            const int bound = static_cast<int>(fMin * suboptimality);
+            if (bound > focalBound)
+            {
+                for (auto it = open.lower_bound({focalBound + 1, INT_MIN, INT_MIN, INT_MIN});
+                     it != open.end() && std::get<0>(*it) <= bound; ++it)
+                {
+                    focal.insert(focalKey(std::get<3>(*it)));
+                }
+                focalBound = bound;
+            }
+            id = std::get<3>(*focal.begin());
+        }
+        else
+        {
+            id = std::get<3>(*open.begin());
+        }
+        drop(id);
+        const OpenState cur = states[id];
+        const std::uint64_t curKey = StateKey::of(cur.x, cur.y, cur.t);
+        ++expansions;
+
+        if (cur.x == goal.first && cur.y == goal.second && cur.t > goalFreeAfter)
+        {
+            goalKey = curKey;
+            found = true;
+            break;
+        }
+        if (cur.t >= maxTime) continue;
+
+        for (int dir = 0; dir <= WAIT; ++dir)
+        {
+            const int nx = dir == WAIT ? cur.x : cur.x + SearchWorkspace::DX[dir];
+            const int ny = dir == WAIT ? cur.y : cur.y + SearchWorkspace::DY[dir];
+            const int nt = cur.t + 1;
+            if (!map.isAccessible(nx, ny)) continue; // no waiting on a blocked start either
+            if (!table.isCellFree({nx, ny}, nt)) continue;
+            if (dir != WAIT && !table.isMoveFree({cur.x, cur.y}, {nx, ny}, cur.t)) continue;
+
+            const int hn = (nx == start.first && ny == start.second) ? startH : h(nx, ny);
+            if (hn == SearchWorkspace::UNREACHED) continue;
+            const int ng = cur.g + (dir == WAIT ? WAIT_COST : RobotCost::step(dir));
+            int nc = cur.conflicts;
+            if (avoid && (!avoid->isCellFree({nx, ny}, nt) ||
+                          (dir != WAIT && !avoid->isMoveFree({cur.x, cur.y}, {nx, ny}, cur.t))))
+            {
+                ++nc;
+            }
+            const std::uint64_t nKey = StateKey::of(nx, ny, nt);
+            auto it = visited.find(nKey);
+            if (it != visited.end())
+            {
+                Visit& seen = it->second;
+                if (seen.g < ng || (seen.g == ng && seen.conflicts <= nc)) continue;
+                if (seen.state >= 0) drop(seen.state);
+            }
+            visited[nKey] = {ng, nc, curKey, push({ng + hn, ng, nc, nx, ny, nt})};
+        }
+        visited[curKey].state = -1; // closed
+    }
+    if (stats) stats->expanded = expansions;
+    if (!found) return {};
+
+    TimedPath path;
+    for (std::uint64_t k = goalKey;; k = visited[k].parent)
+    {
+        path.push_back({static_cast<int>(k & ((1u << 21) - 1)), static_cast<int>((k >> 21) & ((1u << 21) - 1))});
+        if (k == startKey) break;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::vector<TimedPath> planCooperative(const Map& map, const std::vector<AgentQuery>& agents,
+                                       const std::vector<GridPoint>& stationary,
+                                       std::chrono::steady_clock::time_point deadline)
+{
+    ReservationTable table;
+    for (const GridPoint& cell : stationary)
+    {
+        table.park(cell, 0);
+    }
+    for (const auto& agent : agents)
+    {
+        table.reserveCell(agent.start, 0);
+    }
+
+    std::vector<TimedPath> paths;
+    paths.reserve(agents.size());
+    for (const auto& agent : agents)
+    {
+        SpaceTimeOptions options;
+        options.deadline = deadline;
+        TimedPath path = planSpaceTime(map, agent.start, agent.goal, table, nullptr, options);
+        if (path.empty())
+        {
+            path = {agent.start}; // stays put
+        }
+        table.reservePath(path);
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
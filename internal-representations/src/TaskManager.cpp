@@ -1,5 +1,8 @@
 #include "TaskManager.h"
 #include "SimulationLogger.h"
+#include "GridSearch.h"
+#include "PathCache.h"
+#include "BatchPathfind.h"
 #include <limits>
 #include <cmath>
 #include <algorithm>
@@ -89,6 +92,23 @@ std::vector<Task> TaskManager::getPendingTasks() const
     return pendingTasks;
 }
 
+bool TaskManager::isReachableByAnyRobot(const std::vector<float>& position) const
+{
+    if (!hasValidPosition(position))
+    {
+        return false;
+    }
+    const GridPoint target = toGridPoint(position);
+    for (const auto& robot : mapRef.getRobots())
+    {
+        if (hasValidPosition(robot.position) && mapRef.isReachable(robot.getGridPosition(), target))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::optional<Task> TaskManager::getTaskById(const std::string& taskId) const
 {
     auto it = std::find_if(
@@ -163,6 +183,12 @@ std::optional<std::reference_wrapper<Robot>> TaskManager::findNearestAvailableRo
             continue;
         }
 
+        // Nearest by straight line, but never one walled off from the target
+        if (!mapRef.isReachable(robot.getGridPosition(), toGridPoint(target)))
+        {
+            continue;
+        }
+
         float distance = calculateDistance(robot.position, target);
         if (distance < bestDistance)
         {
@@ -241,11 +267,24 @@ GridPoint TaskManager::toGridPoint(const std::vector<float>& position)
     return {static_cast<int>(std::lround(position[0])), static_cast<int>(std::lround(position[1]))};
 }
 
-std::vector<GridPoint> TaskManager::computePath(GridPoint start, GridPoint goal) const
+namespace {
+    // Search bound for paths costing at most maxCost (-1: none)
+    SearchLimits costLimits(int maxCost)
+    {
+        SearchLimits limits;
+        if (maxCost >= 0 && maxCost < limits.maxCost)
+        {
+            limits.maxCost = maxCost;
+        }
+        return limits;
+    }
+}
+
+CompactPath TaskManager::computePath(GridPoint start, GridPoint goal) const
 {
     if (start == goal)
     {
-        return {start};
+        return CompactPath(start);
     }
 
     const int width = mapRef.getWidth();
@@ -253,110 +292,144 @@ std::vector<GridPoint> TaskManager::computePath(GridPoint start, GridPoint goal)
 
     if (goal.first < 0 || goal.first >= width || goal.second < 0 || goal.second >= height)
     {
-        return {};
+        return CompactPath();
     }
     if (!mapRef.isAccessible(goal.first, goal.second) || !mapRef.isAccessible(start.first, start.second))
     {
-        return {};
+        return CompactPath();
+    }
+    if (!mapRef.isReachable(start, goal))
+    {
+        return CompactPath();
     }
 
-    const int total = width * height;
-    auto indexOf = [width](int x, int y)
+    // Robots drive these paths, so this is the robots' own search (and cache
+    // entries are shared with Robot::pathfind)
+    CompactPath path;
+    int cost;
+    const PathCache::Key cacheKey = PathCache::makeKey(mapRef, start, goal, RobotNeighbourhood::MOVES);
+    if (PathCache::instance().findPath(cacheKey, path, cost))
     {
-        return y * width + x;
-    };
+        return path;
+    }
 
-    std::vector<int> dist(total, std::numeric_limits<int>::max());
-    std::vector<int> prev(total, -1);
+    // Search state is reused across queries on this thread
+    const TiledGrid& grid = mapRef.getGrid();
+    SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+    SearchStats stats = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(grid, ws, start, goal,
+        [](int, int) { return 0; });
 
-    struct Node
+    cost = -1;
+    if (stats.goalCost != SearchWorkspace::UNREACHED)
     {
-        int cost;
-        int x;
-        int y;
-    };
-    struct NodeCompare
-    {
-        bool operator()(const Node& lhs, const Node& rhs) const
-        {
-            return lhs.cost > rhs.cost;
-        }
-    };
-
-    std::priority_queue<Node, std::vector<Node>, NodeCompare> pq;
-    dist[indexOf(start.first, start.second)] = 0;
-    pq.push({0, start.first, start.second});
+        path = CompactPath(readPath(ws, start, goal));
+        cost = stats.goalCost;
+    }
+    PathCache::instance().storePath(cacheKey, path, cost);
+    return path;
+}
 
-    const int dx[4] = {1, -1, 0, 0};
-    const int dy[4] = {0, 0, 1, -1};
+int TaskManager::computePathDistance(GridPoint start, GridPoint goal, int maxCost) const
+{
+    const int unreachable = UNREACHABLE;
 
-    while (!pq.empty())
+    // Same rules as computePath, but only the distance is searched for
+    if (start == goal)
     {
-        Node cur = pq.top();
-        pq.pop();
+        return 0;
+    }
+    if (!mapRef.isAccessible(goal.first, goal.second) || !mapRef.isAccessible(start.first, start.second) ||
+        !mapRef.isReachable(start, goal))
+    {
+        return unreachable;
+    }
 
-        if (cur.x == goal.first && cur.y == goal.second)
-        {
-            break;
-        }
+    if (maxCost >= 0 && octileDistance(start, goal) > maxCost)
+    {
+        return -1;
+    }
 
-        int idx = indexOf(cur.x, cur.y);
-        if (cur.cost != dist[idx])
+    int cost;
+    const PathCache::Key cacheKey = PathCache::makeKey(mapRef, start, goal, RobotNeighbourhood::MOVES);
+    if (!PathCache::instance().findDistance(cacheKey, cost))
+    {
+        SearchStats stats = bidirectionalDistance<RobotNeighbourhood, RobotCost, BucketQueue>(
+            mapRef.getGrid(), start, goal, FreeCells(), costLimits(maxCost));
+        if (stats.goalCost == SearchLimits::EXCEEDED)
         {
-            continue;
-        }
-
-        for (int dir = 0; dir < 4; ++dir)
-        {
-            int nx = cur.x + dx[dir];
-            int ny = cur.y + dy[dir];
-            if (nx < 0 || nx >= width || ny < 0 || ny >= height)
-            {
-                continue;
-            }
-            if (!mapRef.isAccessible(nx, ny))
-            {
-                continue;
-            }
-
-            int nIdx = indexOf(nx, ny);
-            int nCost = cur.cost + 1;
-            if (nCost < dist[nIdx])
-            {
-                dist[nIdx] = nCost;
-                prev[nIdx] = idx;
-                pq.push({nCost, nx, ny});
-            }
+            return -1; // not cached: a larger bound may still find it
         }
+        cost = stats.goalCost == SearchWorkspace::UNREACHED ? -1 : stats.goalCost;
+        PathCache::instance().storeDistance(cacheKey, cost);
     }
-
-    int goalIdx = indexOf(goal.first, goal.second);
-    if (prev[goalIdx] == -1)
+    if (cost < 0)
     {
-        return {};
+        return unreachable;
     }
-
-    std::vector<GridPoint> path;
-    for (int at = goalIdx; at != -1; at = prev[at])
+    if (maxCost >= 0 && cost > maxCost)
     {
-        int x = at % width;
-        int y = at / width;
-        path.emplace_back(x, y);
+        return -1;
     }
-    std::reverse(path.begin(), path.end());
-    return path;
+    return cost;
 }
 
-int TaskManager::computePathDistance(GridPoint start, GridPoint goal) const
+std::vector<std::vector<int>> TaskManager::computeDistanceMatrix(const std::vector<GridPoint>& from,
+                                                              const std::vector<GridPoint>& to,
+                                                              int maxCost) const
 {
-    auto path = computePath(start, goal);
-    if (path.empty())
-    {
-        // Unreachable - use a large but reasonable penalty instead of INT_MAX
-        // to avoid overflow when converting to float
-        return 999999;
+    const int unreachable = UNREACHABLE; // as computePathDistance
+    std::vector<std::vector<int>> result(from.size(), std::vector<int>(to.size(), unreachable));
+
+    // Distances are symmetric between free cells, so flood from whichever
+    // side has fewer points; a blocked source reaches nothing but itself.
+    // Each flood only waits for the targets in its own component, so one
+    // walled-off target does not make it cover everything reachable.
+    const bool byRow = from.size() <= to.size();
+    const std::vector<GridPoint>& sources = byRow ? from : to;
+    const std::vector<GridPoint>& targets = byRow ? to : from;
+    std::vector<std::uint32_t> targetComponents;
+    targetComponents.reserve(targets.size());
+    for (const GridPoint& target : targets)
+    {
+        targetComponents.push_back(mapRef.getComponent(target.first, target.second));
+    }
+
+    std::vector<GridPoint> reachable;
+    std::vector<std::size_t> reachableIndex;
+    std::vector<int> field;
+    for (std::size_t s = 0; s < sources.size(); ++s)
+    {
+        const GridPoint source = sources[s];
+        const std::uint32_t component = mapRef.getComponent(source.first, source.second);
+        reachable.clear();
+        reachableIndex.clear();
+        for (std::size_t t = 0; t < targets.size(); ++t)
+        {
+            if (targets[t] == source)
+            {
+                if (byRow) result[s][t] = 0;
+                else result[t][s] = 0;
+            }
+            else if (component != ComponentLabels::NONE && targetComponents[t] == component)
+            {
+                reachable.push_back(targets[t]);
+                reachableIndex.push_back(t);
+            }
+        }
+        if (reachable.empty()) continue;
+
+        distanceField<RobotNeighbourhood, RobotCost, BucketQueue>(mapRef.getGrid(), source, reachable, field,
+                                                                  FreeCells(), costLimits(maxCost));
+        for (std::size_t k = 0; k < reachable.size(); ++k)
+        {
+            int d = field[k];
+            if (d == SearchWorkspace::UNREACHED) d = unreachable;
+            else if (d == SearchLimits::EXCEEDED) d = -1;
+            if (byRow) result[s][reachableIndex[k]] = d;
+            else result[reachableIndex[k]][s] = d;
+        }
     }
-    return static_cast<int>(path.size() - 1); // Distance is number of steps
+    return result;
 }
 
 // === Robot Availability Methods ===
@@ -396,33 +469,23 @@ std::vector<std::reference_wrapper<Robot>> TaskManager::getAvailableRobots() con
     return available;
 }
 
-float TaskManager::pathfindingCost(const Robot& robot, const Task& task) const
+double TaskManager::pathfindingCost(const Robot&, const Task& task, int distance)
 {
-    GridPoint robotPos = toGridPoint(robot.position);
-    GridPoint taskPos = toGridPoint(task.targetPosition);
-    
-    int distance = computePathDistance(robotPos, taskPos);
-    
-    // Add priority penalty (higher priority = lower cost)
-    float priorityPenalty = -task.priority * 10.0f;
+    // Add priority penalty (higher priority = lower cost), 10 cardinal steps
+    // per priority level
+    double priorityPenalty = -task.priority * 100.0;
     
-    return static_cast<float>(distance) + priorityPenalty;
+    return static_cast<double>(distance) + priorityPenalty;
 }
 
-float TaskManager::makespanCost(const Robot& robot, const Task& task) const
+double TaskManager::makespanCost(const Robot& robot, const Task& task, int distance)
 {
-    GridPoint robotPos = toGridPoint(robot.position);
-    GridPoint taskPos = toGridPoint(task.targetPosition);
+    double timeCost = distance > 0 && robot.speed > 0.0f
+        ? static_cast<double>(distance) / robot.speed
+        : static_cast<double>(distance);
 
-    int distance = computePathDistance(robotPos, taskPos);
-
-
-    float timeCost = distance > 0 && robot.speed > 0.0f
-        ? static_cast<float>(distance) / robot.speed
-        : static_cast<float>(distance);
-
-    // Add priority penalty
-    float priorityPenalty = -task.priority * 10.0f;
+    // Add priority penalty, on the scale of pathfindingCost
+    double priorityPenalty = -task.priority * 100.0;
 
     return timeCost + priorityPenalty;
 }
@@ -433,7 +496,8 @@ float TaskManager::makespanCost(const Robot& robot, const Task& task) const
 std::map<std::string, std::string> TaskManager::hungarianAssignment(
     const std::vector<Task>& tasks,
     const std::vector<std::reference_wrapper<Robot>>& robots,
-    std::function<float(const Robot&, const Task&)> costFunction
+    const std::vector<GridPoint>& robotPositions,
+    std::function<double(const Robot&, const Task&, int)> costFunction
 ) const
 {
     std::map<std::string, std::string> assignments;
@@ -446,71 +510,153 @@ std::map<std::string, std::string> TaskManager::hungarianAssignment(
     const size_t numTasks = tasks.size();
     const size_t numRobots = robots.size();
 
-    // If we have more tasks than robots, we can only assign to available robots
-    // If we have more robots than tasks, we'll create a square matrix
-    const size_t n = std::max(numTasks, numRobots);
-
-    // Build cost matrix
-    std::vector<std::vector<float>> cost(n, std::vector<float>(n, std::numeric_limits<float>::max()));
-
     SimulationLogger("simulation.log").log("DEBUG: hungarianAssignment called with " + std::to_string(numTasks) + " tasks, " + std::to_string(numRobots) + " robots");
 
-    for (size_t i = 0; i < numTasks; ++i)
-    {
-        for (size_t j = 0; j < numRobots; ++j)
+    // All task/robot path distances at once, searched only as far as twice
+    // the straight-line reach of the farthest task's nearest robot: a far
+    // task then stops every flood at the cap instead of running each over
+    // the whole connected component
+    std::vector<GridPoint> taskPositions;
+    taskPositions.reserve(numTasks);
+    int cap = 0;
+    for (const auto& task : tasks)
+    {
+        taskPositions.push_back(toGridPoint(task.targetPosition));
+        int nearest = -1;
+        for (const GridPoint& from : robotPositions)
         {
-            cost[i][j] = costFunction(robots[j].get(), tasks[i]);
-            SimulationLogger("simulation.log").log("DEBUG: cost[" + std::to_string(i) + "][" + std::to_string(j) + "] = " + std::to_string(cost[i][j]) + " (robot=" + robots[j].get().id + ", task=" + tasks[i].id + ")");
+            // Pairs in different components are settled without a search
+            if (!mapRef.isReachable(from, taskPositions.back())) continue;
+            int bound = octileDistance(from, taskPositions.back());
+            if (nearest < 0 || bound < nearest) nearest = bound;
         }
+        cap = std::max(cap, nearest);
     }
-    
-    std::vector<bool> taskAssigned(numTasks, false);
-    std::vector<bool> robotAssigned(numRobots, false);
-    
-    // Sort all possible assignments by cost
+    cap = 2 * cap + 160;
+    std::vector<std::vector<int>> distance = computeDistanceMatrix(robotPositions, taskPositions, cap);
+
+    // Pairs past the cap enter at a distance of cap + 1, a lower bound
+    // on their real cost, and are searched again (with a larger bound) only
+    // if they come up while both sides are still free. Pairs are taken in
+    // the same order as with every distance known up front. Pairs without a
+    // path come after all others, whatever the reachable costs are.
     struct Assignment
     {
         size_t taskIdx;
         size_t robotIdx;
-        float cost;
+        double cost;
+        int bound; // -1 once the distance is exact, else the cost it exceeds
+        bool reachable;
+
+        bool operator>(const Assignment& other) const
+        {
+            return reachable != other.reachable ? !reachable : cost > other.cost;
+        }
     };
-    
+    // Queue entry of a pair at distance d (a lower bound while bound >= 0)
+    auto entry = [&](size_t taskIdx, size_t robotIdx, int d, int bound) -> Assignment
+    {
+        const Robot& robot = robots[robotIdx].get();
+        const Task& task = tasks[taskIdx];
+        if (d == UNREACHABLE) return {taskIdx, robotIdx, costFunction(robot, task, 0), -1, false};
+        return {taskIdx, robotIdx, costFunction(robot, task, d), bound, true};
+    };
+
     std::vector<Assignment> allAssignments;
+    allAssignments.reserve(numTasks * numRobots);
     for (size_t i = 0; i < numTasks; ++i)
     {
         for (size_t j = 0; j < numRobots; ++j)
         {
-            allAssignments.push_back({i, j, cost[i][j]});
+            int d = distance[j][i];
+            allAssignments.push_back(d < 0 ? entry(i, j, cap + 1, cap) : entry(i, j, d, -1));
+            SimulationLogger("simulation.log").log("DEBUG: cost[" + std::to_string(i) + "][" + std::to_string(j) + "] " + (d == UNREACHABLE ? "unreachable" : (d < 0 ? ">= " : "= ") + std::to_string(allAssignments.back().cost)) + " (robot=" + robots[j].get().id + ", task=" + tasks[i].id + ")");
         }
     }
-    
-    // Sort by cost
-    std::sort(allAssignments.begin(), allAssignments.end(),
-        [](const Assignment& a, const Assignment& b)
-        {
-            return a.cost < b.cost;
-        });
-    
-    // Greedily assign tasks to robots
+    std::priority_queue<Assignment, std::vector<Assignment>, std::greater<Assignment>> open(
+        std::greater<Assignment>(), std::move(allAssignments));
+
+    std::vector<bool> taskAssigned(numTasks, false);
+    std::vector<bool> robotAssigned(numRobots, false);
+    // No path costs more than one diagonal step per cell of the map; on
+    // maps where that passes INT_MAX, bounds stop at what an int holds
+    const long long longest =
+        std::min<long long>(14LL * mapRef.getWidth() * mapRef.getHeight(), std::numeric_limits<int>::max());
     int assignmentCount = 0;
-    for (const auto& assignment : allAssignments)
+    size_t refined = 0;
+
+    // Greedily assign tasks to robots, cheapest pair first
+    while (!open.empty() && assignmentCount < static_cast<int>(std::min(numTasks, numRobots)))
     {
-        if (!taskAssigned[assignment.taskIdx] && !robotAssigned[assignment.robotIdx])
+        Assignment assignment = open.top();
+        open.pop();
+        if (taskAssigned[assignment.taskIdx] || robotAssigned[assignment.robotIdx])
         {
-            assignments[tasks[assignment.taskIdx].id] = robots[assignment.robotIdx].get().id;
-            taskAssigned[assignment.taskIdx] = true;
-            robotAssigned[assignment.robotIdx] = true;
-            assignmentCount++;
-            SimulationLogger("simulation.log").log("DEBUG: Assigned task " + tasks[assignment.taskIdx].id + " to robot " + robots[assignment.robotIdx].get().id + " (cost=" + std::to_string(assignment.cost) + ")");
+            continue;
         }
+
+        if (assignment.bound >= 0)
+        {
+            // Once the bound could hold any path the search runs to the end
+            int bound = 4LL * assignment.bound >= longest ? -1 : static_cast<int>(4LL * assignment.bound);
+            int d = computePathDistance(robotPositions[assignment.robotIdx], taskPositions[assignment.taskIdx], bound);
+            ++refined;
+            open.push(d < 0 ? entry(assignment.taskIdx, assignment.robotIdx, bound + 1, bound)
+                            : entry(assignment.taskIdx, assignment.robotIdx, d, -1));
+            continue;
+        }
+
+        assignments[tasks[assignment.taskIdx].id] = robots[assignment.robotIdx].get().id;
+        taskAssigned[assignment.taskIdx] = true;
+        robotAssigned[assignment.robotIdx] = true;
+        assignmentCount++;
+        SimulationLogger("simulation.log").log("DEBUG: Assigned task " + tasks[assignment.taskIdx].id + " to robot " + robots[assignment.robotIdx].get().id + " (cost=" + std::to_string(assignment.cost) + ")");
     }
 
+    SimulationLogger("simulation.log").log("DEBUG: distance cap " + std::to_string(cap) + ", " + std::to_string(refined) + " pairs searched past it");
     SimulationLogger("simulation.log").log("DEBUG: Total assignments made: " + std::to_string(assignmentCount) + " out of " + std::to_string(numTasks) + " tasks");
 
     return assignments;
 }
 
 
+void TaskManager::dispatchRound(std::vector<PathfindRequest>& moves, const std::vector<std::size_t>& ranks)
+{
+    if (dispatchMode != DispatchMode::Independent)
+    {
+        // Higher-priority tasks reserve their paths first
+        std::vector<std::size_t> order(moves.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&ranks](std::size_t a, std::size_t b) { return ranks[a] < ranks[b]; });
+        std::vector<PathfindRequest> ordered;
+        ordered.reserve(moves.size());
+        for (std::size_t i : order) ordered.push_back(std::move(moves[i]));
+        moves = std::move(ordered);
+        pathfindCooperative(mapRef, moves, dispatchMode == DispatchMode::ConflictBased
+                                               ? JointPlanner::ConflictBased
+                                               : JointPlanner::Prioritized);
+    }
+    else
+    {
+        // A robot appears at most once per round, so the round's paths can be
+        // planned in parallel
+        pathfindBatch(mapRef, moves);
+    }
+
+    // Independent routes end at the task target. A joint route leaves its
+    // robot at the last cell of its timed path, or where it stood if it got
+    // none: placing it on the target anyway could put it on a cell reserved
+    // for, or parked on by, another robot.
+    if (dispatchMode == DispatchMode::Independent)
+    {
+        for (const auto& move : moves)
+        {
+            move.robot->setPosition(move.target);
+        }
+    }
+}
+
 std::map<std::string, std::string> TaskManager::assignAllTasksOptimal()
 {
     std::map<std::string, std::string> allAssignments;
@@ -562,24 +708,12 @@ std::map<std::string, std::string> TaskManager::assignAllTasksOptimal()
         }
 
         // For this round, compute costs based on simulated end positions
-        auto roundAssignments = hungarianAssignment(
-            remainingTasks,
-            availableRobots,
-            [this, &robotEndPositions](const Robot& robot, const Task& task)
-            {
-                // Use the simulated end position for cost calculation
-                auto it = robotEndPositions.find(robot.id);
-                if (it != robotEndPositions.end())
-                {
-                    GridPoint robotPos = toGridPoint(it->second);
-                    GridPoint taskPos = toGridPoint(task.targetPosition);
-                    int distance = computePathDistance(robotPos, taskPos);
-                    float priorityPenalty = -task.priority * 10.0f;
-                    return static_cast<float>(distance) + priorityPenalty;
-                }
-                return this->pathfindingCost(robot, task);
-            }
-        );
+        std::vector<GridPoint> robotPositions;
+        for (const auto& robot : availableRobots)
+        {
+            robotPositions.push_back(toGridPoint(robotEndPositions[robot.get().id]));
+        }
+        auto roundAssignments = hungarianAssignment(remainingTasks, availableRobots, robotPositions, pathfindingCost);
 
         if (roundAssignments.empty())
         {
@@ -588,6 +722,8 @@ std::map<std::string, std::string> TaskManager::assignAllTasksOptimal()
 
         // Apply this round's assignments
         std::vector<std::string> assignedTaskIds;
+        std::vector<PathfindRequest> moves;
+        std::vector<std::size_t> moveRanks; // task's place in priority order
         for (const auto& [taskId, robotId] : roundAssignments)
         {
             auto taskIt = std::find_if(remainingTasks.begin(), remainingTasks.end(),
@@ -601,13 +737,13 @@ std::map<std::string, std::string> TaskManager::assignAllTasksOptimal()
                 // Update robot's simulated end position to this task's target
                 robotEndPositions[robotId] = taskIt->targetPosition;
 
-                // Find the robot and trigger pathfinding from its current position
+                // Pathfinding from the robot's current position runs below,
+                // batched with the rest of the round
                 Robot* robot = mapRef.findRobotById(robotId);
                 if (robot)
                 {
-                    robot->pathfind(mapRef, taskIt->targetPosition, taskIt->moduleIds);
-                    // Update robot's actual position to the task target (for next pathfind)
-                    robot->setPosition(taskIt->targetPosition);
+                    moves.push_back({robot, taskIt->targetPosition, taskIt->moduleIds});
+                    moveRanks.push_back(static_cast<std::size_t>(taskIt - remainingTasks.begin()));
                 }
 
                 taskIt->status = TaskStatus::Assigned;
@@ -617,6 +753,14 @@ std::map<std::string, std::string> TaskManager::assignAllTasksOptimal()
             }
         }
 
+        dispatchRound(moves, moveRanks);
+
+        // The next round starts from where the robots actually stopped
+        for (const auto& move : moves)
+        {
+            robotEndPositions[move.robot->id] = move.robot->position;
+        }
+
         // Remove assigned tasks from remaining list
         remainingTasks.erase(
             std::remove_if(remainingTasks.begin(), remainingTasks.end(),
@@ -684,26 +828,12 @@ std::map<std::string, std::string> TaskManager::assignAllTasksBalanced()
         }
 
         // Compute costs based on simulated end positions with makespan consideration
-        auto roundAssignments = hungarianAssignment(
-            remainingTasks,
-            availableRobots,
-            [this, &robotEndPositions](const Robot& robot, const Task& task)
-            {
-                auto it = robotEndPositions.find(robot.id);
-                if (it != robotEndPositions.end())
-                {
-                    GridPoint robotPos = toGridPoint(it->second);
-                    GridPoint taskPos = toGridPoint(task.targetPosition);
-                    int distance = computePathDistance(robotPos, taskPos);
-                    float timeCost = distance > 0 && robot.speed > 0.0f
-                        ? static_cast<float>(distance) / robot.speed
-                        : static_cast<float>(distance);
-                    float priorityPenalty = -task.priority * 10.0f;
-                    return timeCost + priorityPenalty;
-                }
-                return this->makespanCost(robot, task);
-            }
-        );
+        std::vector<GridPoint> robotPositions;
+        for (const auto& robot : availableRobots)
+        {
+            robotPositions.push_back(toGridPoint(robotEndPositions[robot.get().id]));
+        }
+        auto roundAssignments = hungarianAssignment(remainingTasks, availableRobots, robotPositions, makespanCost);
 
         if (roundAssignments.empty())
         {
@@ -712,6 +842,8 @@ std::map<std::string, std::string> TaskManager::assignAllTasksBalanced()
 
         // Apply this round's assignments
         std::vector<std::string> assignedTaskIds;
+        std::vector<PathfindRequest> moves;
+        std::vector<std::size_t> moveRanks; // task's place in priority order
         for (const auto& [taskId, robotId] : roundAssignments)
         {
             auto taskIt = std::find_if(remainingTasks.begin(), remainingTasks.end(),
@@ -727,8 +859,8 @@ std::map<std::string, std::string> TaskManager::assignAllTasksBalanced()
                 Robot* robot = mapRef.findRobotById(robotId);
                 if (robot)
                 {
-                    robot->pathfind(mapRef, taskIt->targetPosition, taskIt->moduleIds);
-                    robot->setPosition(taskIt->targetPosition);
+                    moves.push_back({robot, taskIt->targetPosition, taskIt->moduleIds});
+                    moveRanks.push_back(static_cast<std::size_t>(taskIt - remainingTasks.begin()));
                 }
 
                 taskIt->status = TaskStatus::Assigned;
@@ -738,6 +870,14 @@ std::map<std::string, std::string> TaskManager::assignAllTasksBalanced()
             }
         }
 
+        dispatchRound(moves, moveRanks);
+
+        // The next round starts from where the robots actually stopped
+        for (const auto& move : moves)
+        {
+            robotEndPositions[move.robot->id] = move.robot->position;
+        }
+
         // Remove assigned tasks from remaining list
         remainingTasks.erase(
             std::remove_if(remainingTasks.begin(), remainingTasks.end(),
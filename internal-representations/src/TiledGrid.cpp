@@ -0,0 +1,163 @@
+#include "TiledGrid.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    std::shared_ptr<std::uint8_t> allocateTileCells()
+    {
+        return std::shared_ptr<std::uint8_t>(new std::uint8_t[TiledGrid::TILE_CELLS], std::default_delete<std::uint8_t[]>());
+    }
+}
+
+TiledGrid::TiledGrid(int width, int height, std::uint8_t fillValue, GridLayout layout)
+    : width(width), height(height), tilesX(0), tilesY(0), layout(layout)
+{
+    if (width <= 0 || height <= 0)
+    {
+        throw std::invalid_argument("Map dimensions must be positive");
+    }
+
+    tilesX = (width + TILE_MASK) >> TILE_SHIFT;
+    tilesY = (height + TILE_MASK) >> TILE_SHIFT;
+    tiles.resize(static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY));
+    fill(fillValue);
+}
+
+void TiledGrid::set(int x, int y, std::uint8_t value)
+{
+    Tile& tile = tiles[tileIndex(x, y)];
+    if (!tile.cells && tile.value == value)
+    {
+        return; // writing the uniform value keeps the tile uniform
+    }
+    writableCells(tile)[localIndex(x, y)] = value;
+}
+
+void TiledGrid::fill(std::uint8_t value)
+{
+    for (auto& tile : tiles)
+    {
+        tile.cells.reset();
+        tile.value = value;
+        tile.readOnly = false;
+    }
+}
+
+bool TiledGrid::isTileUniform(int tile) const
+{
+    return !tiles[tile].cells;
+}
+
+std::uint8_t TiledGrid::getTileValue(int tile) const
+{
+    return tiles[tile].value;
+}
+
+const std::uint8_t* TiledGrid::getTileCells(int tile) const
+{
+    return tiles[tile].cells.get();
+}
+
+void TiledGrid::attachTile(int tile, std::shared_ptr<const std::uint8_t> cells)
+{
+    // Stored through a non-const pointer, but writableCells never writes a
+    // read-only tile in place
+    tiles[tile].cells = std::const_pointer_cast<std::uint8_t>(std::move(cells));
+    tiles[tile].readOnly = true;
+}
+
+void TiledGrid::setTileValue(int tile, std::uint8_t value)
+{
+    tiles[tile].cells.reset();
+    tiles[tile].value = value;
+    tiles[tile].readOnly = false;
+}
+
+std::size_t TiledGrid::compact()
+{
+    std::size_t released = 0;
+    for (auto& tile : tiles)
+    {
+        if (!tile.cells)
+        {
+            continue;
+        }
+        const std::uint8_t* cells = tile.cells.get();
+        if (std::all_of(cells, cells + TILE_CELLS, [first = cells[0]](std::uint8_t v) { return v == first; }))
+        {
+            tile.value = cells[0];
+            tile.cells.reset();
+            tile.readOnly = false;
+            ++released;
+        }
+    }
+    return released;
+}
+
+std::int64_t TiledGrid::countNonZero() const
+{
+    std::int64_t total = 0;
+    for (int ty = 0; ty < tilesY; ++ty)
+    {
+        for (int tx = 0; tx < tilesX; ++tx)
+        {
+            const Tile& tile = tiles[static_cast<std::size_t>(ty) * tilesX + tx];
+            const int x0 = tx << TILE_SHIFT;
+            const int y0 = ty << TILE_SHIFT;
+            const int w = std::min(TILE_SIZE, width - x0);
+            const int h = std::min(TILE_SIZE, height - y0);
+            if (!tile.cells)
+            {
+                total += tile.value != 0 ? static_cast<std::int64_t>(w) * h : 0;
+            }
+            else if (w == TILE_SIZE && h == TILE_SIZE)
+            {
+                const std::uint8_t* cells = tile.cells.get();
+                total += std::count_if(cells, cells + TILE_CELLS, [](std::uint8_t v) { return v != 0; });
+            }
+            else
+            {
+                // Edge tile: skip the padding cells past the grid border
+                for (int y = y0; y < y0 + h; ++y)
+                {
+                    for (int x = x0; x < x0 + w; ++x)
+                    {
+                        total += get(x, y) != 0;
+                    }
+                }
+            }
+        }
+    }
+    return total;
+}
+
+std::size_t TiledGrid::materializedTileCount() const
+{
+    return static_cast<std::size_t>(std::count_if(tiles.begin(), tiles.end(),
+        [](const Tile& tile) { return static_cast<bool>(tile.cells); }));
+}
+
+std::size_t TiledGrid::memoryUsage() const
+{
+    return sizeof(*this) + tiles.capacity() * sizeof(Tile) + materializedTileCount() * TILE_CELLS;
+}
+
+std::uint8_t* TiledGrid::writableCells(Tile& tile)
+{
+    if (!tile.cells)
+    {
+        // Materialize a uniform tile on its first diverging write
+        tile.cells = allocateTileCells();
+        std::memset(tile.cells.get(), tile.value, TILE_CELLS);
+    }
+    else if (tile.readOnly || tile.cells.use_count() > 1)
+    {
+        // Buffer is external or shared with another grid copy: clone before writing
+        auto copy = allocateTileCells();
+        std::memcpy(copy.get(), tile.cells.get(), TILE_CELLS);
+        tile.cells = std::move(copy);
+        tile.readOnly = false;
+    }
+    return tile.cells.get();
+}
@@ -0,0 +1,157 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+    thread_local bool insideJob = false;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+{
+    threads = std::max(threads, 1u);
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+WorkStealingPool& WorkStealingPool::instance()
+{
+    static WorkStealingPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+    return pool;
+}
+
+void WorkStealingPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (workers.empty() || count == 1 || insideJob)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            fn(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> batchLock(batchMu);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Queue& q = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lk(q.mu);
+        q.items.push_back(i);
+    }
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        job = &fn;
+        error = nullptr;
+        remaining = count;
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(0, fn);
+
+    std::unique_lock<std::mutex> lk(mu);
+    // Workers that joined late must be out before job goes out of scope
+    done.wait(lk, [this] { return remaining == 0 && active == 0; });
+    job = nullptr;
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::workerLoop(unsigned participant)
+{
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lk(mu);
+    while (true)
+    {
+        wake.wait(lk, [&] { return stopping || generation != seen; });
+        if (stopping)
+        {
+            return;
+        }
+        seen = generation;
+        if (!job)
+        {
+            continue; // that batch is already over
+        }
+        const std::function<void(std::size_t)>& fn = *job;
+        ++active;
+        lk.unlock();
+        work(participant, fn);
+        lk.lock();
+        --active;
+        done.notify_all();
+    }
+}
+
+void WorkStealingPool::work(unsigned participant, const std::function<void(std::size_t)>& fn)
+{
+    insideJob = true;
+    std::size_t index;
+    while (take(participant, index))
+    {
+        try
+        {
+            fn(index);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            if (!error) error = std::current_exception();
+        }
+        if (--remaining == 0)
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            done.notify_all();
+        }
+    }
+    insideJob = false;
+}
+
+bool WorkStealingPool::take(unsigned participant, std::size_t& index)
+{
+    {
+        Queue& own = *queues[participant];
+        std::lock_guard<std::mutex> lk(own.mu);
+        if (!own.items.empty())
+        {
+            index = own.items.back();
+            own.items.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < queues.size(); ++k)
+    {
+        Queue& victim = *queues[(participant + k) % queues.size()];
+        std::lock_guard<std::mutex> lk(victim.mu);
+        if (!victim.items.empty())
+        {
+            index = victim.items.front();
+            victim.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -5,6 +5,7 @@
 int main(int argc, char* argv[]) {
     int port = 8080;
     std::string pluginsDir = "./plugins";
+    std::string mapsDir = "./maps";
 
     for (int i = 1; i < argc; ++i) {
         if (std::string(argv[i]) == "--port" && i + 1 < argc) {
@@ -13,10 +14,14 @@ int main(int argc, char* argv[]) {
         if (std::string(argv[i]) == "--plugins-dir" && i + 1 < argc) {
             pluginsDir = argv[i + 1];
         }
+        if (std::string(argv[i]) == "--maps-dir" && i + 1 < argc) {
+            mapsDir = argv[i + 1];
+        }
     }
 
     Server server(port);
     server.loadPluginsFromDirectory(pluginsDir);
+    server.setMapsDirectory(mapsDir);
 
     server.start();
 
@@ -24,6 +24,9 @@ public:
 
     int loadPluginsFromDirectory(const std::string& dirPath);
 
+    // Directory that map import/export names are resolved in
+    void setMapsDirectory(const std::string& dirPath);
+
 private:
     int port;
     bool running;
@@ -62,4 +65,5 @@ private:
 
     std::string pluginsDirectory;
     std::string userPluginsDirectory;
+    std::string mapsDirectory = "./maps";
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "Robot.h"
 #include "Map.h"
 #include "TaskManager.h"
+#include "PathCache.h"
+#include "AnyAnglePlanner.h"
 #include "Logger.h"
 #include "Module.h"
 #include <iostream>
@@ -20,6 +22,10 @@
 #include <regex>
 #include <arpa/inet.h>
 #include <dirent.h>
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <charconv>
 #include <dlfcn.h>
 #include "plugins/PluginAPI.h"
 #include "ModuleManager.h"
@@ -100,6 +106,47 @@ std::string extractBody(const std::string& request) {
     return "";
 }
 
+// Complete 400 response; handleRequest passes a handler result that is
+// already a full HTTP response through unchanged
+static std::string badRequest(const std::string& body) {
+    std::ostringstream response;
+    response << "HTTP/1.1 400 Bad Request\r\n";
+    response << "Content-Type: text/plain\r\n";
+    response << "Content-Length: " << body.size() << "\r\n";
+    response << "Access-Control-Allow-Origin: *\r\n";
+    response << "Connection: close\r\n";
+    response << "\r\n";
+    response << body;
+    return response.str();
+}
+
+// Resolve a map file name for import/export inside mapsDir. Only a bare file
+// name is accepted (".agmap" is appended if missing); returns "" for anything
+// with a directory part, a leading dot, or that resolves through a symlink to
+// a file outside mapsDir.
+static std::string resolveMapFile(const std::string& mapsDir, const std::string& name) {
+    static const std::regex bareName("[A-Za-z0-9_-][A-Za-z0-9_.-]*");
+    if (!std::regex_match(name, bareName)) return "";
+
+    char dirBuf[PATH_MAX];
+    if (!realpath(mapsDir.c_str(), dirBuf)) return "";
+    std::string dir = std::string(dirBuf) + "/";
+
+    std::string file = name;
+    const std::string ext = ".agmap";
+    if (file.size() < ext.size() || file.compare(file.size() - ext.size(), ext.size(), ext) != 0) file += ext;
+    std::string filePath = dir + file;
+
+    struct stat st;
+    if (lstat(filePath.c_str(), &st) == 0) {
+        char fileBuf[PATH_MAX];
+        if (!realpath(filePath.c_str(), fileBuf)) return "";
+        std::string resolved(fileBuf);
+        if (resolved.compare(0, dir.size(), dir) != 0) return "";
+    }
+    return filePath;
+}
+
 void Server::initializeHandlers() {
     // Expose available plugins to clients
     registerEndpoint("GET /plugins", [this](const std::string& request) {
@@ -670,8 +717,12 @@ void Server::initializeHandlers() {
                 int height = std::stoi(heightMatch[1]);
                 std::string name = nameMatch[1];
                 std::string mapUrl = mapUrlMatch[1];
+
+                // Optional storage layout: "rowmajor" (default) or "morton"
+                std::regex layoutRegex("\"layout\"\\s*:\\s*\"morton\"");
+                GridLayout layout = std::regex_search(body, layoutRegex) ? GridLayout::Morton : GridLayout::RowMajor;
                 
-                auto mapResult = maps.emplace(id, std::make_unique<Map>(width, height, name, mapUrl));
+                auto mapResult = maps.emplace(id, std::make_unique<Map>(width, height, name, mapUrl, layout));
 
                 // Create a TaskManager for this map
                 taskManagers[id] = std::make_unique<TaskManager>(*(mapResult.first->second));
@@ -751,25 +802,14 @@ void Server::initializeHandlers() {
                                         size_t expect = 2 + (size_t)jwidth * (size_t)jheight;
                                         if (nums.size() >= expect) {
                                             Map &mref = *maps.at(id);
-                                            size_t idx = 2;
-                                            for (int y = 0; y < jheight; ++y) {
-                                                for (int x = 0; x < jwidth; ++x) {
-                                                    int code = nums[idx++];
-                                                    // code: 1=FIELD,2=ROAD => accessible(0); else inaccessible(1)
-                                                    int cell = (code == 1 || code == 2) ? 0 : 1;
-                                                    // If generated grid resolution differs from Map width/height, scale accordingly
-                                                    if (jwidth == mref.getWidth() && jheight == mref.getHeight()) {
-                                                        mref.setCell(x, y, cell);
-                                                    } else {
-                                                        // Map and generated grid sizes differ: map cells are indexed by map's width/height
-                                                        int scaled_x = x * mref.getWidth() / jwidth;
-                                                        int scaled_y = y * mref.getHeight() / jheight;
-                                                        if (mref.isValidPosition(scaled_x, scaled_y)) {
-                                                            mref.setCell(scaled_x, scaled_y, cell);
-                                                        }
-                                                    }
-                                                }
+                                            std::vector<std::uint8_t> occupancy((size_t)jwidth * (size_t)jheight);
+                                            for (size_t i = 0; i < occupancy.size(); ++i) {
+                                                int code = nums[2 + i];
+                                                // code: 1=FIELD,2=ROAD => accessible(0); else inaccessible(1)
+                                                occupancy[i] = (code == 1 || code == 2) ? 0 : 1;
                                             }
+                                            // Resamples conservatively if the generated grid resolution differs from the map
+                                            mref.importOccupancy(occupancy, jwidth, jheight);
                                             if (logger) logger->log(LogLevel::Info, "Populated map grid from segmentation for map id=" + id);
                                         } else {
                                             if (logger) logger->log(LogLevel::Warn, "Segmentation JSON smaller than expected for map id=" + id);
@@ -840,6 +880,8 @@ void Server::initializeHandlers() {
                 std::ostringstream out;
                 out << "{\"id\":\"" << id << "\",\"name\":\"" << m.getName() << "\""
                     << ",\"width\":" << m.getWidth() << ",\"height\":" << m.getHeight() 
+                    << ",\"levels\":" << m.getLevelCount()
+                    << ",\"version\":" << m.getVersion() << ",\"obstacles\":" << m.getObstacleCount()
                     << ",\"mapUrl\":\"" << m.getMapUrl() << "\"}";
                 if (logger) logger->log(LogLevel::Info, "Fetched map id=" + id);
                 return out.str();
@@ -848,7 +890,9 @@ void Server::initializeHandlers() {
         if (logger) logger->log(LogLevel::Warn, "Get map not found");
         return std::string("Map not found\n"); });
 
-    // GET /map/{id}/grid - Returns the occupancy grid for a map
+    // GET /map/{id}/grid?level={n} - Returns the occupancy grid for a map. Level 0
+    // (default) is full resolution; level n is downsampled 2^n times, with a
+    // cell blocked if any full-resolution cell inside it is blocked.
     registerEndpoint("GET /map/{id}/grid", [this](const std::string &request)
                      {
         std::istringstream requestStream(request);
@@ -856,21 +900,32 @@ void Server::initializeHandlers() {
         requestStream >> method >> path;
 
         std::regex idRegex("/map/([a-f0-9]{8}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{12})/grid");
-        std::smatch match;
+        std::regex levelRe("level=([0-9]+)");
+        std::smatch match, levelMatch;
         if (std::regex_search(path, match, idRegex)) {
             std::string id = match[1];
             auto it = maps.find(id);
             if (it != maps.end()) {
                 const Map &m = *(it->second);
-                int width = m.getWidth();
-                int height = m.getHeight();
+                int level = 0;
+                if (std::regex_search(path, levelMatch, levelRe)) {
+                    const std::string digits = levelMatch[1];
+                    auto parsed = std::from_chars(digits.data(), digits.data() + digits.size(), level);
+                    if (parsed.ec != std::errc()) level = -1;
+                }
+                if (level < 0 || level >= m.getLevelCount()) {
+                    return badRequest("{\"error\":\"level out of range\"}\n");
+                }
+                const TiledGrid &levelGrid = m.getLevelGrid(level);
+                int width = levelGrid.getWidth();
+                int height = levelGrid.getHeight();
                 
                 std::ostringstream out;
-                out << "{\"width\":" << width << ",\"height\":" << height << ",\"grid\":[";
+                out << "{\"width\":" << width << ",\"height\":" << height << ",\"level\":" << level << ",\"grid\":[";
                 for (int y = 0; y < height; ++y) {
                     out << "[";
                     for (int x = 0; x < width; ++x) {
-                        out << m.getCell(x, y);
+                        out << static_cast<int>(levelGrid.get(x, y));
                         if (x < width - 1) out << ",";
                     }
                     out << "]";
@@ -885,6 +940,106 @@ void Server::initializeHandlers() {
         if (logger) logger->log(LogLevel::Warn, "Get map grid not found");
         return std::string("Map not found\n"); });
 
+    // POST /map/{id}/import - Create or replace a map from an .agmap file in
+    // the maps directory (--maps-dir). Robots and pending tasks of a replaced
+    // map are kept.
+    // Expects JSON body: {"name":"farm","verify":false}
+    registerEndpoint("POST /map/{id}/import", [this](const std::string& request) {
+        std::istringstream requestStream(request);
+        std::string method, path;
+        requestStream >> method >> path;
+
+        std::string body = extractBody(request);
+
+        std::regex idRegex("/map/([a-f0-9]{8}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{12})/import");
+        std::smatch match;
+        if (!std::regex_search(path, match, idRegex)) {
+            return std::string("Bad request\n");
+        }
+        std::string id = match[1];
+
+        std::regex nameRe("\"name\"\\s*:\\s*\"([^\"]+)\"");
+        std::regex verifyRe("\"verify\"\\s*:\\s*true");
+        std::smatch nameMatch;
+        if (!std::regex_search(body, nameMatch, nameRe)) {
+            return std::string("name missing\n");
+        }
+        std::string filePath = resolveMapFile(mapsDirectory, nameMatch[1]);
+        if (filePath.empty()) {
+            if (logger) logger->log(LogLevel::Warn, "Map import rejected name " + std::string(nameMatch[1]));
+            return std::string("Invalid map name\n");
+        }
+        bool verify = std::regex_search(body, verifyRe);
+
+        try {
+            Map imported(filePath, verify);
+            auto it = maps.find(id);
+            if (it != maps.end()) {
+                // Replace in place: the map's TaskManager refers to this object
+                for (const auto& robot : it->second->getRobots()) {
+                    imported.addRobot(robot);
+                }
+                *it->second = imported;
+            } else {
+                maps[id] = std::make_unique<Map>(imported);
+            }
+            if (taskManagers.find(id) == taskManagers.end()) {
+                taskManagers[id] = std::make_unique<TaskManager>(*maps[id]);
+            }
+        } catch (const std::exception& ex) {
+            if (logger) logger->log(LogLevel::Error, std::string("Map import failed: ") + ex.what());
+            return std::string("Map import failed\n");
+        }
+
+        const Map& m = *maps[id];
+        if (logger) logger->log(LogLevel::Info, "Imported map id=" + id + " from " + filePath + " (" + std::to_string(m.getWidth()) + "x" + std::to_string(m.getHeight()) + ")");
+        return std::string("Map imported successfully\n");
+    });
+
+    // POST /map/{id}/export - Write a map to an .agmap file in the maps
+    // directory (--maps-dir)
+    // Expects JSON body: {"name":"farm"}
+    registerEndpoint("POST /map/{id}/export", [this](const std::string& request) {
+        std::istringstream requestStream(request);
+        std::string method, path;
+        requestStream >> method >> path;
+
+        std::string body = extractBody(request);
+
+        std::regex idRegex("/map/([a-f0-9]{8}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{4}-[a-f0-9]{12})/export");
+        std::smatch match;
+        if (!std::regex_search(path, match, idRegex)) {
+            return std::string("Bad request\n");
+        }
+        std::string id = match[1];
+        auto it = maps.find(id);
+        if (it == maps.end()) {
+            return std::string("Map not found\n");
+        }
+
+        std::regex nameRe("\"name\"\\s*:\\s*\"([^\"]+)\"");
+        std::smatch nameMatch;
+        if (!std::regex_search(body, nameMatch, nameRe)) {
+            return std::string("name missing\n");
+        }
+        mkdir(mapsDirectory.c_str(), 0755);
+        std::string filePath = resolveMapFile(mapsDirectory, nameMatch[1]);
+        if (filePath.empty()) {
+            if (logger) logger->log(LogLevel::Warn, "Map export rejected name " + std::string(nameMatch[1]));
+            return std::string("Invalid map name\n");
+        }
+
+        try {
+            it->second->saveAgmap(filePath);
+        } catch (const std::exception& ex) {
+            if (logger) logger->log(LogLevel::Error, std::string("Map export failed: ") + ex.what());
+            return std::string("Map export failed\n");
+        }
+
+        if (logger) logger->log(LogLevel::Info, "Exported map id=" + id + " to " + filePath);
+        return std::string("Map exported successfully\n");
+    });
+
     registerEndpoint("GET /map/", [this](const std::string &request)
                      {
         std::ostringstream response;
@@ -939,7 +1094,9 @@ void Server::initializeHandlers() {
     });
 
     // Endpoint to invoke pathfinding for a robot against a specific map
-    // Expects JSON body: {"mapId":"<map-uuid>","target":[x,y]}
+    // Expects JSON body: {"mapId":"<map-uuid>","target":[x,y]}, optionally
+    // "planner":"dijkstra"|"astar"|"alt"|"jps"|"hpa"|"theta"|"dstar"|"flow" (default dijkstra)
+    // and "smooth":true to string-pull the path into straight waypoints
     registerEndpoint("POST /robots/{id}/pathfind", [this](const std::string& request) {
         std::istringstream requestStream(request);
         std::string method, path;
@@ -974,12 +1131,7 @@ void Server::initializeHandlers() {
             // obstacles before pathfinding.
             try {
                 Map &mref = *(mIt->second);
-                bool allZero = true;
-                for (int yy = 0; yy < mref.getHeight() && allZero; ++yy) {
-                    for (int xx = 0; xx < mref.getWidth(); ++xx) {
-                        if (mref.getCell(xx, yy) != 0) { allZero = false; break; }
-                    }
-                }
+                bool allZero = mref.getObstacleCount() == 0;
                 std::string mapUrlLocal = mref.getMapUrl();
                 std::string lowerUrl = mapUrlLocal;
                 std::transform(lowerUrl.begin(), lowerUrl.end(), lowerUrl.begin(), ::tolower);
@@ -1045,22 +1197,12 @@ void Server::initializeHandlers() {
                                     int jheight = nums[1];
                                     size_t expect = 2 + (size_t)jwidth * (size_t)jheight;
                                     if (nums.size() >= expect) {
-                                        size_t idx = 2;
-                                        for (int y = 0; y < jheight; ++y) {
-                                            for (int x = 0; x < jwidth; ++x) {
-                                                int code = nums[idx++];
-                                                int cell = (code == 1 || code == 2) ? 0 : 1;
-                                                if (jwidth == mref.getWidth() && jheight == mref.getHeight()) {
-                                                    mref.setCell(x, y, cell);
-                                                } else {
-                                                    int scaled_x = x * mref.getWidth() / jwidth;
-                                                    int scaled_y = y * mref.getHeight() / jheight;
-                                                    if (mref.isValidPosition(scaled_x, scaled_y)) {
-                                                        mref.setCell(scaled_x, scaled_y, cell);
-                                                    }
-                                                }
-                                            }
+                                        std::vector<std::uint8_t> occupancy((size_t)jwidth * (size_t)jheight);
+                                        for (size_t i = 0; i < occupancy.size(); ++i) {
+                                            int code = nums[2 + i];
+                                            occupancy[i] = (code == 1 || code == 2) ? 0 : 1;
                                         }
+                                        mref.importOccupancy(occupancy, jwidth, jheight);
                                         if (logger) logger->log(LogLevel::Info, "Populated map grid from segmentation before pathfind for map id=" + mapId);
                                     }
                                 }
@@ -1089,18 +1231,34 @@ void Server::initializeHandlers() {
                 return std::string("bad target values\n");
             }
 
+            PlannerAlgorithm planner = PlannerAlgorithm::Dijkstra;
+            std::regex plannerRe("\"planner\"\\s*:\\s*\"([^\"]*)\"");
+            std::smatch m4;
+            if (std::regex_search(body, m4, plannerRe) && !parsePlannerAlgorithm(m4[1], planner)) {
+                return std::string("unknown planner\n");
+            }
+            const bool smooth = std::regex_search(body, std::regex("\"smooth\"\\s*:\\s*true"));
+
             // Clear simulation log before starting new pathfinding
             std::remove("simulation.log");
 
             // Execute pathfinding (this will append to simulation.log)
             try {
-                rIt->second.pathfind(*(mIt->second), std::vector<float>{tx, ty});
+                Robot::Route route = rIt->second.planRoute(*(mIt->second), std::vector<float>{tx, ty}, planner);
+                if (smooth && route.status == Robot::Route::Status::Planned) {
+                    route.plan = smoothPath(*(mIt->second), route.plan);
+                }
+                rIt->second.followRoute(*(mIt->second), route);
+                if (route.status == Robot::Route::Status::Unreachable) {
+                    if (logger) logger->log(LogLevel::Warn, "Pathfind: target not reachable for robot=" + robotId + " map=" + mapId);
+                    return std::string("Target unreachable\n");
+                }
             } catch (const std::exception& ex) {
                 if (logger) logger->log(LogLevel::Error, std::string("Pathfind exception: ") + ex.what());
                 return std::string("Pathfind failed\n");
             }
 
-            if (logger) logger->log(LogLevel::Info, "Pathfind executed for robot=" + robotId + " map=" + mapId);
+            if (logger) logger->log(LogLevel::Info, "Pathfind executed for robot=" + robotId + " map=" + mapId + " planner=" + plannerAlgorithmName(planner));
             return std::string("Pathfind executed\n");
         }
 
@@ -1178,6 +1336,17 @@ void Server::initializeHandlers() {
         return std::string("{\"success\":true}\n");
     });
 
+    // GET /pathcache - Hit/miss counters of the shared path cache
+    registerEndpoint("GET /pathcache", [this](const std::string& request) {
+        PathCache::Stats stats = PathCache::instance().getStats();
+        std::ostringstream out;
+        out << "{\"hits\":" << stats.hits << ",\"misses\":" << stats.misses
+            << ",\"entries\":" << stats.entries << ",\"capacity\":" << stats.capacity
+            << ",\"pathBytes\":" << stats.pathBytes << "}\n";
+        if (logger) logger->log(LogLevel::Info, "Served path cache stats");
+        return out.str();
+    });
+
     // ===== TASK MANAGEMENT ENDPOINTS =====
 
     // POST /tasks - Create a new task
@@ -1232,8 +1401,10 @@ void Server::initializeHandlers() {
         task.moduleIds = moduleIds;
         tmIt->second->addTask(task);
 
-        if (logger) logger->log(LogLevel::Info, "Created task for map=" + mapId + " with " + std::to_string(moduleIds.size()) + " modules");
-        return std::string("{\"success\":true}\n");
+        // Still queued, but flagged so the client knows no robot can get there yet
+        const bool reachable = tmIt->second->isReachableByAnyRobot(task.targetPosition);
+        if (logger) logger->log(reachable ? LogLevel::Info : LogLevel::Warn, "Created task for map=" + mapId + " with " + std::to_string(moduleIds.size()) + " modules" + (reachable ? "" : " (no robot can reach it)"));
+        return std::string("{\"success\":true,\"reachable\":") + (reachable ? "true" : "false") + "}\n";
     });
 
     // GET /tasks?mapId={id} - List all tasks for a map
@@ -1276,7 +1447,11 @@ void Server::initializeHandlers() {
         return out.str();
     });
 
-    // POST /tasks/assign?mapId={id}&algorithm={greedy|optimal|balanced} - Assign tasks to robots
+    // POST /tasks/assign?mapId={id}&algorithm={greedy|optimal|balanced}&mode={independent|cooperative|cbs}
+    // - Assign tasks to robots. mode picks how optimal/balanced rounds are
+    // routed: on independent shortest paths (default), or so robots do not
+    // collide, with cooperative space-time A* or with Conflict-Based Search
+    // (time-limited, falls back to cooperative); greedy ignores it.
     registerEndpoint("POST /tasks/assign", [this](const std::string& request) {
         std::istringstream requestStream(request);
         std::string method, path;
@@ -1284,7 +1459,8 @@ void Server::initializeHandlers() {
 
         std::regex mapIdRe("mapId=([^&\\s]+)");
         std::regex algoRe("algorithm=([^&\\s]+)");
-        std::smatch m1, m2;
+        std::regex modeRe("mode=([^&\\s]+)");
+        std::smatch m1, m2, m3;
 
         if (!std::regex_search(path, m1, mapIdRe)) {
             return std::string("{\"error\":\"Missing mapId parameter\"}\n");
@@ -1293,10 +1469,18 @@ void Server::initializeHandlers() {
         std::string mapId = m1[1];
         std::string algorithm = std::regex_search(path, m2, algoRe) ? m2[1].str() : "greedy";
 
+        std::string mode = std::regex_search(path, m3, modeRe) ? m3[1].str() : "independent";
+        if (mode != "independent" && mode != "cooperative" && mode != "cbs") {
+            return std::string("{\"error\":\"Unknown mode (use independent, cooperative or cbs)\"}\n");
+        }
+
         auto tmIt = taskManagers.find(mapId);
         if (tmIt == taskManagers.end()) {
             return std::string("{\"error\":\"Map not found\"}\n");
         }
+        tmIt->second->setDispatchMode(mode == "cbs"           ? TaskManager::DispatchMode::ConflictBased
+                                      : mode == "cooperative" ? TaskManager::DispatchMode::Cooperative
+                                                              : TaskManager::DispatchMode::Independent);
 
         // Clear simulation log before starting new multi-robot simulation
         std::remove("simulation.log");
@@ -1431,6 +1615,10 @@ void Server::stop() {
     if (logger) logger->log(LogLevel::Info, "Server stopped.");
 }
 
+void Server::setMapsDirectory(const std::string& dirPath) {
+    mapsDirectory = dirPath;
+}
+
 // Load all .so files in dirPath. For each plugin, call plugin_start(&hostApi, moduleId)
 int Server::loadPluginsFromDirectory(const std::string& dirPath) {
     // remember directory for listing
@@ -1992,7 +2180,15 @@ std::string Server::handleRequest(const std::string& request) {
         // Use regex to match the path only (not the method, and without query params)
         std::regex pattern(endpointPattern);
         if (std::regex_match(pathWithoutQuery, pattern)) {
-            std::string body = handler(request);
+            std::string body;
+            try {
+                body = handler(request);
+            } catch (const std::exception& ex) {
+                // A malformed request must not take the server down
+                if (logger) logger->log(LogLevel::Error, "Handler for " + endpoint + " failed: " + ex.what());
+                return badRequest("Bad request\n");
+            }
+            if (body.compare(0, 9, "HTTP/1.1 ") == 0) return body;
             std::ostringstream response;
             response << "HTTP/1.1 200 OK\r\n";
             response << "Content-Type: text/plain\r\n";
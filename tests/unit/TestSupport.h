@@ -0,0 +1,94 @@
+#ifndef H_TEST_SUPPORT
+#define H_TEST_SUPPORT
+
+// Minimal helpers for the C++ unit tests in tests/unit. CHECK records a
+// failure with its location and carries on, so one run reports every broken
+// case; each test's main returns testResult(). Build and run all of them from
+// the repository root with: make unit-test
+
+#include "Map.h"
+#include "PathPlanner.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline int& testChecks()
+{
+    static int checks = 0;
+    return checks;
+}
+
+#define CHECK(cond)                                                                              \
+    do                                                                                           \
+    {                                                                                            \
+        ++testChecks();                                                                          \
+        if (!(cond) && ++testFailures() <= 20)                                                   \
+        {                                                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n";           \
+        }                                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                           \
+    do                                                                                           \
+    {                                                                                            \
+        ++testChecks();                                                                          \
+        auto checkA = (a);                                                                       \
+        auto checkB = (b);                                                                       \
+        if (!(checkA == checkB) && ++testFailures() <= 20)                                       \
+        {                                                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: "    \
+                      << checkA << " vs " << checkB << "\n";                                     \
+        }                                                                                        \
+    } while (0)
+
+inline int testResult(const char* name)
+{
+    std::cout << name << ": " << testChecks() << " checks, " << testFailures() << " failed\n";
+    return testFailures() == 0 ? 0 : 1;
+}
+
+// w x h map with about percent% of its cells blocked at random
+inline Map randomMap(std::mt19937& rng, int w, int h, int percent, GridLayout layout = GridLayout::RowMajor)
+{
+    Map map(w, h, "test", "", layout);
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            if (static_cast<int>(rng() % 100) < percent) map.setCell(x, y, 1);
+        }
+    }
+    return map;
+}
+
+inline GridPoint randomCell(std::mt19937& rng, const Map& map)
+{
+    return {static_cast<int>(rng() % map.getWidth()), static_cast<int>(rng() % map.getHeight())};
+}
+
+// 10/14 cost of a path of single grid steps (a vector or a CompactPath) from
+// start to goal over free cells (the start may be blocked), or -1 if it is
+// not one
+template <typename Path>
+int gridPathCost(const Map& map, const Path& path, GridPoint start, GridPoint goal)
+{
+    if (path.empty() || path.front() != start || path.back() != goal) return -1;
+    int cost = 0;
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        int dx = std::abs(path[i].first - path[i - 1].first);
+        int dy = std::abs(path[i].second - path[i - 1].second);
+        if (dx > 1 || dy > 1 || dx + dy == 0 || !map.isAccessible(path[i].first, path[i].second)) return -1;
+        cost += dx && dy ? 14 : 10;
+    }
+    return cost;
+}
+
+#endif
@@ -0,0 +1,136 @@
+// Any-angle planning: a line of sight only crosses free cells, Lazy Theta*
+// reaches exactly what Dijkstra reaches, with waypoints that see each other
+// joined by grid steps a robot can drive, and string pulling never lengthens
+// a grid path.
+
+#include "AnyAnglePlanner.h"
+#include "TestSupport.h"
+#include <cmath>
+
+namespace {
+    int segmentsCost(const Map& map, const std::vector<GridPoint>& path)
+    {
+        int cost = 0;
+        for (std::size_t i = 1; i < path.size(); ++i)
+        {
+            CHECK(hasLineOfSight(map, path[i - 1], path[i]));
+            cost += segmentCost(path[i - 1], path[i]);
+        }
+        return cost;
+    }
+
+    double length(const std::vector<GridPoint>& path)
+    {
+        double total = 0;
+        for (std::size_t i = 1; i < path.size(); ++i)
+        {
+            total += std::hypot(path[i].first - path[i - 1].first, path[i].second - path[i - 1].second);
+        }
+        return total;
+    }
+
+    // Points along the segment between the two centres, away from cell
+    // edges, lie in free cells whenever the cells see each other
+    void checkLineOfSight(const Map& map, GridPoint a, GridPoint b)
+    {
+        if (!map.isAccessible(a.first, a.second)) return;
+        const bool visible = hasLineOfSight(map, a, b);
+        if (map.isAccessible(b.first, b.second)) CHECK_EQ(visible, hasLineOfSight(map, b, a));
+        if (!visible) return;
+        for (int k = 1; k < 1000; ++k)
+        {
+            double t = k / 1000.0;
+            double x = a.first + 0.5 + (b.first - a.first) * t;
+            double y = a.second + 0.5 + (b.second - a.second) * t;
+            double fx = x - std::floor(x);
+            double fy = y - std::floor(y);
+            if (fx < 1e-6 || fx > 1 - 1e-6 || fy < 1e-6 || fy > 1 - 1e-6) continue;
+            if (!map.isAccessible(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y))))
+            {
+                CHECK(false);
+                return;
+            }
+        }
+    }
+
+    // The grid steps run over free cells through every waypoint in order,
+    // straight along the segments between them
+    void checkSteps(const Map& map, const PlanResult& plan)
+    {
+        CHECK(gridPathCost(map, plan.path, plan.waypoints.front(), plan.waypoints.back()) >= 0);
+        std::size_t next = 0;
+        for (GridPoint cell : plan.path)
+        {
+            if (next < plan.waypoints.size() && cell == plan.waypoints[next]) ++next;
+        }
+        CHECK_EQ(next, plan.waypoints.size());
+    }
+
+    void checkRandomMaps()
+    {
+        std::mt19937 rng(44);
+        long long gridTotal = 0;
+        long long thetaTotal = 0;
+        for (int percent : {0, 10, 25, 40})
+        {
+            for (int rep = 0; rep < 5; ++rep)
+            {
+                Map map = randomMap(rng, 80, 60, percent);
+                for (int i = 0; i < 300; ++i)
+                {
+                    checkLineOfSight(map, randomCell(rng, map), randomCell(rng, map));
+                }
+
+                for (int i = 0; i < 200; ++i)
+                {
+                    GridPoint start = randomCell(rng, map);
+                    GridPoint goal = randomCell(rng, map);
+                    PlanResult grid = planPath(map, start, goal, PlannerAlgorithm::Dijkstra);
+                    PlanResult theta = planPath(map, start, goal, PlannerAlgorithm::AnyAngle);
+                    CHECK_EQ(theta.path.empty(), grid.path.empty());
+                    if (theta.path.empty() || grid.path.empty()) continue;
+
+                    CHECK(theta.waypoints.front() == start && theta.waypoints.back() == goal);
+                    CHECK_EQ(segmentsCost(map, theta.waypoints), theta.cost);
+                    checkSteps(map, theta);
+                    // Rounding each segment can undercut the straight line by
+                    // half a unit per segment, no more
+                    CHECK(2 * theta.cost + static_cast<int>(theta.waypoints.size()) >= 2 * segmentCost(start, goal));
+
+                    // Every grid step is a line of sight, so the grid path
+                    // can be pulled tight
+                    const std::vector<GridPoint> gridCells = grid.path.toVector();
+                    const int gridCost = segmentsCost(map, gridCells);
+                    PlanResult smooth = smoothPath(map, grid);
+                    CHECK(smooth.waypoints.front() == start && smooth.waypoints.back() == goal);
+                    CHECK_EQ(segmentsCost(map, smooth.waypoints), smooth.cost);
+                    CHECK(length(smooth.waypoints) <= length(gridCells) + 1e-9);
+                    checkSteps(map, smooth);
+
+                    gridTotal += gridCost;
+                    thetaTotal += theta.cost;
+                }
+            }
+        }
+        // Not guaranteed per query, but shorter than grid paths overall
+        CHECK(thetaTotal < gridTotal);
+    }
+
+    // In open space the path is the straight segment
+    void checkOpenSpace()
+    {
+        Map map(50, 50, "test", "");
+        PlanResult theta = planPath(map, {2, 3}, {41, 30}, PlannerAlgorithm::AnyAngle);
+        CHECK_EQ(theta.waypoints.size(), std::size_t(2));
+        CHECK(theta.path.size() > std::size_t(41 - 2));
+        checkSteps(map, theta);
+        CHECK_EQ(theta.cost, segmentCost({2, 3}, {41, 30}));
+    }
+}
+
+int main()
+{
+    checkRandomMaps();
+    checkOpenSpace();
+    return testResult("any_angle");
+}
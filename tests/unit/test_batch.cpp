@@ -0,0 +1,108 @@
+// Parallel planning: the work-stealing pool runs every index exactly once,
+// and a batch of pathfind calls ends exactly where the same calls made one
+// after another do.
+
+#include "BatchPathfind.h"
+#include "PathCache.h"
+#include "TestSupport.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+    void checkPool()
+    {
+        WorkStealingPool pool(4);
+
+        // Uneven job lengths, so participants run dry and steal
+        std::vector<std::atomic<int>> hits(10000);
+        pool.parallelFor(hits.size(), [&](std::size_t i) {
+            volatile int spin = 0;
+            for (int k = 0; k < static_cast<int>(i % 50) * 100; ++k) spin = spin + k;
+            ++hits[i];
+        });
+        int wrong = 0;
+        for (const auto& hit : hits) wrong += hit != 1;
+        CHECK_EQ(wrong, 0);
+
+        // Small batches, fewer items than participants included
+        for (int round = 0; round < 200; ++round)
+        {
+            std::atomic<int> count{0};
+            std::size_t n = round % 9;
+            pool.parallelFor(n, [&](std::size_t) { ++count; });
+            CHECK_EQ(static_cast<std::size_t>(count.load()), n);
+        }
+
+        // A call from inside a job runs inline
+        std::atomic<int> nested{0};
+        pool.parallelFor(8, [&](std::size_t) { pool.parallelFor(5, [&](std::size_t) { ++nested; }); });
+        CHECK_EQ(nested.load(), 40);
+
+        // The first exception reaches the caller once the batch is done, and
+        // the pool stays usable
+        bool threw = false;
+        try
+        {
+            pool.parallelFor(100, [](std::size_t i) {
+                if (i == 37) throw std::runtime_error("job failed");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+        std::atomic<int> after{0};
+        pool.parallelFor(16, [&](std::size_t) { ++after; });
+        CHECK_EQ(after.load(), 16);
+    }
+
+    void checkBatchMatchesSerial(std::mt19937& rng, PlannerAlgorithm algorithm)
+    {
+        Map map = randomMap(rng, 120, 120, 20);
+        std::vector<Robot> serial;
+        std::vector<std::vector<float>> targets;
+        for (int i = 0; i < 48; ++i)
+        {
+            Robot robot;
+            robot.id = "r" + std::to_string(i);
+            GridPoint at = randomCell(rng, map);
+            robot.position = {static_cast<float>(at.first), static_cast<float>(at.second)};
+            serial.push_back(robot);
+            // Some robots share a goal, which the batch serves from a flow field
+            GridPoint goal = i % 4 == 0 && i > 0 ? GridPoint{static_cast<int>(targets[0][0]), static_cast<int>(targets[0][1])}
+                                                : randomCell(rng, map);
+            targets.push_back({static_cast<float>(goal.first), static_cast<float>(goal.second)});
+        }
+        std::vector<Robot> batched = serial;
+
+        PathCache::instance().clear();
+        for (std::size_t i = 0; i < serial.size(); ++i)
+        {
+            serial[i].pathfind(map, targets[i], algorithm);
+        }
+        PathCache::instance().clear();
+        std::vector<PathfindRequest> requests;
+        for (std::size_t i = 0; i < batched.size(); ++i)
+        {
+            requests.push_back({&batched[i], targets[i], {}});
+        }
+        pathfindBatch(map, requests, algorithm);
+
+        for (std::size_t i = 0; i < serial.size(); ++i)
+        {
+            CHECK(batched[i].position == serial[i].position);
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(2);
+    checkPool();
+    checkBatchMatchesSerial(rng, PlannerAlgorithm::Dijkstra);
+    checkBatchMatchesSerial(rng, PlannerAlgorithm::AStar);
+    checkBatchMatchesSerial(rng, PlannerAlgorithm::JumpPoint);
+    return testResult("batch");
+}
@@ -0,0 +1,207 @@
+// CompactPath: random unit-step paths with waits, with runs longer than one
+// byte holds and more runs than one checkpoint covers, read back cell for
+// cell by index, by iterator in both directions and after serialization;
+// append joins paths as a vector would; a coverage route takes a fraction of
+// its vector size; malformed input throws.
+
+#include "CompactPath.h"
+#include "SearchWorkspace.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+    // Straight stretches of 1..80 steps in random directions, and now and
+    // then a few waits
+    std::vector<GridPoint> randomWalk(std::mt19937& rng, GridPoint start, int stretches)
+    {
+        std::vector<GridPoint> cells{start};
+        for (int s = 0; s < stretches; ++s)
+        {
+            if (rng() % 10 == 0)
+            {
+                cells.insert(cells.end(), 1 + rng() % 20, cells.back());
+                continue;
+            }
+            const int dir = static_cast<int>(rng() % 8);
+            for (int n = 1 + static_cast<int>(rng() % 80); n > 0; --n)
+            {
+                GridPoint p = cells.back();
+                cells.push_back({p.first + SearchWorkspace::DX[dir], p.second + SearchWorkspace::DY[dir]});
+            }
+        }
+        return cells;
+    }
+
+    template <typename Fn>
+    bool throws(Fn fn)
+    {
+        try
+        {
+            fn();
+        }
+        catch (const std::invalid_argument&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    void checkSame(const CompactPath& path, const std::vector<GridPoint>& cells)
+    {
+        CHECK_EQ(path.size(), cells.size());
+        CHECK(path.toVector() == cells);
+        if (cells.empty()) return;
+        CHECK(path.front() == cells.front() && path.back() == cells.back());
+    }
+
+    void checkRoundTrip()
+    {
+        std::mt19937 rng(50);
+        for (int stretches : {0, 1, 3, 40, 300})
+        {
+            for (int rep = 0; rep < 4; ++rep)
+            {
+                std::vector<GridPoint> cells = randomWalk(rng, {static_cast<int>(rng() % 100) - 50, 7}, stretches);
+                CHECK(CompactPath::isUnitStepPath(cells));
+                CompactPath path(cells);
+                checkSame(path, cells);
+
+                // Random access, also right at run and checkpoint borders
+                bool indexed = true;
+                for (std::size_t i = 0; i < cells.size(); i += 1 + rng() % 7)
+                {
+                    indexed = indexed && path[i] == cells[i];
+                }
+                indexed = indexed && path[cells.size() - 1] == cells.back();
+                CHECK(indexed);
+
+                // Forward and backward iteration, jumps and distances
+                CHECK_EQ(std::distance(path.begin(), path.end()), static_cast<std::ptrdiff_t>(cells.size()));
+                CHECK(std::equal(path.begin(), path.end(), cells.begin(), cells.end()));
+                std::vector<GridPoint> reversed(std::make_reverse_iterator(path.end()),
+                                                std::make_reverse_iterator(path.begin()));
+                CHECK(std::equal(reversed.rbegin(), reversed.rend(), cells.begin(), cells.end()));
+                bool jumped = true;
+                for (int k = 0; k < 50; ++k)
+                {
+                    std::size_t a = rng() % cells.size();
+                    std::size_t b = rng() % cells.size();
+                    auto it = path.begin() + static_cast<std::ptrdiff_t>(a);
+                    jumped = jumped && *it == cells[a];
+                    it += static_cast<std::ptrdiff_t>(b) - static_cast<std::ptrdiff_t>(a);
+                    jumped = jumped && *it == cells[b] && it - path.begin() == static_cast<std::ptrdiff_t>(b);
+                    if (b + 1 < cells.size()) jumped = jumped && *++it == cells[b + 1];
+                }
+                CHECK(jumped);
+
+                // Serialized form and copies compare equal and decode the same
+                CompactPath copy = CompactPath::deserialize(path.serialize());
+                CHECK(copy == path);
+                checkSame(copy, cells);
+                CHECK(path.memoryBytes() < sizeof(CompactPath) + cells.size() * sizeof(GridPoint));
+            }
+        }
+        CompactPath empty;
+        CHECK(empty.empty() && empty.begin() == empty.end());
+        CHECK(CompactPath::deserialize(empty.serialize()) == empty);
+    }
+
+    void checkOutOfRange()
+    {
+        CompactPath path(std::vector<GridPoint>{{0, 0}, {1, 1}});
+        bool caught = false;
+        try
+        {
+            (void)path[2];
+        }
+        catch (const std::out_of_range&)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+    }
+
+    void checkAppend()
+    {
+        std::mt19937 rng(51);
+        for (int rep = 0; rep < 20; ++rep)
+        {
+            std::vector<GridPoint> first = randomWalk(rng, {0, 0}, 1 + static_cast<int>(rng() % 20));
+            std::vector<GridPoint> second;
+            if (rep % 2 == 0)
+            {
+                second = randomWalk(rng, first.back(), 1 + static_cast<int>(rng() % 20)); // shares back()
+            }
+            else
+            {
+                second = randomWalk(rng, {first.back().first + 1, first.back().second - 1}, static_cast<int>(rng() % 20));
+            }
+            CompactPath path(first);
+            path.append(CompactPath(second));
+            std::vector<GridPoint> joined = first;
+            joined.insert(joined.end(), second.begin() + (rep % 2 == 0 ? 1 : 0), second.end());
+            checkSame(path, joined);
+            CHECK(CompactPath::deserialize(path.serialize()) == CompactPath(joined));
+
+            // Cell by cell gives the same runs
+            CompactPath pushed;
+            for (const GridPoint& cell : joined) pushed.push_back(cell);
+            CHECK(pushed == path);
+        }
+        CompactPath empty;
+        empty.append(CompactPath(GridPoint{3, 4}));
+        checkSame(empty, {{3, 4}});
+    }
+
+    // A boustrophedon route over a 1000 x 1000 field, the shape of a long
+    // coverage run: a million cells in well under 1/20 of a vector's bytes
+    void checkCoverageRoute()
+    {
+        CompactPath path(GridPoint{0, 0});
+        for (int y = 0; y < 1000; ++y)
+        {
+            if (y > 0) path.push_back({path.back().first, y});
+            const int step = y % 2 == 0 ? 1 : -1;
+            for (int n = 0; n < 999; ++n) path.push_back({path.back().first + step, y});
+        }
+        CHECK_EQ(path.size(), std::size_t(1000 * 1000));
+        CHECK(path.back() == GridPoint(0, 999));
+        CHECK(path[1000 * 1000 / 2 + 7] == GridPoint(7, 500));
+        CHECK(path.memoryBytes() * 20 < path.size() * sizeof(GridPoint));
+    }
+
+    void checkErrors()
+    {
+        CHECK(!CompactPath::isUnitStepPath({{0, 0}, {2, 0}}));
+        CHECK(CompactPath::isUnitStepPath({{0, 0}, {0, 0}})); // a wait
+        CHECK(throws([] { CompactPath path(std::vector<GridPoint>{{0, 0}, {1, 0}, {3, 0}}); }));
+        CHECK(!throws([] { CompactPath path(GridPoint{0, 0}); path.push_back({0, 0}); }));
+        CHECK(throws([] { CompactPath path(GridPoint{0, 0}); path.push_back({5, 5}); }));
+        CHECK(throws([] { CompactPath path(GridPoint{0, 0}); path.append(CompactPath(GridPoint{2, 0})); }));
+
+        const std::string bytes = CompactPath(std::vector<GridPoint>{{0, 0}, {1, 0}, {2, 1}, {2, 2}}).serialize();
+        for (std::size_t n = 0; n < bytes.size(); ++n)
+        {
+            CHECK(throws([&] { CompactPath::deserialize(bytes.substr(0, n)); }));
+        }
+        CHECK(throws([&] { CompactPath::deserialize(bytes + '\0'); }));
+        std::string wrongCount = bytes;
+        wrongCount[8] = static_cast<char>(wrongCount[8] + 1);
+        CHECK(throws([&] { CompactPath::deserialize(wrongCount); }));
+        std::string unknownCode = bytes;
+        unknownCode.back() = static_cast<char>(0xF0); // step code 15
+        CHECK(throws([&] { CompactPath::deserialize(unknownCode); }));
+    }
+}
+
+int main()
+{
+    checkRoundTrip();
+    checkOutOfRange();
+    checkAppend();
+    checkCoverageRoute();
+    checkErrors();
+    return testResult("compact_path");
+}
@@ -0,0 +1,150 @@
+// Component labels: after any mix of edits, two free cells share a label
+// exactly when a flood over the free cells joins them, and isReachable agrees
+// with planPath, on maps that do not fill their last tiles, in both cell
+// layouts, and when more edits were made than the journal keeps.
+
+#include "SearchWorkspace.h"
+#include "TestSupport.h"
+#include <map>
+
+namespace {
+    // Reference labels by flooding the free cells 8-connected, 0 for blocked
+    std::vector<int> floodComponents(const Map& map, int& count)
+    {
+        const int w = map.getWidth();
+        const int h = map.getHeight();
+        std::vector<int> comp(static_cast<std::size_t>(w) * h, 0);
+        std::vector<GridPoint> stack;
+        count = 0;
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                if (!map.isAccessible(x, y) || comp[static_cast<std::size_t>(y) * w + x]) continue;
+                comp[static_cast<std::size_t>(y) * w + x] = ++count;
+                stack.push_back({x, y});
+                while (!stack.empty())
+                {
+                    GridPoint p = stack.back();
+                    stack.pop_back();
+                    for (int dir = 0; dir < 8; ++dir)
+                    {
+                        int nx = p.first + SearchWorkspace::DX[dir];
+                        int ny = p.second + SearchWorkspace::DY[dir];
+                        if (!map.isAccessible(nx, ny) || comp[static_cast<std::size_t>(ny) * w + nx]) continue;
+                        comp[static_cast<std::size_t>(ny) * w + nx] = count;
+                        stack.push_back({nx, ny});
+                    }
+                }
+            }
+        }
+        return comp;
+    }
+
+    // Labels and flood components are the same partition of the free cells
+    void checkLabels(std::mt19937& rng, const Map& map)
+    {
+        int count = 0;
+        std::vector<int> comp = floodComponents(map, count);
+        std::map<int, std::uint32_t> toLabel;
+        std::map<std::uint32_t, int> toComp;
+        bool same = true;
+        for (int y = 0; y < map.getHeight(); ++y)
+        {
+            for (int x = 0; x < map.getWidth(); ++x)
+            {
+                int c = comp[static_cast<std::size_t>(y) * map.getWidth() + x];
+                std::uint32_t label = map.getComponent(x, y);
+                if ((c == 0) != (label == ComponentLabels::NONE))
+                {
+                    same = false;
+                    continue;
+                }
+                if (c == 0) continue;
+                same = same && toLabel.emplace(c, label).first->second == label;
+                same = same && toComp.emplace(label, c).first->second == c;
+            }
+        }
+        CHECK(same);
+        CHECK_EQ(toComp.size(), static_cast<std::size_t>(count));
+        CHECK_EQ(map.getComponent(-1, 0), ComponentLabels::NONE);
+        CHECK_EQ(map.getComponent(map.getWidth(), map.getHeight() - 1), ComponentLabels::NONE);
+
+        // Blocked starts included: a robot may drive off an obstacle
+        for (int i = 0; i < 40; ++i)
+        {
+            GridPoint start = randomCell(rng, map);
+            GridPoint goal = randomCell(rng, map);
+            bool found = !planPath(map, start, goal, PlannerAlgorithm::Dijkstra).path.empty();
+            CHECK_EQ(map.isReachable(start, goal), found);
+        }
+    }
+
+    // Vertical walls every 50 cells, crossing tile borders, with one gap
+    // each; toggling the gaps splits and joins regions spanning several tiles
+    void addWalls(Map& map)
+    {
+        for (int x = 25; x < map.getWidth(); x += 50)
+        {
+            for (int y = 0; y < map.getHeight(); ++y)
+            {
+                map.setCell(x, y, y == map.getHeight() / 2 ? 0 : 1);
+            }
+        }
+    }
+
+    void checkEdits(GridLayout layout)
+    {
+        std::mt19937 rng(49);
+        const std::pair<int, int> sizes[] = {{70, 45}, {130, 67}, {193, 129}, {64, 128}};
+        for (auto [w, h] : sizes)
+        {
+            for (int percent : {10, 40, 55})
+            {
+                Map map = randomMap(rng, w, h, percent, layout);
+                addWalls(map);
+                checkLabels(rng, map);
+
+                // A few small edits per round, relabelled from the journal
+                for (int round = 0; round < 8; ++round)
+                {
+                    for (int e = 0; e < 6; ++e)
+                    {
+                        GridPoint cell = randomCell(rng, map);
+                        map.setCell(cell.first, cell.second, static_cast<int>(rng() % 2));
+                    }
+                    if (round % 2 == 1)
+                    {
+                        for (int x = 25; x < w; x += 50)
+                        {
+                            map.setCell(x, h / 2, 1 - map.getCell(x, h / 2));
+                        }
+                    }
+                    checkLabels(rng, map);
+                }
+
+                // More edits than the journal holds, alternating between the
+                // first and the last tile so none merge: the labels are
+                // rebuilt from scratch
+                const std::uint64_t before = map.getVersion();
+                for (std::size_t e = 0; e < 2 * MapJournal::DEFAULT_CAPACITY; ++e)
+                {
+                    GridPoint cell = randomCell(rng, map);
+                    if (e % 2) cell = {w - 1 - cell.first % 20, h - 1 - cell.second % 20};
+                    else cell = {cell.first % 20, cell.second % 20};
+                    map.setCell(cell.first, cell.second, 1 - map.getCell(cell.first, cell.second));
+                }
+                std::vector<MapChange> changes;
+                CHECK(!map.changesSince(before, changes));
+                checkLabels(rng, map);
+            }
+        }
+    }
+}
+
+int main()
+{
+    checkEdits(GridLayout::RowMajor);
+    checkEdits(GridLayout::Morton);
+    return testResult("components");
+}
@@ -0,0 +1,146 @@
+// Distance kernels against a full Dijkstra flood on the binary heap: the
+// bidirectional search and the one-to-many distance field, with and without
+// search limits, under the robot model and the 4-connected unit-cost one;
+// and a thread's workspace giving back the blocks of a flood over a big map.
+
+#include "GridSearch.h"
+#include "TestSupport.h"
+
+namespace {
+    // Distance from source to every cell, UNREACHED where there is none
+    template <typename Neighbourhood, typename Cost>
+    std::vector<int> referenceField(const TiledGrid& grid, GridPoint source)
+    {
+        SearchWorkspace& ws = SearchWorkspace::acquire(grid);
+        searchGrid<Neighbourhood, Cost, BinaryHeapQueue>(grid, ws, source, {-1, -1}, [](int, int) { return 0; });
+        std::vector<int> field(static_cast<std::size_t>(grid.getWidth()) * grid.getHeight());
+        for (int y = 0; y < grid.getHeight(); ++y)
+        {
+            for (int x = 0; x < grid.getWidth(); ++x)
+            {
+                field[static_cast<std::size_t>(y) * grid.getWidth() + x] = ws.getDist(x, y);
+            }
+        }
+        return field;
+    }
+
+    // A limited search is exact up to maxCost; beyond it, it may stop early
+    // and report EXCEEDED instead
+    bool withinLimits(int result, int exact, const SearchLimits& limits)
+    {
+        return result == exact || (exact > limits.maxCost && result == SearchLimits::EXCEEDED);
+    }
+
+    template <typename Neighbourhood, typename Cost>
+    void checkBidirectional(std::mt19937& rng)
+    {
+        for (int round = 0; round < 120; ++round)
+        {
+            Map map = randomMap(rng, 5 + rng() % 70, 5 + rng() % 70, rng() % 45);
+            const TiledGrid& grid = map.getGrid();
+            for (int q = 0; q < 5; ++q)
+            {
+                GridPoint start = randomCell(rng, map);
+                std::vector<int> field = referenceField<Neighbourhood, Cost>(grid, start);
+                for (int t = 0; t < 8; ++t)
+                {
+                    GridPoint goal = t == 0 ? start : randomCell(rng, map);
+                    if (goal != start && !map.isAccessible(goal.first, goal.second)) continue;
+                    int exact = field[static_cast<std::size_t>(goal.second) * map.getWidth() + goal.first];
+                    if (goal == start) exact = 0;
+
+                    SearchStats stats = bidirectionalDistance<Neighbourhood, Cost, BucketQueue>(grid, start, goal);
+                    CHECK_EQ(stats.goalCost, exact);
+
+                    SearchLimits limits;
+                    limits.maxCost = static_cast<int>(rng() % (20 * Cost::MAX_STEP + 1));
+                    stats = bidirectionalDistance<Neighbourhood, Cost, BucketQueue>(grid, start, goal, FreeCells(), limits);
+                    CHECK(withinLimits(stats.goalCost, exact, limits));
+                }
+            }
+        }
+    }
+
+    template <typename Neighbourhood, typename Cost>
+    void checkDistanceField(std::mt19937& rng)
+    {
+        for (int round = 0; round < 120; ++round)
+        {
+            Map map = randomMap(rng, 5 + rng() % 70, 5 + rng() % 70, rng() % 45);
+            const TiledGrid& grid = map.getGrid();
+            GridPoint source = randomCell(rng, map);
+            std::vector<int> field = referenceField<Neighbourhood, Cost>(grid, source);
+
+            // Duplicates, blocked and off-map targets included
+            std::vector<GridPoint> targets{source};
+            for (int t = 0; t < 12; ++t) targets.push_back(randomCell(rng, map));
+            targets.push_back(targets[1]);
+            targets.push_back({-1, 0});
+            targets.push_back({map.getWidth(), map.getHeight() - 1});
+
+            auto exactAt = [&](GridPoint t) {
+                if (t == source) return 0;
+                if (!map.isValidPosition(t.first, t.second) || !map.isAccessible(t.first, t.second))
+                {
+                    return SearchWorkspace::UNREACHED;
+                }
+                return field[static_cast<std::size_t>(t.second) * map.getWidth() + t.first];
+            };
+
+            std::vector<int> out;
+            distanceField<Neighbourhood, Cost, BucketQueue>(grid, source, targets, out);
+            CHECK_EQ(out.size(), targets.size());
+            for (std::size_t i = 0; i < targets.size() && i < out.size(); ++i)
+            {
+                CHECK_EQ(out[i], exactAt(targets[i]));
+            }
+
+            SearchLimits limits;
+            limits.maxCost = static_cast<int>(rng() % (30 * Cost::MAX_STEP + 1));
+            distanceField<Neighbourhood, Cost, BucketQueue>(grid, source, targets, out, FreeCells(), limits);
+            for (std::size_t i = 0; i < targets.size() && i < out.size(); ++i)
+            {
+                CHECK(withinLimits(out[i], exactAt(targets[i]), limits));
+            }
+        }
+    }
+
+    // A flood over more tiles than a workspace keeps is released when the
+    // next query starts, and the workspace still answers correctly after
+    void checkWorkspaceRelease()
+    {
+        const int side = 33 * TiledGrid::TILE_SIZE;
+        TiledGrid big(side, side);
+        TiledGrid small(100, 100);
+        for (int round = 0; round < 2; ++round)
+        {
+            SearchWorkspace& ws = SearchWorkspace::acquire(big);
+            searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(big, ws, {0, 0}, {-1, -1}, [](int, int) { return 0; });
+            CHECK_EQ(ws.allocatedTiles(), big.getTileCount());
+            CHECK_EQ(ws.getDist(side - 1, side - 1), 14 * (side - 1));
+            CHECK_EQ(ws.getDist(side - 1, 0), 10 * (side - 1));
+
+            SearchWorkspace& again = SearchWorkspace::acquire(small);
+            CHECK_EQ(again.allocatedTiles(), std::size_t(0));
+            searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(small, again, {5, 5}, {-1, -1}, [](int, int) { return 0; });
+            CHECK_EQ(again.getDist(5, 95), 900);
+            CHECK(again.allocatedTiles() <= small.getTileCount());
+        }
+
+        // Floods that fit are kept
+        SearchWorkspace& ws = SearchWorkspace::acquire(small);
+        searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(small, ws, {5, 5}, {-1, -1}, [](int, int) { return 0; });
+        CHECK_EQ(SearchWorkspace::acquire(small).allocatedTiles(), small.getTileCount());
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(11);
+    checkBidirectional<RobotNeighbourhood, RobotCost>(rng);
+    checkBidirectional<FourConnected, UnitCost>(rng);
+    checkDistanceField<RobotNeighbourhood, RobotCost>(rng);
+    checkDistanceField<FourConnected, UnitCost>(rng);
+    checkWorkspaceRelease();
+    return testResult("distances");
+}
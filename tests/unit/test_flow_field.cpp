@@ -0,0 +1,123 @@
+// Flow fields: the distance and path read from a field match Dijkstra from
+// every kind of start (free, blocked, cut off, out of the map), a map edit
+// gets a field rebuilt for the new version, and maps too large for a field
+// are planned without one.
+
+#include "FlowField.h"
+#include "TestSupport.h"
+
+namespace {
+    // Field answers from start against a Dijkstra search to the field's goal
+    void checkFrom(const Map& map, const FlowField& field, GridPoint start)
+    {
+        PlanResult best = planPath(map, start, field.getGoal(), PlannerAlgorithm::Dijkstra);
+        PlanResult read = field.path(start);
+        CHECK_EQ(read.path.empty(), best.path.empty());
+        if (best.path.empty())
+        {
+            CHECK_EQ(field.distance(start), FlowField::UNREACHED);
+            if (start != field.getGoal()) CHECK(field.nextStep(start) == GridPoint(-1, -1));
+            return;
+        }
+        CHECK_EQ(field.distance(start), best.cost);
+        CHECK_EQ(read.cost, best.cost);
+        CHECK_EQ(gridPathCost(map, read.path, start, field.getGoal()), best.cost);
+        if (read.path.size() > 1) CHECK(field.nextStep(start) == read.path[1]);
+    }
+
+    void checkRandomMaps()
+    {
+        std::mt19937 rng(46);
+        for (int percent : {0, 15, 30, 45})
+        {
+            for (int rep = 0; rep < 4; ++rep)
+            {
+                Map map = randomMap(rng, 70, 50, percent);
+                GridPoint goal = randomCell(rng, map);
+                if (rep == 3) map.setCell(goal.first, goal.second, 1); // nothing reaches a blocked goal
+                std::shared_ptr<const FlowField> field = map.getFlowField(goal);
+                CHECK(field->getGoal() == goal);
+                CHECK_EQ(field->getVersion(), map.getVersion());
+
+                int blockedStarts = 0;
+                for (int i = 0; i < 150; ++i)
+                {
+                    GridPoint start = randomCell(rng, map);
+                    blockedStarts += !map.isAccessible(start.first, start.second);
+                    checkFrom(map, *field, start);
+                }
+                CHECK(percent == 0 || blockedStarts > 0);
+                checkFrom(map, *field, goal);
+                if (map.isAccessible(goal.first, goal.second))
+                {
+                    CHECK_EQ(field->distance(goal), 0);
+                    CHECK(field->nextStep(goal) == goal);
+                }
+                CHECK_EQ(field->distance({-1, 0}), FlowField::UNREACHED);
+                CHECK(field->nextStep({0, map.getHeight()}) == GridPoint(-1, -1));
+                CHECK(field->path({map.getWidth(), 0}).path.empty());
+            }
+        }
+    }
+
+    // A pocket whose only way out is closed and reopened: the field for the
+    // new version follows the map, the one a reader still holds does not
+    void checkRebuild()
+    {
+        Map map(40, 30, "test", "");
+        for (int y = 10; y <= 20; ++y)
+        {
+            map.setCell(10, y, 1);
+            map.setCell(20, y, 1);
+        }
+        for (int x = 10; x <= 20; ++x)
+        {
+            map.setCell(x, 10, 1);
+            map.setCell(x, 20, 1);
+        }
+        map.setCell(15, 10, 0); // door
+        const GridPoint goal{15, 15};
+        const GridPoint outside{30, 5};
+
+        std::shared_ptr<const FlowField> open = map.getFlowField(goal);
+        CHECK(map.getFlowField(goal) == open); // cached while the map is unchanged
+        checkFrom(map, *open, outside);
+        CHECK(open->distance(outside) != FlowField::UNREACHED);
+
+        map.setCell(15, 10, 1);
+        std::shared_ptr<const FlowField> closed = map.getFlowField(goal);
+        CHECK(closed != open);
+        CHECK_EQ(closed->getVersion(), map.getVersion());
+        CHECK_EQ(closed->distance(outside), FlowField::UNREACHED);
+        checkFrom(map, *closed, outside);
+        checkFrom(map, *closed, {12, 12});
+        CHECK(open->distance(outside) != FlowField::UNREACHED);
+
+        map.setCell(15, 10, 0);
+        checkFrom(map, *map.getFlowField(goal), outside);
+    }
+
+    // 6000 x 6000 cells need a 180 MB field, over the budget: a flow query
+    // is answered by A* and no field is built or kept
+    void checkOversized()
+    {
+        Map map(6000, 6000, "test", "");
+        CHECK(!FlowFieldSet::fits(map.getWidth(), map.getHeight()));
+        for (int y = 2990; y <= 3010; ++y) map.setCell(3000, y, 1);
+        const GridPoint start{2980, 3000};
+        const GridPoint goal{3020, 3000};
+        PlanResult flow = planPath(map, start, goal, PlannerAlgorithm::FlowField);
+        PlanResult astar = planPath(map, start, goal, PlannerAlgorithm::AStar);
+        CHECK_EQ(flow.cost, astar.cost);
+        CHECK_EQ(flow.expanded, astar.expanded);
+        CHECK_EQ(gridPathCost(map, flow.path, start, goal), astar.cost);
+    }
+}
+
+int main()
+{
+    checkRandomMaps();
+    checkRebuild();
+    checkOversized();
+    return testResult("flow_field");
+}
@@ -0,0 +1,160 @@
+// D* Lite: after any mix of map edits and start moves a repaired search
+// costs the same as a fresh A* search, its paths are legal, robots sharing a
+// goal keep separate searches, keys stay correct once the key modifier
+// has been reset, and the memory budget drops the least recently used
+// searches.
+
+#include "DStarLite.h"
+#include "TestSupport.h"
+
+namespace {
+    void checkPath(const Map& map, const PlanResult& r, GridPoint start, GridPoint goal)
+    {
+        if (!r.path.empty()) CHECK_EQ(gridPathCost(map, r.path, start, goal), r.cost);
+    }
+
+    // Random edits, occasional blocked squares and a robot walking a few
+    // steps along each path
+    void checkRandomEdits()
+    {
+        std::mt19937 rng(45);
+        for (int percent : {0, 10, 25, 35})
+        {
+            for (int rep = 0; rep < 3; ++rep)
+            {
+                Map map = randomMap(rng, 90, 70, percent);
+                GridPoint goal = randomCell(rng, map);
+                map.setCell(goal.first, goal.second, 0);
+                GridPoint start = randomCell(rng, map);
+                DStarLite search(goal);
+                for (int step = 0; step < 40; ++step)
+                {
+                    for (int e = static_cast<int>(rng() % 4); e > 0; --e)
+                    {
+                        GridPoint cell = randomCell(rng, map);
+                        if (cell != goal) map.setCell(cell.first, cell.second, static_cast<int>(rng() % 2));
+                    }
+                    if (rng() % 10 == 0)
+                    {
+                        GridPoint corner = randomCell(rng, map);
+                        for (int y = corner.second; y < std::min(corner.second + 4, map.getHeight()); ++y)
+                        {
+                            for (int x = corner.first; x < std::min(corner.first + 4, map.getWidth()); ++x)
+                            {
+                                if (GridPoint{x, y} != goal) map.setCell(x, y, 1);
+                            }
+                        }
+                    }
+
+                    PlanResult r = search.plan(map, start);
+                    PlanResult fresh = planPath(map, start, goal, PlannerAlgorithm::AStar);
+                    CHECK_EQ(r.cost, fresh.cost);
+                    CHECK_EQ(map.planIncremental(start, goal).cost, fresh.cost);
+                    checkPath(map, r, start, goal);
+                    if (r.path.empty())
+                    {
+                        start = randomCell(rng, map);
+                        continue;
+                    }
+                    start = r.path[std::min<std::size_t>(r.path.size() - 1, 1 + rng() % 5)];
+                }
+            }
+        }
+    }
+
+    // Two robots heading for one goal from opposite sides: each keeps its
+    // own search, and both stay right as they take turns moving
+    void checkSharedGoal()
+    {
+        std::mt19937 rng(46);
+        Map map = randomMap(rng, 80, 80, 20);
+        GridPoint goal{40, 40};
+        GridPoint starts[2] = {{2, 2}, {77, 77}};
+        map.setCell(goal.first, goal.second, 0);
+        for (GridPoint start : starts) map.setCell(start.first, start.second, 0);
+        const std::string agents[2] = {"r1", "r2"};
+        for (int step = 0; step < 30; ++step)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                GridPoint cell = randomCell(rng, map);
+                if (cell != goal && cell != starts[0] && cell != starts[1]) map.setCell(cell.first, cell.second, 1);
+                PlanResult r = map.planIncremental(starts[i], goal, agents[i]);
+                PlanResult fresh = planPath(map, starts[i], goal, PlannerAlgorithm::AStar);
+                CHECK_EQ(r.cost, fresh.cost);
+                checkPath(map, r, starts[i], goal);
+                if (r.path.size() > 2) starts[i] = r.path[1];
+            }
+        }
+    }
+
+    // Jumping the start between a far corner and random cells runs the key
+    // modifier past its limit a few times; the re-keyed queue still gives
+    // optimal costs, also for starts the search has not reached yet
+    void checkRekey()
+    {
+        std::mt19937 rng(47);
+        Map map = randomMap(rng, 200, 200, 20);
+        GridPoint goal{100, 100};
+        GridPoint corners[2] = {{0, 0}, {199, 199}};
+        map.setCell(goal.first, goal.second, 0);
+        for (GridPoint corner : corners) map.setCell(corner.first, corner.second, 0);
+        DStarLite search(goal);
+        for (int bounce = 0; bounce < 1500; ++bounce)
+        {
+            if (bounce % 10 == 0)
+            {
+                GridPoint cell = randomCell(rng, map);
+                if (cell != goal && cell != corners[0] && cell != corners[1])
+                {
+                    map.setCell(cell.first, cell.second, 1 - map.getCell(cell.first, cell.second));
+                }
+            }
+            GridPoint start = bounce % 2 ? randomCell(rng, map) : corners[bounce / 2 % 2];
+            PlanResult r = search.plan(map, start);
+            CHECK_EQ(r.cost, planPath(map, start, goal, PlannerAlgorithm::AStar).cost);
+            if (bounce % 100 == 0) checkPath(map, r, start, goal);
+        }
+    }
+
+    // Goals taken in turn: the default budget keeps all of them on a small
+    // map, a one-byte budget only the search just used
+    void checkBudget()
+    {
+        std::mt19937 rng(48);
+        Map map = randomMap(rng, 60, 60, 15);
+        const GridPoint start{0, 0};
+        const GridPoint goals[3] = {{59, 59}, {59, 0}, {0, 59}};
+        map.setCell(start.first, start.second, 0);
+        for (GridPoint goal : goals) map.setCell(goal.first, goal.second, 0);
+        for (std::size_t budget : {DStarLiteSet::MEMORY_BUDGET, std::size_t(1)})
+        {
+            DStarLiteSet set;
+            set.setMemoryBudget(budget);
+            for (int round = 0; round < 3; ++round)
+            {
+                for (GridPoint goal : goals)
+                {
+                    CHECK_EQ(set.plan(map, start, goal).cost, planPath(map, start, goal, PlannerAlgorithm::AStar).cost);
+                }
+            }
+            CHECK_EQ(set.getEvictions(), budget == 1 ? std::size_t(8) : std::size_t(0));
+        }
+
+        Map copy = map;
+        copy.setIncrementalBudget(1);
+        copy.planIncremental(start, goals[0]);
+        copy.planIncremental(start, goals[1]);
+        CHECK_EQ(copy.getIncrementalEvictions(), std::size_t(1));
+        CHECK_EQ(map.getIncrementalEvictions(), std::size_t(0));
+    }
+}
+
+int main()
+{
+    checkRandomEdits();
+    checkSharedGoal();
+    checkRekey();
+    checkBudget();
+    return testResult("incremental");
+}
@@ -0,0 +1,167 @@
+// Multi-robot planning: joint plans that claim to be conflict-free are, every
+// step of them is a legal move, and the time budget holds even when a robot
+// cannot be placed at all.
+
+#include "ConflictBasedSearch.h"
+#include "SearchWorkspace.h"
+#include "TestSupport.h"
+#include <chrono>
+#include <set>
+
+namespace {
+    GridPoint at(const TimedPath& path, std::size_t t)
+    {
+        return t < path.size() ? path[t] : path.back();
+    }
+
+    std::vector<AgentQuery> randomAgents(std::mt19937& rng, const Map& map, int count)
+    {
+        std::vector<AgentQuery> agents;
+        std::set<GridPoint> starts;
+        std::set<GridPoint> goals;
+        for (int tries = 0; static_cast<int>(agents.size()) < count && tries < 10000; ++tries)
+        {
+            GridPoint start = randomCell(rng, map);
+            GridPoint goal = randomCell(rng, map);
+            if (!map.isAccessible(start.first, start.second) || !map.isAccessible(goal.first, goal.second)) continue;
+            if (starts.count(start) || goals.count(goal)) continue;
+            starts.insert(start);
+            goals.insert(goal);
+            agents.push_back({start, goal});
+        }
+        return agents;
+    }
+
+    // Paths start at their agents' starts and take single steps over free
+    // cells; returns whether all of them reach their goals without two robots
+    // sharing a cell or swapping places
+    bool checkJointPlan(const Map& map, const std::vector<AgentQuery>& agents, const std::vector<TimedPath>& paths)
+    {
+        CHECK_EQ(paths.size(), agents.size());
+        std::size_t horizon = 0;
+        bool reached = true;
+        for (std::size_t i = 0; i < paths.size(); ++i)
+        {
+            CHECK(!paths[i].empty() && paths[i].front() == agents[i].start);
+            if (paths[i].empty()) return false;
+            reached = reached && paths[i].back() == agents[i].goal;
+            horizon = std::max(horizon, paths[i].size());
+            for (std::size_t t = 1; t < paths[i].size(); ++t)
+            {
+                CHECK(std::abs(paths[i][t].first - paths[i][t - 1].first) <= 1 &&
+                      std::abs(paths[i][t].second - paths[i][t - 1].second) <= 1);
+                CHECK(map.isAccessible(paths[i][t].first, paths[i][t].second));
+            }
+        }
+        bool separate = true;
+        for (std::size_t t = 0; t < horizon; ++t)
+        {
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                for (std::size_t j = i + 1; j < paths.size(); ++j)
+                {
+                    if (at(paths[i], t) == at(paths[j], t)) separate = false;
+                    if (t > 0 && at(paths[i], t) == at(paths[j], t - 1) && at(paths[j], t) == at(paths[i], t - 1) &&
+                        at(paths[i], t) != at(paths[i], t - 1))
+                    {
+                        separate = false;
+                    }
+                }
+            }
+        }
+        return reached && separate;
+    }
+
+    int timedCost(const TimedPath& path)
+    {
+        int cost = 0;
+        for (std::size_t t = 1; t < path.size(); ++t)
+        {
+            bool diagonal = path[t].first != path[t - 1].first && path[t].second != path[t - 1].second;
+            cost += diagonal ? 14 : 10;
+        }
+        return cost;
+    }
+
+    void checkRandomGroups()
+    {
+        std::mt19937 rng(43);
+        int solved = 0;
+        for (int percent : {0, 15, 30})
+        {
+            for (int rep = 0; rep < 20; ++rep)
+            {
+                Map map = randomMap(rng, 24, 18, percent);
+                std::vector<AgentQuery> agents = randomAgents(rng, map, 2 + static_cast<int>(rng() % 12));
+                if (agents.empty()) continue;
+
+                // Alone, a robot takes a cheapest static path
+                ReservationTable empty;
+                TimedPath single = planSpaceTime(map, agents[0].start, agents[0].goal, empty);
+                PlanResult best = planPath(map, agents[0].start, agents[0].goal, PlannerAlgorithm::Dijkstra);
+                CHECK_EQ(single.empty() ? -1 : timedCost(single), best.cost);
+
+                checkJointPlan(map, agents, planCooperative(map, agents));
+                for (double suboptimality : {1.0, 1.2})
+                {
+                    JointPlan plan = planConflictBased(map, agents, {}, std::chrono::milliseconds(500), suboptimality);
+                    bool valid = checkJointPlan(map, agents, plan.paths);
+                    if (plan.solved) CHECK(valid);
+                    solved += plan.solved;
+                }
+            }
+        }
+        CHECK(solved >= 100); // of 120
+    }
+
+    // Two robots heading for each other in a one-wide aisle with a bay: only
+    // a joint search finds that one of them has to step aside
+    void checkHeadOnPass()
+    {
+        Map map(30, 4, "test", "");
+        for (int x = 0; x < 30; ++x)
+        {
+            map.setCell(x, 0, 1);
+            map.setCell(x, 2, 1);
+            map.setCell(x, 3, 1);
+        }
+        map.setCell(10, 2, 0);
+        std::vector<AgentQuery> agents{{{0, 1}, {20, 1}}, {{28, 1}, {2, 1}}};
+        for (double suboptimality : {1.0, 1.2})
+        {
+            JointPlan plan = planConflictBased(map, agents, {}, std::chrono::milliseconds(2000), suboptimality);
+            CHECK(plan.solved);
+            CHECK(checkJointPlan(map, agents, plan.paths));
+        }
+    }
+
+    // The goal of the second robot is fenced in by robots that never move:
+    // it can never get there, and neither CBS nor its fallback may run far
+    // past their budgets finding that out
+    void checkBudget()
+    {
+        Map map(300, 300, "test", "");
+        std::vector<GridPoint> stationary;
+        for (int dir = 0; dir < 8; ++dir)
+        {
+            stationary.push_back({150 + SearchWorkspace::DX[dir], 150 + SearchWorkspace::DY[dir]});
+        }
+        std::vector<AgentQuery> agents{{{10, 10}, {290, 290}}, {{5, 290}, {150, 150}}};
+        const auto budget = std::chrono::milliseconds(100);
+        auto begin = std::chrono::steady_clock::now();
+        JointPlan plan = planConflictBased(map, agents, stationary, budget, 1.2);
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        CHECK(!plan.solved);
+        CHECK(elapsed < 4 * budget);
+        CHECK_EQ(plan.paths.size(), agents.size());
+        if (plan.paths.size() == 2) CHECK(plan.paths[1] == TimedPath{agents[1].start});
+    }
+}
+
+int main()
+{
+    checkRandomGroups();
+    checkHeadOnPass();
+    checkBudget();
+    return testResult("joint_planning");
+}
@@ -0,0 +1,247 @@
+// .agmap files: save/open round trips in both cell layouts give back every
+// cell, the name, the URL and the obstacle count (also counted for version 1
+// files, which do not record it); a changed byte fails the checksum; truncated
+// files and corrupt headers or tile tables are rejected with
+// std::runtime_error instead of being mapped.
+
+#include "MapFile.h"
+#include "TestSupport.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    const std::string PATH = "test_map_file_" + std::to_string(::getpid()) + ".agmap";
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void writeFile(const std::string& path, const std::string& bytes)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    template <typename T>
+    void poke(std::string& bytes, std::size_t offset, T value)
+    {
+        std::memcpy(&bytes[offset], &value, sizeof(T));
+    }
+
+    template <typename T>
+    T peek(const std::string& bytes, std::size_t offset)
+    {
+        T value;
+        std::memcpy(&value, &bytes[offset], sizeof(T));
+        return value;
+    }
+
+    bool rejected(const std::string& bytes, bool verifyChecksum = false)
+    {
+        writeFile(PATH, bytes);
+        try
+        {
+            MapFile::open(PATH, verifyChecksum);
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    // Random cells plus whole tiles left free or blocked, which the file
+    // stores as uniform tiles
+    Map sampleMap(std::mt19937& rng, int w, int h, GridLayout layout)
+    {
+        Map map(w, h, "sample map", "http://maps.example/sample", layout);
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                if (rng() % 4 == 0) map.setCell(x, y, 1);
+            }
+        }
+        for (int y = 0; y < std::min(h, TiledGrid::TILE_SIZE); ++y)
+        {
+            for (int x = 0; x < std::min(w, TiledGrid::TILE_SIZE); ++x) map.setCell(x, y, 0);
+        }
+        for (int y = TiledGrid::TILE_SIZE; y < std::min(h, 2 * TiledGrid::TILE_SIZE); ++y)
+        {
+            for (int x = 0; x < std::min(w, TiledGrid::TILE_SIZE); ++x) map.setCell(x, y, 1);
+        }
+        return map;
+    }
+
+    void checkRoundTrip()
+    {
+        std::mt19937 rng(27);
+        const std::pair<int, int> sizes[] = {{1, 1}, {64, 64}, {150, 130}, {200, 70}};
+        for (GridLayout layout : {GridLayout::RowMajor, GridLayout::Morton})
+        {
+            for (auto [w, h] : sizes)
+            {
+                Map map = sampleMap(rng, w, h, layout);
+                MapFile::save(map, PATH);
+                CHECK(MapFile::verify(PATH));
+
+                MapFile::Contents contents = MapFile::open(PATH, true);
+                CHECK_EQ(contents.grid.getWidth(), w);
+                CHECK_EQ(contents.grid.getHeight(), h);
+                CHECK(contents.grid.getLayout() == layout);
+                CHECK_EQ(contents.name, map.getName());
+                CHECK_EQ(contents.mapUrl, map.getMapUrl());
+                CHECK_EQ(contents.obstacleCount, map.getObstacleCount());
+                bool same = true;
+                for (int y = 0; y < h; ++y)
+                {
+                    for (int x = 0; x < w; ++x)
+                    {
+                        same = same && contents.grid.get(x, y) == map.getCell(x, y);
+                    }
+                }
+                CHECK(same);
+
+                // A loaded map can be edited (copy on write) and saved again
+                Map loaded(PATH, true);
+                loaded.setCell(w - 1, h - 1, 1 - loaded.getCell(w - 1, h - 1));
+                MapFile::save(loaded, PATH);
+                Map reloaded(PATH, true);
+                CHECK_EQ(reloaded.getObstacleCount(), loaded.getObstacleCount());
+                same = true;
+                for (int y = 0; y < h; ++y)
+                {
+                    for (int x = 0; x < w; ++x)
+                    {
+                        bool flipped = x == w - 1 && y == h - 1;
+                        same = same && reloaded.getCell(x, y) == (flipped ? 1 - map.getCell(x, y) : map.getCell(x, y));
+                    }
+                }
+                CHECK(same);
+            }
+        }
+    }
+
+    // A version 1 file has no obstacle count; the map counts its cells when
+    // first asked, also after edits made before that
+    void checkVersion1()
+    {
+        std::mt19937 rng(30);
+        Map map = sampleMap(rng, 150, 130, GridLayout::RowMajor);
+        MapFile::save(map, PATH);
+        std::string bytes = readFile(PATH);
+        poke<std::uint32_t>(bytes, offsetof(AgmapHeader, version), 1);
+        poke<std::uint64_t>(bytes, offsetof(AgmapHeader, obstacleCount), 0);
+        writeFile(PATH, bytes);
+        CHECK(MapFile::verify(PATH));
+        CHECK_EQ(MapFile::open(PATH, true).obstacleCount, std::int64_t(-1));
+
+        Map loaded(PATH);
+        CHECK_EQ(loaded.getObstacleCount(), map.getObstacleCount());
+        Map edited(PATH);
+        const int before = edited.getCell(149, 129);
+        edited.setCell(149, 129, 1 - before);
+        CHECK_EQ(edited.getObstacleCount(), map.getObstacleCount() + (before ? -1 : 1));
+
+        // Saving writes the current format, count included
+        MapFile::save(edited, PATH);
+        CHECK_EQ(peek<std::uint32_t>(readFile(PATH), offsetof(AgmapHeader, version)), MapFile::VERSION);
+        CHECK_EQ(MapFile::open(PATH).obstacleCount, edited.getObstacleCount());
+    }
+
+    void checkChecksum()
+    {
+        std::mt19937 rng(28);
+        MapFile::save(sampleMap(rng, 150, 130, GridLayout::RowMajor), PATH);
+        std::string bytes = readFile(PATH);
+        // Last byte of the last tile's cells
+        bytes.back() = static_cast<char>(bytes.back() ^ 1);
+        writeFile(PATH, bytes);
+        CHECK(!MapFile::verify(PATH));
+        CHECK(!rejected(bytes, false)); // only checked on request
+        CHECK(rejected(bytes, true));
+    }
+
+    void checkCorruptFiles()
+    {
+        std::mt19937 rng(29);
+        MapFile::save(sampleMap(rng, 150, 130, GridLayout::Morton), PATH);
+        const std::string good = readFile(PATH);
+        CHECK(!rejected(good, true));
+        const auto headerSize = peek<std::uint32_t>(good, offsetof(AgmapHeader, headerSize));
+        const auto tableOffset = peek<std::uint64_t>(good, offsetof(AgmapHeader, tableOffset));
+
+        // Truncated anywhere: in the header, its strings, the table or tile data
+        for (std::size_t n : {std::size_t(0), std::size_t(40), sizeof(AgmapHeader) - 1, std::size_t(headerSize - 1),
+                              static_cast<std::size_t>(tableOffset + 8), good.size() - 1})
+        {
+            CHECK(rejected(good.substr(0, n)));
+        }
+
+        std::string bad = good;
+        bad[0] = 'X';
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint32_t>(bad, offsetof(AgmapHeader, version), MapFile::VERSION + 1);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint64_t>(bad, offsetof(AgmapHeader, obstacleCount), 150 * 130 + 1);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint32_t>(bad, offsetof(AgmapHeader, layout), 7);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint32_t>(bad, offsetof(AgmapHeader, width), 0);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint64_t>(bad, offsetof(AgmapHeader, tileCount), 5);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint32_t>(bad, offsetof(AgmapHeader, nameLength), 0xfffffff0u);
+        CHECK(rejected(bad));
+        bad = good;
+        poke<std::uint32_t>(bad, offsetof(AgmapHeader, headerSize), 0xfffffff0u);
+        CHECK(rejected(bad));
+
+        // Table offsets that would wrap around, run past the end, or are misaligned
+        for (std::uint64_t offset : {~std::uint64_t(0) - 7, ~std::uint64_t(0) - 4095, std::uint64_t(1) << 62,
+                                     static_cast<std::uint64_t>(good.size()), tableOffset + 4})
+        {
+            bad = good;
+            poke<std::uint64_t>(bad, offsetof(AgmapHeader, tableOffset), offset);
+            CHECK(rejected(bad));
+        }
+
+        // Tile entries pointing past the end of the file or off a page
+        for (std::uint64_t entry : {static_cast<std::uint64_t>(good.size()), std::uint64_t(1) << 62, std::uint64_t(4100)})
+        {
+            bad = good;
+            for (std::uint64_t i = 0; i < 9; ++i)
+            {
+                const std::size_t at = static_cast<std::size_t>(tableOffset + 8 * i);
+                if (!(peek<std::uint64_t>(bad, at) & MapFile::UNIFORM_TILE_FLAG)) poke<std::uint64_t>(bad, at, entry);
+            }
+            CHECK(rejected(bad));
+            writeFile(PATH, bad);
+            CHECK(!MapFile::verify(PATH));
+        }
+    }
+}
+
+int main()
+{
+    checkRoundTrip();
+    checkVersion1();
+    checkChecksum();
+    checkCorruptFiles();
+    std::remove(PATH.c_str());
+    return testResult("map_file");
+}
@@ -0,0 +1,130 @@
+// Max-pooled map levels against a fresh pooling of the base grid: after
+// single-cell edits that block and free cells (updated in place, stopping
+// where a coarse cell keeps its value), and after the bulk changes that
+// throw the levels away or start a map without them.
+
+#include "MapFile.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    // Level n + 1 pooled from level n the slow way, cell by cell
+    TiledGrid pooled(const TiledGrid& below)
+    {
+        TiledGrid level((below.getWidth() + 1) / 2, (below.getHeight() + 1) / 2, 0, below.getLayout());
+        for (int y = 0; y < below.getHeight(); ++y)
+        {
+            for (int x = 0; x < below.getWidth(); ++x)
+            {
+                level.set(x / 2, y / 2, std::max(level.get(x / 2, y / 2), below.get(x, y)));
+            }
+        }
+        return level;
+    }
+
+    void checkLevels(const Map& map)
+    {
+        CHECK_EQ(map.getLevelCount(), MapPyramid::levelCount(map.getWidth(), map.getHeight()));
+        TiledGrid expected = map.getGrid();
+        for (int level = 1; level < map.getLevelCount(); ++level)
+        {
+            expected = pooled(expected);
+            const TiledGrid& actual = map.getLevelGrid(level);
+            CHECK_EQ(actual.getWidth(), expected.getWidth());
+            CHECK_EQ(actual.getHeight(), expected.getHeight());
+            if (actual.getWidth() != expected.getWidth() || actual.getHeight() != expected.getHeight()) return;
+            int mismatched = 0;
+            for (int y = 0; y < expected.getHeight(); ++y)
+            {
+                for (int x = 0; x < expected.getWidth(); ++x)
+                {
+                    if (actual.get(x, y) != expected.get(x, y)) ++mismatched;
+                }
+            }
+            CHECK_EQ(mismatched, 0);
+        }
+        CHECK_EQ(map.getLevelWidth(map.getLevelCount() - 1), 1);
+        CHECK_EQ(map.getLevelHeight(map.getLevelCount() - 1), 1);
+    }
+
+    // Edits cluster in a few spots so coarse cells flip back and forth, and
+    // mix values so a pooled max can drop to a smaller non-zero value
+    void checkEdits(std::mt19937& rng, GridLayout layout)
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            const int w = 1 + rng() % 300;
+            const int h = 1 + rng() % 300;
+            Map map = randomMap(rng, w, h, rng() % 30, layout);
+            checkLevels(map); // builds the levels
+            for (int batch = 0; batch < 10; ++batch)
+            {
+                const GridPoint centre = randomCell(rng, map);
+                for (int edit = 0; edit < 200; ++edit)
+                {
+                    const int x = std::clamp(centre.first + static_cast<int>(rng() % 9) - 4, 0, w - 1);
+                    const int y = std::clamp(centre.second + static_cast<int>(rng() % 9) - 4, 0, h - 1);
+                    const int r = rng() % 10;
+                    map.setCell(x, y, r < 5 ? 0 : r < 8 ? 1 : 1 + rng() % 255);
+                }
+                checkLevels(map);
+            }
+
+            // A copy keeps its levels and updates them on its own
+            Map copy = map;
+            copy.setCell(0, 0, copy.isAccessible(0, 0) ? 1 : 0);
+            checkLevels(copy);
+            checkLevels(map);
+        }
+    }
+
+    // Bulk changes drop the levels; the next use rebuilds them from the grid
+    void checkBulkChanges(std::mt19937& rng, GridLayout layout)
+    {
+        Map map = randomMap(rng, 250, 170, 20, layout);
+        checkLevels(map);
+
+        std::vector<std::uint8_t> raster(37 * 23);
+        for (auto& cell : raster) cell = rng() % 4 == 0 ? static_cast<std::uint8_t>(1 + rng() % 3) : 0;
+        map.importOccupancy(raster, 37, 23);
+        checkLevels(map);
+        for (int edit = 0; edit < 500; ++edit)
+        {
+            const GridPoint cell = randomCell(rng, map);
+            map.setCell(cell.first, cell.second, rng() % 2);
+        }
+        checkLevels(map);
+
+        // A map opened from a file starts without levels, like a new one
+        const std::string path = "test_map_pyramid_" + std::to_string(::getpid()) + ".agmap";
+        MapFile::save(map, path);
+        {
+            Map loaded(path, false);
+            checkLevels(loaded);
+            loaded.setCell(100, 100, loaded.isAccessible(100, 100) ? 1 : 0);
+            checkLevels(loaded);
+        }
+        std::remove(path.c_str());
+
+        map.initializeEmpty();
+        checkLevels(map);
+        CHECK_EQ(map.getLevelCell(map.getLevelCount() - 1, 0, 0), 0);
+        map.setCell(249, 169, 7);
+        checkLevels(map);
+        CHECK_EQ(map.getLevelCell(map.getLevelCount() - 1, 0, 0), 7);
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(29);
+    for (GridLayout layout : {GridLayout::RowMajor, GridLayout::Morton})
+    {
+        checkEdits(rng, layout);
+        checkBulkChanges(rng, layout);
+    }
+    return testResult("map_pyramid");
+}
@@ -0,0 +1,50 @@
+// PathCache bookkeeping: entries follow their map's version and go away with
+// the map.
+
+#include "PathCache.h"
+#include "TestSupport.h"
+
+namespace {
+    void checkVersionsAndUnload()
+    {
+        PathCache cache(64);
+        CompactPath path(std::vector<GridPoint>{{0, 0}, {1, 1}, {2, 1}});
+        CompactPath found;
+        int cost = 0;
+        {
+            Map map(16, 16, "test", "");
+            PathCache::Key key = PathCache::makeKey(map, {0, 0}, {2, 1}, 8);
+            cache.storePath(key, path, 24);
+            CHECK(cache.findPath(key, found, cost));
+            CHECK(found == path);
+            CHECK_EQ(cost, 24);
+
+            // An edit moves the map on; the old entry can no longer be hit
+            map.setCell(5, 5, 1);
+            PathCache::Key newer = PathCache::makeKey(map, {0, 0}, {2, 1}, 8);
+            CHECK(!cache.findPath(newer, found, cost));
+            CHECK_EQ(cache.getStats().entries, std::size_t(0));
+            cache.storeDistance(newer, 24);
+            CHECK_EQ(cache.getStats().entries, std::size_t(1));
+
+            cache.forgetMap(map.getInstanceId());
+            CHECK_EQ(cache.getStats().entries, std::size_t(0));
+        }
+
+        // The shared cache drops a map's entries when the map is destroyed
+        PathCache& shared = PathCache::instance();
+        shared.clear();
+        {
+            Map map(16, 16, "test", "");
+            shared.storePath(PathCache::makeKey(map, {0, 0}, {2, 1}, 8), path, 24);
+            CHECK_EQ(shared.getStats().entries, std::size_t(1));
+        }
+        CHECK_EQ(shared.getStats().entries, std::size_t(0));
+    }
+}
+
+int main()
+{
+    checkVersionsAndUnload();
+    return testResult("path_cache");
+}
@@ -0,0 +1,278 @@
+// Planner equivalence on random maps: every exact planner must find a path of
+// the Dijkstra cost, made of single grid steps over free cells, also after
+// the map has been edited between queries.
+
+#include "GridSearch.h"
+#include "Landmarks.h"
+#include "TestSupport.h"
+#include <thread>
+
+namespace {
+    void checkExactPlanners(std::mt19937& rng)
+    {
+        const PlannerAlgorithm exact[] = {PlannerAlgorithm::AStar, PlannerAlgorithm::JumpPoint,
+                                          PlannerAlgorithm::Landmark};
+        for (int round = 0; round < 300; ++round)
+        {
+            Map map = randomMap(rng, 5 + rng() % 60, 5 + rng() % 60, rng() % 45);
+            for (int q = 0; q < 10; ++q)
+            {
+                GridPoint start = randomCell(rng, map);
+                GridPoint goal = randomCell(rng, map);
+                PlanResult reference = planPath(map, start, goal, PlannerAlgorithm::Dijkstra);
+                if (!reference.path.empty())
+                {
+                    CHECK_EQ(gridPathCost(map, reference.path, start, goal), reference.cost);
+                }
+                for (PlannerAlgorithm algorithm : exact)
+                {
+                    PlanResult result = planPath(map, start, goal, algorithm);
+                    CHECK_EQ(result.cost, reference.cost);
+                    if (!result.path.empty())
+                    {
+                        CHECK_EQ(gridPathCost(map, result.path, start, goal), result.cost);
+                    }
+                }
+            }
+        }
+    }
+
+    // A block in the middle of an open field leaves two mirrored shortest
+    // routes around it. Both queues must break the f ties the same way, deepest
+    // node first, and so pick the same route with the same expansions.
+    void checkTieBreaking()
+    {
+        Map map(11, 11, "test", "");
+        for (int x = 4; x <= 6; ++x)
+        {
+            for (int y = 4; y <= 6; ++y) map.setCell(x, y, 1);
+        }
+        const std::pair<GridPoint, GridPoint> queries[] = {{{1, 5}, {9, 5}}, {{5, 1}, {5, 9}}};
+        const std::vector<GridPoint> expected[] = {
+            {{1, 5}, {2, 5}, {3, 4}, {4, 3}, {5, 3}, {6, 3}, {7, 4}, {8, 5}, {9, 5}},
+            {{5, 1}, {5, 2}, {4, 3}, {3, 4}, {3, 5}, {3, 6}, {4, 7}, {5, 8}, {5, 9}}};
+        for (int q = 0; q < 2; ++q)
+        {
+            const GridPoint start = queries[q].first;
+            const GridPoint goal = queries[q].second;
+            auto heuristic = [&](int x, int y) { return octileDistance({x, y}, goal); };
+            SearchWorkspace* ws = &SearchWorkspace::acquire(map.getGrid());
+            SearchStats bucket = searchGrid<RobotNeighbourhood, RobotCost, BucketQueue>(map.getGrid(), *ws, start,
+                                                                                        goal, heuristic);
+            CHECK(readPath(*ws, start, goal) == expected[q]);
+            ws = &SearchWorkspace::acquire(map.getGrid());
+            SearchStats heap = searchGrid<RobotNeighbourhood, RobotCost, BinaryHeapQueue>(map.getGrid(), *ws, start,
+                                                                                          goal, heuristic);
+            CHECK(readPath(*ws, start, goal) == expected[q]);
+            CHECK_EQ(bucket.goalCost, heap.goalCost);
+            CHECK_EQ(bucket.expanded, heap.expanded);
+
+            PlanResult planned = planPath(map, start, goal, PlannerAlgorithm::AStar);
+            CHECK(std::vector<GridPoint>(planned.path.begin(), planned.path.end()) == expected[q]);
+        }
+    }
+
+    // Landmark bounds must follow the map through edits: a table left over
+    // from before an obstacle was removed would overestimate
+    void checkLandmarksAcrossEdits(std::mt19937& rng)
+    {
+        for (int round = 0; round < 60; ++round)
+        {
+            Map map = randomMap(rng, 20 + rng() % 60, 20 + rng() % 60, 10 + rng() % 30);
+            for (int q = 0; q < 20; ++q)
+            {
+                for (int edit = 0; edit < 10; ++edit)
+                {
+                    GridPoint cell = randomCell(rng, map);
+                    map.setCell(cell.first, cell.second, rng() % 2);
+                }
+                GridPoint start = randomCell(rng, map);
+                GridPoint goal = randomCell(rng, map);
+                PlanResult reference = planPath(map, start, goal, PlannerAlgorithm::Dijkstra);
+                PlanResult result = planPath(map, start, goal, PlannerAlgorithm::Landmark);
+                CHECK_EQ(result.cost, reference.cost);
+                auto table = map.getLandmarks();
+                CHECK(table && table->getVersion() == map.getVersion());
+            }
+        }
+    }
+
+    // Queries racing a landmark rebuild fall back to octile A*, still exact
+    void checkLandmarksDuringRebuild(std::mt19937& rng)
+    {
+        Map map = randomMap(rng, 300, 300, 25);
+        std::vector<std::pair<GridPoint, GridPoint>> queries;
+        std::vector<int> expected;
+        for (int q = 0; q < 64; ++q)
+        {
+            queries.push_back({randomCell(rng, map), randomCell(rng, map)});
+            expected.push_back(planPath(map, queries.back().first, queries.back().second).cost);
+        }
+        std::vector<int> costs(queries.size());
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (std::size_t q = t; q < queries.size(); q += 4)
+                {
+                    costs[q] = planPath(map, queries[q].first, queries[q].second, PlannerAlgorithm::Landmark).cost;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        for (std::size_t q = 0; q < queries.size(); ++q)
+        {
+            CHECK_EQ(costs[q], expected[q]);
+        }
+    }
+
+    // A serpentine 8000 cells long, whose distances overflow 16 bits: the
+    // clamped landmark fields still guide the search past octile A*
+    void checkLandmarksOnLongMap()
+    {
+        Map map(8000, 12, "test", "");
+        for (int x = 20; x < 8000; x += 20)
+        {
+            const int gap = (x / 20) % 2 ? 0 : 11;
+            for (int y = 0; y < 12; ++y)
+            {
+                if (y != gap) map.setCell(x, y, 1);
+            }
+        }
+        const GridPoint start{5, 6};
+        const GridPoint goal{7990, 6};
+        PlanResult reference = planPath(map, start, goal, PlannerAlgorithm::Dijkstra);
+        PlanResult astar = planPath(map, start, goal, PlannerAlgorithm::AStar);
+        PlanResult alt = planPath(map, start, goal, PlannerAlgorithm::Landmark);
+        CHECK(reference.cost > LandmarkTable::UNKNOWN);
+        CHECK_EQ(astar.cost, reference.cost);
+        CHECK_EQ(alt.cost, reference.cost);
+        CHECK_EQ(gridPathCost(map, alt.path, start, goal), reference.cost);
+        CHECK(map.getLandmarks() && map.getLandmarks()->isConsistent());
+        CHECK(alt.expanded < astar.expanded / 2);
+    }
+
+    // A budget too small for exact fields gets coarse ones: bounds never
+    // overestimate, and a heap search with them stays exact
+    void checkCoarseLandmarks(std::mt19937& rng)
+    {
+        for (int round = 0; round < 40; ++round)
+        {
+            Map map = randomMap(rng, 20 + rng() % 80, 20 + rng() % 80, rng() % 35);
+            const std::size_t budget = static_cast<std::size_t>(map.getWidth()) * map.getHeight() / 4;
+            LandmarkTable table(map.getGrid(), map.getVersion(), LandmarkTable::DEFAULT_LANDMARKS, {}, budget);
+            CHECK(!table.isConsistent());
+            CHECK(table.memoryBytes() <= budget);
+            for (int q = 0; q < 20; ++q)
+            {
+                GridPoint start = randomCell(rng, map);
+                GridPoint goal = randomCell(rng, map);
+                if (!map.isAccessible(goal.first, goal.second)) continue;
+                PlanResult reference = planPath(map, start, goal, PlannerAlgorithm::Dijkstra);
+                LandmarkTable::Bound bound(table, goal);
+                if (reference.cost >= 0 && map.isAccessible(start.first, start.second))
+                {
+                    CHECK(bound(start.first, start.second) <= reference.cost);
+                }
+                SearchWorkspace& ws = SearchWorkspace::acquire(map.getGrid());
+                SearchStats stats = searchGrid<RobotNeighbourhood, RobotCost, BinaryHeapQueue>(
+                    map.getGrid(), ws, start, goal,
+                    [&](int x, int y) { return std::max(octileDistance({x, y}, goal), bound(x, y)); });
+                CHECK_EQ(stats.goalCost == SearchWorkspace::UNREACHED ? -1 : stats.goalCost, reference.cost);
+            }
+        }
+    }
+
+    // HPA* is near-optimal: same reachability as Dijkstra, a valid path whose
+    // cost is what it reports, at most a quarter plus a few entrance detours
+    // above optimal on any query and within 3% on average
+    void checkHierarchical(std::mt19937& rng)
+    {
+        const int detour = 8 * 14;
+        double ratioSum = 0.0;
+        int ratioCount = 0;
+        for (int round = 0; round < 100; ++round)
+        {
+            Map map = randomMap(rng, 5 + rng() % 150, 5 + rng() % 150, rng() % 45);
+            for (int q = 0; q < 20; ++q)
+            {
+                if (q % 5 == 4)
+                {
+                    // Edits drop the clusters around them
+                    for (int edit = 0; edit < 30; ++edit)
+                    {
+                        GridPoint cell = randomCell(rng, map);
+                        map.setCell(cell.first, cell.second, rng() % 2);
+                    }
+                }
+                GridPoint start = randomCell(rng, map);
+                GridPoint goal = randomCell(rng, map);
+                PlanResult optimal = planPath(map, start, goal, PlannerAlgorithm::AStar);
+                PlanResult result = planPath(map, start, goal, PlannerAlgorithm::Hierarchical);
+                CHECK_EQ(result.cost < 0, optimal.cost < 0);
+                if (result.cost < 0 || optimal.cost < 0) continue;
+                CHECK_EQ(gridPathCost(map, result.path, start, goal), result.cost);
+                CHECK(result.cost >= optimal.cost);
+                CHECK(result.cost <= optimal.cost + optimal.cost / 4 + detour);
+                if (optimal.cost > 0)
+                {
+                    ratioSum += static_cast<double>(result.cost) / optimal.cost;
+                    ++ratioCount;
+                }
+            }
+        }
+        CHECK(ratioCount > 0 && ratioSum / ratioCount < 1.03);
+    }
+
+    // HPA* queries building and sharing one map's clusters from several
+    // threads give the costs the same queries get one after another
+    void checkHierarchicalConcurrent(std::mt19937& rng)
+    {
+        const std::uint32_t seed = rng();
+        std::mt19937 mapRng(seed);
+        Map map = randomMap(mapRng, 400, 300, 30);
+        mapRng.seed(seed);
+        Map serialMap = randomMap(mapRng, 400, 300, 30);
+        std::vector<std::pair<GridPoint, GridPoint>> queries;
+        std::vector<int> expected;
+        for (int q = 0; q < 96; ++q)
+        {
+            queries.push_back({randomCell(rng, map), randomCell(rng, map)});
+            expected.push_back(planPath(serialMap, queries.back().first, queries.back().second, PlannerAlgorithm::Hierarchical).cost);
+        }
+        std::vector<int> costs(queries.size());
+        std::vector<int> valid(queries.size());
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (std::size_t q = t; q < queries.size(); q += 4)
+                {
+                    PlanResult result = planPath(map, queries[q].first, queries[q].second, PlannerAlgorithm::Hierarchical);
+                    costs[q] = result.cost;
+                    valid[q] = result.cost < 0 || gridPathCost(map, result.path, queries[q].first, queries[q].second) == result.cost;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        for (std::size_t q = 0; q < queries.size(); ++q)
+        {
+            CHECK_EQ(costs[q], expected[q]);
+            CHECK(valid[q]);
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(5);
+    checkExactPlanners(rng);
+    checkTieBreaking();
+    checkLandmarksAcrossEdits(rng);
+    checkLandmarksDuringRebuild(rng);
+    checkLandmarksOnLongMap();
+    checkCoarseLandmarks(rng);
+    checkHierarchical(rng);
+    checkHierarchicalConcurrent(rng);
+    return testResult("planners");
+}
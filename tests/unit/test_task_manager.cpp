@@ -0,0 +1,131 @@
+// Task assignment compares the 10/14 costs of the paths robots drive.
+
+#include "TaskManager.h"
+#include "TestSupport.h"
+#include <tuple>
+
+namespace {
+    Robot makeRobot(const std::string& id, int x, int y)
+    {
+        Robot robot;
+        robot.id = id;
+        robot.name = id;
+        robot.speed = 1.0f;
+        robot.maxDistance = 1000;
+        robot.position = {static_cast<float>(x), static_cast<float>(y)};
+        return robot;
+    }
+
+    // Robot "diagonal" is 7 diagonal steps (cost 98) from the task, robot
+    // "straight" 10 cardinal steps (cost 100). Rounded to cardinal steps both
+    // are 10 and the pick would fall to order; the cheaper path must win.
+    void checkNearTie(TaskManager::DispatchMode mode, bool balanced)
+    {
+        Map map(32, 32, "test", "");
+        map.addRobot(makeRobot("diagonal", 17, 17));
+        map.addRobot(makeRobot("straight", 20, 10));
+        TaskManager manager(map);
+        manager.setDispatchMode(mode);
+        manager.addTask({10.0f, 10.0f});
+        auto assignments = balanced ? manager.assignAllTasksBalanced() : manager.assignAllTasksOptimal();
+        CHECK_EQ(assignments.size(), std::size_t(1));
+        if (!assignments.empty()) CHECK_EQ(assignments.begin()->second, std::string("diagonal"));
+    }
+
+    // A priority level is worth ten cardinal steps of path: the robot serves
+    // the urgent task 18 steps away before the ordinary one 9 steps away, so
+    // it ends up at the latter
+    void checkPriorityScale()
+    {
+        Map map(64, 64, "test", "");
+        map.addRobot(makeRobot("robot", 30, 10));
+        TaskManager manager(map);
+        Task nearTask;
+        nearTask.id = "near";
+        nearTask.targetPosition = {21.0f, 10.0f};
+        manager.addTask(nearTask);
+        Task urgentTask;
+        urgentTask.id = "urgent";
+        urgentTask.targetPosition = {48.0f, 10.0f};
+        urgentTask.priority = 1;
+        manager.addTask(urgentTask);
+        auto assignments = manager.assignAllTasksOptimal();
+        CHECK_EQ(assignments.size(), std::size_t(2));
+        CHECK(map.getRobots()[0].getGridPosition() == GridPoint(21, 10));
+    }
+
+    // A 2.5M-cell map: a serpentine whose far end costs over 12M from its
+    // start, beside a walled-off pocket holding a robot and two tasks. The
+    // serpentine robot can only serve the far task; a pair without a path
+    // must never rank before that route, however long it is.
+    void checkLongRouteBeforeUnreachable()
+    {
+        const int width = 2060;
+        const int height = 1201;
+        Map map(width, height, "test", "");
+        for (int y = 1; y < height; y += 2)
+        {
+            const int gap = (y / 2) % 2 ? 0 : 2047;
+            for (int x = 0; x < 2048; ++x)
+            {
+                if (x != gap) map.setCell(x, y, 1);
+            }
+        }
+        for (int y = 0; y < height; ++y) map.setCell(2048, y, 1);
+        map.addRobot(makeRobot("serpentine", 0, 0));
+        map.addRobot(makeRobot("pocket", 2050, 5));
+        TaskManager manager(map);
+        const std::tuple<const char*, int, int> targets[] = {{"far", 2047, 1200}, {"near", 2055, 5}, {"other", 2058, 10}};
+        for (auto [id, x, y] : targets)
+        {
+            Task task;
+            task.id = id;
+            task.targetPosition = {static_cast<float>(x), static_cast<float>(y)};
+            manager.addTask(task);
+        }
+        auto assignments = manager.assignAllTasksOptimal();
+        CHECK_EQ(assignments.size(), std::size_t(3));
+        CHECK_EQ(assignments["far"], std::string("serpentine"));
+        CHECK_EQ(assignments["near"], std::string("pocket"));
+        CHECK_EQ(assignments["other"], std::string("pocket"));
+        CHECK(planPath(map, {0, 0}, {2047, 1200}).cost > 10000000);
+    }
+
+    // Two tasks at one cell go to both robots in the same round. Jointly
+    // planned, only the first can park there; the second finds no timed path
+    // and must stay where it stood rather than land on the first.
+    void checkSharedTarget(TaskManager::DispatchMode mode)
+    {
+        Map map(16, 16, "test", "");
+        map.addRobot(makeRobot("first", 2, 8));
+        map.addRobot(makeRobot("second", 12, 8));
+        TaskManager manager(map);
+        manager.setDispatchMode(mode);
+        for (const char* id : {"a", "b"})
+        {
+            Task task;
+            task.id = id;
+            task.targetPosition = {7.0f, 8.0f};
+            manager.addTask(task);
+        }
+        auto assignments = manager.assignAllTasksOptimal();
+        CHECK_EQ(assignments.size(), std::size_t(2));
+        GridPoint first = map.getRobots()[0].getGridPosition();
+        GridPoint second = map.getRobots()[1].getGridPosition();
+        CHECK(first != second);
+        CHECK(first == GridPoint(7, 8) || second == GridPoint(7, 8));
+        CHECK(first == GridPoint(2, 8) || second == GridPoint(12, 8));
+    }
+}
+
+int main()
+{
+    checkNearTie(TaskManager::DispatchMode::Independent, false);
+    checkNearTie(TaskManager::DispatchMode::Independent, true);
+    checkNearTie(TaskManager::DispatchMode::Cooperative, false);
+    checkPriorityScale();
+    checkLongRouteBeforeUnreachable();
+    checkSharedTarget(TaskManager::DispatchMode::Cooperative);
+    checkSharedTarget(TaskManager::DispatchMode::ConflictBased);
+    return testResult("task_manager");
+}
@@ -0,0 +1,67 @@
+// Cell addressing in tiled storage: the in-tile neighbour step of each layout
+// (the dilated-integer arithmetic for Morton) must land on the cell ref()
+// computes from coordinates, across tile borders and in the partial tiles at
+// the right and bottom edges.
+
+#include "TiledGrid.h"
+#include "TestSupport.h"
+
+namespace {
+    void checkNeighbours(GridLayout layout)
+    {
+        // 200 x 150: the last tile column is 8 cells wide, the last row 22
+        TiledGrid grid(200, 150, 0, layout);
+        for (int y = 0; y < grid.getHeight(); ++y)
+        {
+            for (int x = 0; x < grid.getWidth(); ++x)
+            {
+                const TiledGrid::CellRef cell = grid.ref(x, y);
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        const int nx = x + dx;
+                        const int ny = y + dy;
+                        if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= grid.getWidth() ||
+                            ny >= grid.getHeight())
+                        {
+                            continue;
+                        }
+                        const TiledGrid::CellRef expected = grid.ref(nx, ny);
+                        const TiledGrid::CellRef step = grid.neighbour(cell, x, y, dx, dy);
+                        CHECK(step.tile == expected.tile && step.local == expected.local);
+                    }
+                }
+            }
+        }
+    }
+
+    // Reads through a stepped reference see the cell written at its coordinates
+    void checkNeighbourReads(std::mt19937& rng, GridLayout layout)
+    {
+        TiledGrid grid(200, 150, 0, layout);
+        for (int i = 0; i < 5000; ++i)
+        {
+            grid.set(rng() % 200, rng() % 150, static_cast<std::uint8_t>(1 + rng() % 255));
+        }
+        for (int i = 0; i < 20000; ++i)
+        {
+            const int x = 1 + rng() % 198;
+            const int y = 1 + rng() % 148;
+            const int dx = static_cast<int>(rng() % 3) - 1;
+            const int dy = static_cast<int>(rng() % 3) - 1;
+            CHECK_EQ(int(grid.get(grid.neighbour(grid.ref(x, y), x, y, dx, dy))), int(grid.get(x + dx, y + dy)));
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(28);
+    for (GridLayout layout : {GridLayout::RowMajor, GridLayout::Morton})
+    {
+        checkNeighbours(layout);
+        checkNeighbourReads(rng, layout);
+    }
+    return testResult("tiled_grid");
+}